@@ -109,6 +109,12 @@ AudioFrameReceiver::IsFrame(const Track& A, const Track& B)
          && B.GetHead() != Track::HEAD_A;
 }
 
+bool
+AudioFrameReceiver::FrameKey(const Track& track, const uint8_t **key)
+{
+  return track.GetSubcode(2, key);
+}
+
 //
 // Receive a full DAT frame (two tracks, A & B)
 //
@@ -378,18 +384,22 @@ AudioFrameReceiver::ReceiveFrame(const Track& a, const Track& b)
   putchar('\n');
 
   //
-  // Fetch and demultiplex all the data from the track pair.
+  // Fetch and demultiplex the samples straight from the track pair. Only
+  // the first few get printed, so unless the samples are being dumped,
+  // those are all that are needed.
   //
-  mFrame.FillFromTrackPair(a, b);
-  const DATFrame::DataArray& data = mFrame.Data();
+  DATFrameView frame(a, b);
+  frame.Gather(0, mFile != NULL ? DATFrame::kUserDataRows : kPrintedSamples,
+    &mSamples[0][0]);
+  const SampleArray& data = mSamples;
 
   //
   // Print out error statistics for the frame.
   //
-  unsigned int c1_errors = mFrame.C1Errors();
-  unsigned int c1_uncorrectable = mFrame.C1UncorrectableErrors();
+  unsigned int c1_errors = frame.C1Errors();
+  unsigned int c1_uncorrectable = frame.C1UncorrectableErrors();
   unsigned int c1_corrected = c1_errors - c1_uncorrectable;
-  unsigned int c2_uncorrectable = mFrame.C2UncorrectableErrors();
+  unsigned int c2_uncorrectable = frame.C2UncorrectableErrors();
   unsigned int c2_corrected = c1_uncorrectable - c2_uncorrectable;
 
   printf("Errors  C1/C2: %d/%d",
@@ -404,7 +414,7 @@ AudioFrameReceiver::ReceiveFrame(const Track& a, const Track& b)
   
 
   printf("Samples      : L    R\n");
-  for (size_t i = 0; i < 8; i++) {
+  for (size_t i = 0; i < kPrintedSamples; i++) {
     printf("               %02x%02x %02x%02x\n",
       data[i][1], data[i][0],
       data[i][3], data[i][2]
@@ -45,6 +45,11 @@ public:
   //
   bool IsFrame(const Track& a, const Track& b);
 
+  //
+  // A track's frame key: its absolute time (sub-code 2).
+  //
+  bool FrameKey(const Track& track, const uint8_t **key);
+
   //
   // Receive a full DAT frame (two tracks, A & B)
   //
@@ -79,9 +84,13 @@ protected:
   size_t mFramesWritten;
   
   //
-  // The data.
+  // The samples of the frame in hand, one frame row (left and right,
+  // little endian) apiece; and how many of them get printed.
   //
-  DATFrame mFrame;
+  typedef uint8_t SampleArray[DATFrame::kUserDataRows][DATFrame::kBytesPerRow];
+  SampleArray mSamples;
+  static const size_t kPrintedSamples = 8;
+
   bool     mHaveLastAbsoluteFrameNumber;
   uint32_t mLastAbsoluteFrameNumber;
   uint32_t mNextSessionFrameNumber;
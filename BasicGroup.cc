@@ -31,6 +31,7 @@
 #include "BasicGroup.h"
 #include "ECC_C3.h"
 #include "ECCFill_C3.h"
+#include "ECC_Syndrome.h"
 
 //
 // A class for encapsulating a DDS "Basic Group" -- which is
@@ -43,15 +44,11 @@
 BasicGroup::BasicGroup(uint32_t id)
   : mBasicGroupID(id)
 {
-  for (size_t i = 0; i < kSize; i++) {
+  for (size_t i = 0; i < kSize; i++)
     mData[i] = 0;
-    mDataIsValid[i] = false;
-  }
   
-  for (size_t i = 0; i < DDSGroup1::kSize; i++) {
+  for (size_t i = 0; i < DDSGroup1::kSize; i++)
     mECCData[i] = 0;
-    mECCDataIsValid[i] = false;
-  }
 }
 
 BasicGroup::~BasicGroup()
@@ -104,11 +101,11 @@ BasicGroup::LoadFromFile(const char *datapath, const char *validpath,
   //
   for (size_t i = 0; i < kSize; i++) {
     mData[i] = data[i];
-    mDataIsValid[i] = valid[i] != 0;
+    mDataIsValid.Set(i, valid[i] != 0);
   }
   for (size_t i = 0; i < DDSGroup1::kSize; i++) {
     mECCData[i] = ecc[i];
-    mECCDataIsValid[i] = eccvalid[i] != 0;
+    mECCDataIsValid.Set(i, eccvalid[i] != 0);
   }
   
   res = true;
@@ -157,10 +154,10 @@ BasicGroup::DumpToFile(const char *datapath, const char *validpath,
   // Create character arrays from all boolean items.
   //
   for (size_t i = 0; i < kSize; i++)
-    valid[i] = mDataIsValid[i] ? 0xff : 0;
+    valid[i] = mDataIsValid.Test(i) ? 0xff : 0;
   
   for (size_t i = 0; i < DDSGroup1::kSize; i++)
-    eccvalid[i] = mECCDataIsValid[i] ? 0xff : 0;
+    eccvalid[i] = mECCDataIsValid.Test(i) ? 0xff : 0;
   
   //
   // Write all data items, .
@@ -191,68 +188,33 @@ CantOpenData:
   return res;  
 }
 
-bool
-BasicGroup::AddSubFrame(const DDSGroup1& frame)
+//
+// Incorporate a sub-frame's data into 'data_existing', whose validity
+// starts at bit 'pos' of 'valid_existing', as long as it is better than
+// the existing data.
+//
+template <class Mask>
+static void
+MergeSubFrame(const DDSGroup1& frame, uint8_t *data_existing,
+  Mask& valid_existing, size_t pos)
 {
-  //
-  // Make certain that this sub-frame belongs to this group.
-  //
-  if (frame.BasicGroupID() != mBasicGroupID) {
-    printf("Attempt to add sub-frame to wrong basic group!\n");
-    return false;
-  }
-
-  //
-  // Don't dump sub-frame zero, if you ever encounter one.
-  //
-  if (frame.SubFrameID() == 0)
-    return true;
-
-  //
-  // ECC frames get special treatment.
-  //
-  bool is_ecc = frame.IsECCFrame();
-    
-  //
-  // Derive pointers into the appropriate place in out data to capture
-  // this new frame.
-  // 
-  uint8_t *data_existing;
-  bool *valid_existing;
-  if (!is_ecc) {
-    //
-    // Normal data frame. Frames are numbered starting at 1 and are
-    // about 5k in size.
-    //
-    size_t pos = DDSGroup1::kSize * (frame.SubFrameID() - 1);
-    data_existing = &mData[pos];
-    valid_existing = &mDataIsValid[pos];
-  } else {
-    //
-    // ECC frames go into their own buffer.
-    //
-    data_existing = &mECCData[0];
-    valid_existing = &mECCDataIsValid[0];
-  }
-  
   //
   // Get pointers to the frame data and validity buffer.
   //
   const DDSGroup1::DataArray& data = frame.Data();
   const DDSGroup1::ValidArray& valid = frame.Valid();
-  
-  //
-  // Incorporate the frame's data as long as it is better than the existing
-  // data.
-  //
+
   for (size_t i = 0; i < DDSGroup1::kSize; i++) {
-    if (valid[i] && !valid_existing[i]) {
+    const bool is_valid = valid.Test(i);
+    const bool existing_is_valid = valid_existing.Test(pos + i);
+
+    if (is_valid && !existing_is_valid) {
       //
       // New valid data that replaces invalid data. Use it!
       //
       data_existing[i] = data[i];
-      valid_existing[i] = true;
-    } else if (valid[i] && valid_existing[i]) {
+      valid_existing.Set(pos + i, true);
+    } else if (is_valid && existing_is_valid) {
       //
       // We already have data at this spot. Check to make sure that the
       // update is the same.
@@ -266,7 +228,7 @@ BasicGroup::AddSubFrame(const DDSGroup1& frame)
                frame.BasicGroupID(), frame.SubFrameID(), i, data_existing[i],
                data[i]);
       }
-    } else if (!valid[i] && !valid_existing[i]) {
+    } else if (!is_valid && !existing_is_valid) {
       //
       // Existing data is invalid and incoming data is also marked invalid,
       // but the incoming data likely has more information than the existing.
@@ -278,9 +240,43 @@ BasicGroup::AddSubFrame(const DDSGroup1& frame)
       // Copy in the supposedly invalid data.
       //
       data_existing[i] = data[i];
-      valid_existing[i] = valid[i];
     }
   }
+}
+
+bool
+BasicGroup::AddSubFrame(const DDSGroup1& frame)
+{
+  //
+  // Make certain that this sub-frame belongs to this group.
+  //
+  if (frame.BasicGroupID() != mBasicGroupID) {
+    printf("Attempt to add sub-frame to wrong basic group!\n");
+    return false;
+  }
+
+  //
+  // Don't dump sub-frame zero, if you ever encounter one.
+  //
+  if (frame.SubFrameID() == 0)
+    return true;
+
+  //
+  // ECC frames get special treatment.
+  //
+  if (!frame.IsECCFrame()) {
+    //
+    // Normal data frame. Frames are numbered starting at 1 and are
+    // about 5k in size.
+    //
+    size_t pos = DDSGroup1::kSize * (frame.SubFrameID() - 1);
+    MergeSubFrame(frame, &mData[pos], mDataIsValid, pos);
+  } else {
+    //
+    // ECC frames go into their own buffer.
+    //
+    MergeSubFrame(frame, &mECCData[0], mECCDataIsValid, 0);
+  }
   
   return true;
 }  
@@ -294,12 +290,25 @@ BasicGroup::Correct()
 {
   ECC_C3 C3;
   size_t uncorrectableErrors = 0;
+  size_t k;
+
+  //
+  // Compute all of the syndromes at once, to find the vectors that need
+  // correcting. (There are enough of them to keep off the stack.)
+  //
+  ECC_Screen<ECC_C3, ECCFill_C3::kVectors> *screen =
+    new ECC_Screen<ECC_C3, ECCFill_C3::kVectors>();
+  screen->Screen(ECCFill_C3(*this));
   
-  for (ECCFill_C3 c3_fill(*this); !c3_fill.End(); c3_fill.Next()) {
+  k = 0;
+  for (ECCFill_C3 c3_fill(*this); !c3_fill.End(); c3_fill.Next(), k++) {
+    if (!screen->NeedsCorrection(k))
+      continue;
+
     //
-    // Fill the error check vector.
-    //      
-    C3.Fill(c3_fill);
+    // Fill the error check vector from what the screen gathered.
+    //
+    C3.Fill(*screen, k);
 
     //
     // Detect errors in this vector and correct them.
@@ -326,6 +335,8 @@ BasicGroup::Correct()
       break;
     }
   }
+
+  delete screen;
   
   return uncorrectableErrors == 0;
 }
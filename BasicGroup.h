@@ -33,6 +33,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "DDSGroup1.h"
+#include "BitMask.h"
 
 //
 // A class for encapsulating a DDS "Basic Group" -- which is
@@ -51,9 +52,9 @@ public:
   static const size_t kSubFrames = 22;
   
   typedef uint8_t DataArray[kSize];
-  typedef bool    ValidArray[kSize];
+  typedef BitMask<kSize> ValidArray;
   typedef uint8_t ECCDataArray[DDSGroup1::kSize];
-  typedef bool    ECCValidArray[DDSGroup1::kSize];
+  typedef BitMask<DDSGroup1::kSize> ECCValidArray;
   
   bool LoadFromFile(const char *datapath, const char *validpath,
                const char *eccpath, const char *eccvalidpath);
@@ -0,0 +1,190 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_BITMASK_H
+#define RDAT_BITMASK_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// A fixed number of flags, packed 64 to a word.
+//
+// This is how byte validity is kept throughout: one bit per byte, set if
+// the byte is good, clear if it is a known erasure. At one eighth of the
+// size of a bool array, a whole track's worth fits in eight cache lines,
+// and the questions asked of it -- how many bytes are erased, which ones,
+// is this run of bytes all good -- come down to a few word operations
+// (popcount, bit scan, mask compare) instead of a loop over bytes.
+//
+// Bits past the end of the mask, in the last word, are always clear.
+//
+template <size_t kBits>
+class BitMask {
+public:
+  static const size_t kSize = kBits;
+  static const size_t kWords = (kBits + 63) / 64;
+
+  //
+  // A mask starts out all clear.
+  //
+  BitMask() { Fill(false); }
+
+  bool Test(size_t i) const { return (mWords[i / 64] >> (i % 64)) & 1; }
+
+  void Set(size_t i, bool value) {
+    const uint64_t bit = (uint64_t) 1 << (i % 64);
+    mWords[i / 64] = (mWords[i / 64] & ~bit) | (-(uint64_t) value & bit);
+  }
+
+  //
+  // Set or clear every bit.
+  //
+  void Fill(bool value);
+
+  //
+  // The 'n' bits (no more than 64) starting at bit 'first', as a word
+  // whose bit 0 is bit 'first'; and the reverse.
+  //
+  uint64_t Get(size_t first, size_t n) const;
+  void Put(size_t first, size_t n, uint64_t bits);
+
+  //
+  // Copy bits 'first' to 'first' + kBits of a larger mask.
+  //
+  template <size_t kOtherBits>
+  void CopyFrom(const BitMask<kOtherBits>& other, size_t first);
+
+  //
+  // The number of bits that are set; and whether that is all of them.
+  //
+  size_t Count() const;
+  bool All() const { return Count() == kBits; }
+
+  //
+  // Word 'w' of the mask; its bit 0 is bit 64 * w.
+  //
+  uint64_t Word(size_t w) const { return mWords[w]; }
+
+  //
+  // Write out the positions of the first 'max' clear bits, in order.
+  // Returns the number written.
+  //
+  size_t FindClear(size_t *positions, size_t max) const;
+
+protected:
+  static uint64_t Low(size_t n) {
+    return n >= 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << n) - 1;
+  }
+
+  uint64_t mWords[kWords];
+
+  template <size_t kOtherBits> friend class BitMask;
+};
+
+template <size_t kBits>
+inline void
+BitMask<kBits>::Fill(bool value)
+{
+  for (size_t w = 0; w < kWords; w++)
+    mWords[w] = value ? ~(uint64_t) 0 : 0;
+  if (value && kBits % 64 != 0)
+    mWords[kWords - 1] = Low(kBits % 64);
+}
+
+template <size_t kBits>
+inline uint64_t
+BitMask<kBits>::Get(size_t first, size_t n) const
+{
+  const size_t w = first / 64, shift = first % 64;
+  uint64_t bits = mWords[w] >> shift;
+
+  if (shift != 0 && shift + n > 64)
+    bits |= mWords[w + 1] << (64 - shift);
+
+  return bits & Low(n);
+}
+
+template <size_t kBits>
+inline void
+BitMask<kBits>::Put(size_t first, size_t n, uint64_t bits)
+{
+  const size_t w = first / 64, shift = first % 64;
+  const uint64_t mask = Low(n);
+
+  bits &= mask;
+  mWords[w] = (mWords[w] & ~(mask << shift)) | (bits << shift);
+  if (shift != 0 && shift + n > 64)
+    mWords[w + 1] = (mWords[w + 1] & ~(mask >> (64 - shift))) |
+                    (bits >> (64 - shift));
+}
+
+template <size_t kBits>
+template <size_t kOtherBits>
+inline void
+BitMask<kBits>::CopyFrom(const BitMask<kOtherBits>& other, size_t first)
+{
+  for (size_t w = 0; w < kWords; w++) {
+    const size_t n = w + 1 < kWords || kBits % 64 == 0 ? 64 : kBits % 64;
+    mWords[w] = other.Get(first + w * 64, n);
+  }
+}
+
+template <size_t kBits>
+inline size_t
+BitMask<kBits>::Count() const
+{
+  size_t count = 0;
+
+  for (size_t w = 0; w < kWords; w++)
+    count += __builtin_popcountll(mWords[w]);
+
+  return count;
+}
+
+template <size_t kBits>
+inline size_t
+BitMask<kBits>::FindClear(size_t *positions, size_t max) const
+{
+  size_t count = 0;
+
+  for (size_t w = 0; w < kWords && count < max; w++) {
+    uint64_t clear = ~mWords[w];
+    if (w == kWords - 1 && kBits % 64 != 0)
+      clear &= Low(kBits % 64);
+    while (clear != 0 && count < max) {
+      positions[count++] = w * 64 + __builtin_ctzll(clear);
+      clear &= clear - 1;
+    }
+  }
+
+  return count;
+}
+
+#endif
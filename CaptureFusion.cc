@@ -0,0 +1,333 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <string.h>
+#include "CaptureFusion.h"
+#include "TrackPool.h"
+
+CaptureFusion::CaptureFusion(DATFrameReceiver& receiver, size_t captures)
+  : mReceiver(receiver),
+    mCaptures(captures < kMaxCaptures ? captures : kMaxCaptures),
+    mEntries(NULL), mFirst(0), mCount(0), mSize(0),
+    mFree(NULL), mDelivering(false),
+    mFrames(0), mFusedFrames(0), mUnkeyedFrames(0)
+{
+  for (size_t c = 0; c < kMaxCaptures; c++) {
+    mInputs[c].mFusion = this;
+    mInputs[c].mCapture = c;
+    mReached[c] = 0;
+    mFinished[c] = false;
+  }
+  pthread_mutex_init(&mLock, NULL);
+  pthread_cond_init(&mMoved, NULL);
+}
+
+CaptureFusion::~CaptureFusion()
+{
+  for (size_t i = 0; i < mCount; i++) {
+    Entry *entry = mEntries[(mFirst + i) % mSize];
+    for (size_t c = 0; c < mCaptures; c++) {
+      TrackPool::Shared().Put(entry->a[c]);
+      TrackPool::Shared().Put(entry->b[c]);
+    }
+    delete entry;
+  }
+  delete [] mEntries;
+  while (mFree != NULL) {
+    Entry *entry = mFree;
+    mFree = entry->nextFree;
+    delete entry;
+  }
+  pthread_cond_destroy(&mMoved);
+  pthread_mutex_destroy(&mLock);
+}
+
+DATFrameReceiver&
+CaptureFusion::Input(size_t capture)
+{
+  return mInputs[capture];
+}
+
+void
+CaptureFusion::Stop()
+{
+  pthread_mutex_lock(&mLock);
+  while (mDelivering)
+    pthread_cond_wait(&mMoved, &mLock);
+  for (size_t c = 0; c < mCaptures; c++)
+    mFinished[c] = true;
+  Flush();
+  pthread_mutex_unlock(&mLock);
+
+  mReceiver.Stop();
+}
+
+size_t
+CaptureFusion::Frames() const
+{
+  return mFrames;
+}
+
+size_t
+CaptureFusion::FusedFrames() const
+{
+  return mFusedFrames;
+}
+
+size_t
+CaptureFusion::UnkeyedFrames() const
+{
+  return mUnkeyedFrames;
+}
+
+//
+// Take in capture 'capture''s read of a frame.
+//
+void
+CaptureFusion::Add(size_t capture, const Track& a, const Track& b)
+{
+  const uint8_t *key;
+
+  if (!mReceiver.FrameKey(a, &key) && !mReceiver.FrameKey(b, &key)) {
+    pthread_mutex_lock(&mLock);
+    mUnkeyedFrames++;
+    pthread_mutex_unlock(&mLock);
+    return;
+  }
+
+  //
+  // Copy the read now, outside of the lock.
+  //
+  Track *a_read = TrackPool::Shared().Get(Track::HEAD_UNKNOWN);
+  Track *b_read = TrackPool::Shared().Get(Track::HEAD_UNKNOWN);
+  *a_read = a;
+  *b_read = b;
+
+  pthread_mutex_lock(&mLock);
+
+  //
+  // Find the frame amongst those this capture hasn't yet come to. If it
+  // isn't there, the captures ahead of this one missed it, and it goes in
+  // just after the last frame this capture gave -- once the others have
+  // caught up enough to make room.
+  //
+  size_t at;
+  for (;;) {
+    for (at = mReached[capture]; at < mCount; at++)
+      if (memcmp(mEntries[(mFirst + at) % mSize]->key, key,
+                 kFrameKeySize) == 0)
+        break;
+    if (at < mCount || mCount < kWindow || mReached[capture] == 0)
+      break;
+    pthread_cond_wait(&mMoved, &mLock);
+  }
+
+  Entry *entry;
+  if (at < mCount) {
+    entry = mEntries[(mFirst + at) % mSize];
+  } else {
+    at = mReached[capture];
+    entry = Insert(at);
+    memcpy(entry->key, key, kFrameKeySize);
+  }
+
+  entry->a[capture] = a_read;
+  entry->b[capture] = b_read;
+  mReached[capture] = at + 1;
+
+  Flush();
+  pthread_mutex_unlock(&mLock);
+}
+
+//
+// Capture 'capture' has nothing more to give.
+//
+void
+CaptureFusion::Finish(size_t capture)
+{
+  pthread_mutex_lock(&mLock);
+  mFinished[capture] = true;
+  Flush();
+  pthread_mutex_unlock(&mLock);
+}
+
+//
+// Has every capture either given its read of the frame 'at' places from
+// the front, or gone past it?
+//
+bool
+CaptureFusion::Ready(size_t at) const
+{
+  const Entry *entry = mEntries[(mFirst + at) % mSize];
+
+  for (size_t c = 0; c < mCaptures; c++)
+    if (entry->a[c] == NULL && !mFinished[c] && mReached[c] <= at)
+      return false;
+
+  return true;
+}
+
+//
+// Hand on the frames at the front that are ready, unless another thread
+// already is; it will see these too. Called, and returns, with the lock
+// held, but lets go of it while each frame is delivered.
+//
+void
+CaptureFusion::Flush()
+{
+  if (mDelivering)
+    return;
+  mDelivering = true;
+
+  while (mCount > 0 && Ready(0)) {
+    Entry *entry = mEntries[mFirst];
+    mFirst = (mFirst + 1) % mSize;
+    mCount--;
+    for (size_t c = 0; c < mCaptures; c++)
+      if (mReached[c] > 0)
+        mReached[c]--;
+    pthread_cond_broadcast(&mMoved);
+
+    pthread_mutex_unlock(&mLock);
+    Deliver(entry);
+    pthread_mutex_lock(&mLock);
+
+    entry->nextFree = mFree;
+    mFree = entry;
+  }
+
+  mDelivering = false;
+  pthread_cond_broadcast(&mMoved);
+}
+
+//
+// Fuse the reads of each track of a frame, finish their correction and
+// hand the frame on.
+//
+void
+CaptureFusion::Deliver(Entry *entry)
+{
+  const Track *a_reads[kMaxCaptures], *b_reads[kMaxCaptures];
+  size_t reads = 0;
+
+  for (size_t c = 0; c < mCaptures; c++) {
+    if (entry->a[c] == NULL)
+      continue;
+    a_reads[reads] = entry->a[c];
+    b_reads[reads] = entry->b[c];
+    reads++;
+  }
+
+  Track *a = TrackPool::Shared().Get(Track::HEAD_UNKNOWN);
+  Track *b = TrackPool::Shared().Get(Track::HEAD_UNKNOWN);
+  a->Fuse(a_reads, reads);
+  b->Fuse(b_reads, reads);
+  a->CompleteC2();
+  b->CompleteC2();
+
+  mFrames++;
+  if (reads > 1)
+    mFusedFrames++;
+  mReceiver.ReceiveFrame(*a, *b);
+
+  TrackPool::Shared().Put(a);
+  TrackPool::Shared().Put(b);
+  for (size_t c = 0; c < mCaptures; c++) {
+    TrackPool::Shared().Put(entry->a[c]);
+    TrackPool::Shared().Put(entry->b[c]);
+  }
+}
+
+//
+// A new, empty entry, put 'at' places from the front of the ring. The
+// captures that had gone past that place have now gone past it too.
+//
+CaptureFusion::Entry *
+CaptureFusion::Insert(size_t at)
+{
+  if (mCount == mSize) {
+    size_t size = mSize == 0 ? 64 : mSize * 2;
+    Entry **entries = new Entry*[size];
+    for (size_t i = 0; i < mCount; i++)
+      entries[i] = mEntries[(mFirst + i) % mSize];
+    delete [] mEntries;
+    mEntries = entries;
+    mFirst = 0;
+    mSize = size;
+  }
+
+  Entry *entry = mFree;
+  if (entry != NULL)
+    mFree = entry->nextFree;
+  else
+    entry = new Entry;
+  for (size_t c = 0; c < kMaxCaptures; c++) {
+    entry->a[c] = NULL;
+    entry->b[c] = NULL;
+  }
+
+  for (size_t i = mCount; i > at; i--)
+    mEntries[(mFirst + i) % mSize] = mEntries[(mFirst + i - 1) % mSize];
+  mEntries[(mFirst + at) % mSize] = entry;
+  mCount++;
+
+  for (size_t c = 0; c < mCaptures; c++)
+    if (mReached[c] > at)
+      mReached[c]++;
+
+  return entry;
+}
+
+bool
+CaptureFusion::CaptureInput::IsFrame(const Track& a, const Track& b)
+{
+  const uint8_t *a_key, *b_key;
+
+  return FrameKey(a, &a_key) && FrameKey(b, &b_key) &&
+         memcmp(a_key, b_key, kFrameKeySize) == 0 &&
+         a.GetHead() != Track::HEAD_B && b.GetHead() != Track::HEAD_A;
+}
+
+void
+CaptureFusion::CaptureInput::ReceiveFrame(const Track& a, const Track& b)
+{
+  mFusion->Add(mCapture, a, b);
+}
+
+void
+CaptureFusion::CaptureInput::Stop()
+{
+  mFusion->Finish(mCapture);
+}
+
+bool
+CaptureFusion::CaptureInput::FrameKey(const Track& track, const uint8_t **key)
+{
+  return mFusion->mReceiver.FrameKey(track, key);
+}
@@ -0,0 +1,174 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_CAPTURE_FUSION_H
+#define RDAT_CAPTURE_FUSION_H
+
+//
+// Fuses several captures of the same tape into one decode.
+//
+// A bad tape is often captured more than once, each pass losing
+// different bytes. Each capture is decoded on its own (and, typically,
+// on its own thread) as far as tracks that have had C1 and are paired
+// into frames. Those frames come here, through the capture's Input(),
+// where the reads of each frame are lined up by their frame key (see
+// DATFrameReceiver::FrameKey()). Once every capture has either given its
+// read of a frame or gone past it, the reads of each track are fused,
+// byte by byte (Track::Fuse()), C2 is run on the result, and the frame
+// goes on to the receiver. Frames go on in tape order, and any further
+// correction the receiver does (C3, for DDS) is done once, on the fused
+// data.
+//
+// The fusing, C2 and the receiver run outside of the lock that the
+// captures hand in their frames under, in whichever capture's thread
+// found frames ready -- but only one thread at a time, so that frames
+// still go on in order.
+//
+// Frames with no frame key can't be lined up and are dropped.
+//
+// A capture that gets too far ahead of the others is made to wait, so
+// that only a window of the tape is held at once.
+//
+
+#include <stddef.h>
+#include <pthread.h>
+#include "DATFrameReceiver.h"
+#include "Track.h"
+
+class CaptureFusion
+{
+public:
+  CaptureFusion(DATFrameReceiver& receiver, size_t captures);
+  ~CaptureFusion();
+
+  //
+  // Where capture 'capture' (counting from zero) hands in its frames,
+  // from a DATTrackFramer. Stopping it marks the capture as finished.
+  // Each capture's frames must come in from a single thread, but
+  // different captures may use different threads.
+  //
+  DATFrameReceiver& Input(size_t capture);
+
+  //
+  // All the captures are finished. Hand on whatever is left and stop
+  // the receiver.
+  //
+  void Stop();
+
+  //
+  // The number of frames handed on, how many of those had more than one
+  // read, and the number of frames dropped for want of a frame key.
+  //
+  size_t Frames() const;
+  size_t FusedFrames() const;
+  size_t UnkeyedFrames() const;
+
+  static const size_t kMaxCaptures = Track::kMaxFusedReads;
+
+  //
+  // The most frames held before a capture that is ahead must wait.
+  //
+  static const size_t kWindow = 256;
+
+protected:
+  //
+  // Receives one capture's frames.
+  //
+  class CaptureInput : public DATFrameReceiver {
+  public:
+    CaptureInput() : mFusion(NULL), mCapture(0) {}
+    bool IsFrame(const Track& a, const Track& b);
+    void ReceiveFrame(const Track& a, const Track& b);
+    void Stop();
+    bool FrameKey(const Track& track, const uint8_t **key);
+
+    CaptureFusion *mFusion;
+    size_t mCapture;
+  };
+
+  static const size_t kFrameKeySize = DATFrameReceiver::kFrameKeySize;
+
+  //
+  // The reads of one frame gathered so far; NULL for the captures that
+  // haven't given theirs.
+  //
+  struct Entry {
+    uint8_t key[kFrameKeySize];
+    Track *a[kMaxCaptures];
+    Track *b[kMaxCaptures];
+    Entry *nextFree;
+  };
+
+  void Add(size_t capture, const Track& a, const Track& b);
+  void Finish(size_t capture);
+  bool Ready(size_t at) const;
+  void Flush();
+  void Deliver(Entry *entry);
+  Entry *Insert(size_t at);
+
+  DATFrameReceiver& mReceiver;
+  const size_t mCaptures;
+  CaptureInput mInputs[kMaxCaptures];
+
+  //
+  // The frames still waiting, in tape order, in a ring of mSize. A frame
+  // that a capture has and the captures ahead of it missed goes in
+  // amongst the others, not at the back.
+  //
+  Entry **mEntries;
+  size_t mFirst;
+  size_t mCount;
+  size_t mSize;
+
+  //
+  // Entries done with, for reuse.
+  //
+  Entry *mFree;
+
+  //
+  // Is some thread handing on frames?
+  //
+  bool mDelivering;
+
+  //
+  // For each capture, how many of the frames at the front of the ring it
+  // has given its read of or gone past, and whether it has finished.
+  //
+  size_t mReached[kMaxCaptures];
+  bool mFinished[kMaxCaptures];
+
+  size_t mFrames;
+  size_t mFusedFrames;
+  size_t mUnkeyedFrames;
+
+  pthread_mutex_t mLock;
+  pthread_cond_t mMoved;
+};
+
+#endif
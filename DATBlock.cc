@@ -45,35 +45,6 @@ DATBlock::~DATBlock()
 {
 }
 
-//
-// Reset, forgetting any current contents.
-//
-void
-DATBlock::Reset()
-{
-  mByteCount = 0;
-}
-
-//
-// Attempt to append a received byte to this block.
-//
-// Returns True if, after receiving this byte, the block
-// is now complete.
-//
-bool
-DATBlock::AddByte(uint16_t line_word, uint16_t flagged_byte)
-{
-  if (mByteCount == 36)
-    return true;
-
-  mLineWords[mByteCount] = line_word;
-  mBytes[mByteCount] = flagged_byte;
-
-  mByteCount++;
-
-  return (mByteCount == 36);
-}
-
 //
 // The number of bytes in the block.
 //
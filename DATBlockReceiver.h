@@ -38,7 +38,7 @@
 class DATBlockReceiver {
 protected:
   DATBlockReceiver() {};
-  ~DATBlockReceiver() {};
+  virtual ~DATBlockReceiver() {};
 
 public:
   virtual void TrackDetected(bool up) = 0;
@@ -43,9 +43,6 @@
 DATFrame::DATFrame() : mC1Errors(0), mC1UncorrectableErrors(0),
   mC2UncorrectableErrors(0)
 {
-  size_t i;
-  
-  memset(mDataIsValid, 0, sizeof(mDataIsValid));
 }
 
 DATFrame::~DATFrame()
@@ -58,60 +55,21 @@ DATFrame::~DATFrame()
 void
 DATFrame::FillFromTrackPair(const Track& A, const Track& B)
 {
-  bool everything_ok = true;
-
-  //
-  // Retrieve pointers to the data and meta-data in the A and B tracks passed
-  // by the caller.
-  //
-  const Track::DataArray& a_bytes = A.Data();
-  const Track::DataArray& b_bytes = B.Data();
-  const Track::ValidityArray& a_valid = A.DataValid();
-  const Track::ValidityArray& b_valid = B.DataValid();
-  
   //
   // De-multiplex the bytes from the A and B tracks into their respective
-  // positions in the frame.
+  // positions in the frame, noting along the way whether they are all
+  // good.
   //
-  // (Taken from DDS spec Section 9.3.4 G4 Sub-Group, there is likely the same
-  // logic specified in the DAT Conference Standard as well).
-  //
-  for (size_t column = 0; column < 2; column++) {
-    for (size_t word = 0; word < 1456; word++) {
-      size_t source_block =
-                                 (word %  52) + 
-                            75 * (word %   2) +
-                                 (word / 832);
-      size_t u = (column + 1) % 2;
-      size_t source_byte =
-                            2  * (u + word /  52)     -
-                                 (    word /  52) % 2 -
-                            32 * (    word / 832);
-      
-      if ((word % 2) == 0) {
-        mData[word][column]   = a_bytes[source_block][source_byte];
-        mData[word][column+2] = b_bytes[source_block][source_byte];
-        mDataIsValid[word][column]   = a_valid[source_block][source_byte];
-        mDataIsValid[word][column+2] = b_valid[source_block][source_byte];
-      } else {
-        mData[word][column]   = b_bytes[source_block][source_byte];
-        mData[word][column+2] = a_bytes[source_block][source_byte];
-        mDataIsValid[word][column]   = b_valid[source_block][source_byte];
-        mDataIsValid[word][column+2] = a_valid[source_block][source_byte];
-      }
-      everything_ok = everything_ok && mDataIsValid[word][column] &&
-                      mDataIsValid[word][column+2];
-    }
-  }
+  DATFrameView view(A, B);
+  bool everything_ok = view.Gather(0, DATFrameView::kRows, &mData[0][0],
+    mDataIsValid);
 
   //
   // Gather up error statistics from the two constituent tracks.
   //
-  mC1Errors = A.C1Errors() + B.C1Errors();
-  mC1UncorrectableErrors = A.C1UncorrectableErrors() +
-                           B.C1UncorrectableErrors();
-  mC2UncorrectableErrors = A.C2UncorrectableErrors() +
-                           B.C2UncorrectableErrors();
+  mC1Errors = view.C1Errors();
+  mC1UncorrectableErrors = view.C1UncorrectableErrors();
+  mC2UncorrectableErrors = view.C2UncorrectableErrors();
 
   if (mC2UncorrectableErrors && everything_ok) {
     //
@@ -168,3 +126,94 @@ DATFrame::C2UncorrectableErrors() const
 {
   return mC2UncorrectableErrors;
 }
+
+//
+// The frame's rows in terms of the track data.
+//
+// (Taken from DDS spec Section 9.3.4 G4 Sub-Group, there is likely the same
+// logic specified in the DAT Conference Standard as well).
+//
+constexpr
+DATFrameView::Schedule::Schedule()
+  : source()
+{
+  for (size_t word = 0; word < kRows; word++) {
+    size_t source_block =
+                               (word %  52) +
+                          75 * (word %   2) +
+                               (word / 832);
+    size_t source_byte =
+                          2  * (word /  52)     -
+                               (word /  52) % 2 -
+                          32 * (word / 832);
+
+    source[word] = (uint16_t) (source_block * Track::kBlockSize + source_byte);
+  }
+}
+
+const DATFrameView::Schedule DATFrameView::kSchedule;
+
+DATFrameView::DATFrameView()
+  : mA(NULL), mB(NULL)
+{
+}
+
+DATFrameView::DATFrameView(const Track& A, const Track& B)
+  : mA(&A), mB(&B)
+{
+}
+
+void
+DATFrameView::Attach(const Track& A, const Track& B)
+{
+  mA = &A;
+  mB = &B;
+}
+
+void
+DATFrameView::Gather(size_t first, size_t count, uint8_t *data) const
+{
+  if (mA == NULL) {
+    memset(data, 0, count * DATFrame::kBytesPerRow);
+    return;
+  }
+
+  const uint8_t *track[2] = { &mA->Data()[0][0], &mB->Data()[0][0] };
+
+  for (size_t row = first; row < first + count; row++) {
+    const uint8_t *x = track[row & 1] + kSchedule.source[row];
+    const uint8_t *y = track[~row & 1] + kSchedule.source[row];
+
+    data[0] = x[2];
+    data[1] = x[0];
+    data[2] = y[2];
+    data[3] = y[0];
+    data += DATFrame::kBytesPerRow;
+  }
+}
+
+bool
+DATFrameView::OK() const
+{
+  return C2UncorrectableErrors() == 0;
+}
+
+size_t
+DATFrameView::C1Errors() const
+{
+  return mA == NULL ? 0 : mA->C1Errors() + mB->C1Errors();
+}
+
+size_t
+DATFrameView::C1UncorrectableErrors() const
+{
+  return mA == NULL ? 0 :
+    mA->C1UncorrectableErrors() + mB->C1UncorrectableErrors();
+}
+
+size_t
+DATFrameView::C2UncorrectableErrors() const
+{
+  return mA == NULL ? 0 :
+    mA->C2UncorrectableErrors() + mB->C2UncorrectableErrors();
+}
@@ -32,6 +32,7 @@
 
 #include <stdint.h>
 #include "Track.h"
+#include "BitMask.h"
 
 //
 // A DAT frame is a pair of tracks, one read from the negative azimuth head
@@ -58,7 +59,7 @@ public:
   static const size_t kBytesPerRow = 4;
 
   typedef uint8_t DataArray[kUserDataRows+kParityRows][kBytesPerRow];
-  typedef bool    ValidityArray[kUserDataRows+kParityRows][kBytesPerRow];
+  typedef BitMask<(kUserDataRows+kParityRows) * kBytesPerRow> ValidityArray;
 
   const DataArray& Data() const;
   const ValidityArray& Valid() const;
@@ -75,7 +76,7 @@ protected:
   //
   // The validity of each byte of data. (Sometimes the lower-level reading
   // routines can definitively detect that certain bytes were read
-  // incorrectly).
+  // incorrectly). Byte 'j' of row 'i' is bit i * kBytesPerRow + j.
   //
   ValidityArray mDataIsValid;
 
@@ -90,4 +91,122 @@ protected:
   size_t mC2UncorrectableErrors;
 };
 
+//
+// A DAT frame read straight out of its track pair, without copying it
+// into a DATFrame first. Readers that want only part of the frame, or
+// want it in a layout of their own, gather the rows they need from here.
+//
+// Where each row comes from is worked out once, at compile time, from
+// the interleave pattern. A row is two bytes from one track and the same
+// two bytes from the other, so a row costs one table lookup.
+//
+// The tracks must outlive the view.
+//
+class DATFrameView {
+public:
+  DATFrameView();
+  DATFrameView(const Track& A, const Track& B);
+
+  void Attach(const Track& A, const Track& B);
+
+  static const size_t kRows = DATFrame::kUserDataRows + DATFrame::kParityRows;
+
+  //
+  // Byte 'column' of row 'row'.
+  //
+  uint8_t Byte(size_t row, size_t column) const;
+
+  //
+  // Copy rows 'first' to 'first' + 'count' - 1, kBytesPerRow bytes each,
+  // out to 'data'; and, in the second form, their validity to 'valid',
+  // starting at bit 0. The second form returns whether every byte was
+  // valid. A view with no tracks attached gathers erased zeros.
+  //
+  void Gather(size_t first, size_t count, uint8_t *data) const;
+  template <size_t kBits>
+  bool Gather(size_t first, size_t count, uint8_t *data,
+    BitMask<kBits>& valid) const;
+
+  bool   OK() const;
+  size_t C1Errors() const;
+  size_t C1UncorrectableErrors() const;
+  size_t C2UncorrectableErrors() const;
+
+protected:
+  //
+  // The offset, in the track data, of column 1 of each row. Column 0 is
+  // two bytes on. Even rows take columns 0 and 1 from the A track and 2
+  // and 3 from the B track; odd rows the other way around.
+  //
+  struct Schedule {
+    uint16_t source[kRows];
+
+    constexpr Schedule();
+  };
+
+  static const Schedule kSchedule;
+
+  const Track *mA;
+  const Track *mB;
+};
+
+inline uint8_t
+DATFrameView::Byte(size_t row, size_t column) const
+{
+  if (mA == NULL)
+    return 0;
+
+  const Track *track = ((row ^ (column >> 1)) & 1) ? mB : mA;
+  const size_t source = kSchedule.source[row] + 2 - 2 * (column & 1);
+
+  return (&track->Data()[0][0])[source];
+}
+
+template <size_t kBits>
+bool
+DATFrameView::Gather(size_t first, size_t count, uint8_t *data,
+  BitMask<kBits>& valid) const
+{
+  const size_t kRowsPerWord = 64 / DATFrame::kBytesPerRow;
+
+  Gather(first, count, data);
+
+  if (mA == NULL) {
+    valid.Fill(false);
+    return false;
+  }
+
+  const Track::ValidityArray *row_valid[2] = {
+    &mA->DataValid(), &mB->DataValid()
+  };
+  bool everything_ok = true;
+
+  //
+  // Pick out each row's four validity bits, and store them a word's worth
+  // of rows at a time.
+  //
+  for (size_t i = 0; i < count; i += kRowsPerWord) {
+    const size_t rows = count - i < kRowsPerWord ? count - i : kRowsPerWord;
+    uint64_t bits = 0;
+
+    for (size_t r = 0; r < rows; r++) {
+      const size_t row = first + i + r;
+      const size_t source = kSchedule.source[row];
+      const uint64_t x = row_valid[row & 1]->Get(source, 3);
+      const uint64_t y = row_valid[~row & 1]->Get(source, 3);
+
+      bits |= ((x >> 2) | (x & 1) << 1 | (y >> 2) << 2 | (y & 1) << 3) <<
+              (r * DATFrame::kBytesPerRow);
+    }
+
+    const size_t n = rows * DATFrame::kBytesPerRow;
+    const uint64_t all = n == 64 ? ~(uint64_t) 0 : ((uint64_t) 1 << n) - 1;
+
+    valid.Put(i * DATFrame::kBytesPerRow, n, bits);
+    everything_ok &= bits == all;
+  }
+
+  return everything_ok;
+}
+
 #endif
@@ -46,6 +46,14 @@ public:
   virtual bool IsFrame(const Track& a, const Track& b) = 0;
   virtual void ReceiveFrame(const Track& a, const Track& b) = 0;
   virtual void Stop() = 0;
+
+  //
+  // The sub-code item that names the frame a track belongs to (both
+  // tracks of a frame carry the same one), if the track has it.
+  //
+  virtual bool FrameKey(const Track& track, const uint8_t **key) = 0;
+
+  static const size_t kFrameKeySize = 7;
 };
 
 #endif
@@ -0,0 +1,323 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <string.h>
+#include "DATPipeline.h"
+#include "TrackPool.h"
+
+DATPipeline::DATPipeline(DATTrackReceiver& receiver)
+  : mBlocks(kBlockSlots), mTracks(kTrackSlots), mSender(*this),
+    mAssembler(mSender), mReceiver(receiver), mStarted(false),
+    mBlockCount(0)
+{
+  memset(&mBlockQueue, 0, sizeof(mBlockQueue));
+  memset(&mTrackQueue, 0, sizeof(mTrackQueue));
+  memset(&mFrontEnd, 0, sizeof(mFrontEnd));
+  memset(&mAssembly, 0, sizeof(mAssembly));
+  memset(&mOutput, 0, sizeof(mOutput));
+
+  //
+  // Have enough tracks on hand to fill the track ring, plus the one
+  // being assembled and the pair being framed, so that the threads
+  // don't have to allocate any.
+  //
+  TrackPool::Shared().Reserve(kTrackSlots + 3);
+}
+
+DATPipeline::~DATPipeline()
+{
+  if (mStarted)
+    Stop();
+}
+
+bool
+DATPipeline::Start()
+{
+  BlockEvent *event;
+
+  mFrontEnd.start = Now();
+
+  if (pthread_create(&mAssemblerThread, NULL, AssemblerMain, this) != 0)
+    return false;
+
+  if (pthread_create(&mOutputThread, NULL, OutputMain, this) != 0) {
+    //
+    // Wind the assembler back down. (Its end marker fits in the empty
+    // track ring.)
+    //
+    event = ReserveBlockEvent();
+    event->type = BlockEvent::STOP;
+    mBlocks.Publish();
+    pthread_join(mAssemblerThread, NULL);
+    return false;
+  }
+
+  mStarted = true;
+
+  return true;
+}
+
+void
+DATPipeline::TrackDetected(bool up)
+{
+  BlockEvent *event = ReserveBlockEvent();
+
+  event->type = up ? BlockEvent::TRACK_UP : BlockEvent::TRACK_DOWN;
+  mBlocks.Publish();
+}
+
+void
+DATPipeline::ReceiveBlock(const DATBlock& block)
+{
+  BlockEvent *event = ReserveBlockEvent();
+
+  event->type = BlockEvent::BLOCK;
+  event->block = block;
+  mBlocks.Publish();
+
+  if ((++mBlockCount & 63) == 0)
+    Sample(mBlockQueue, mBlocks.Depth());
+}
+
+void
+DATPipeline::ReceiveATFTone(int toneNumber)
+{
+  BlockEvent *event = ReserveBlockEvent();
+
+  event->type = BlockEvent::ATF_TONE;
+  event->tone = toneNumber;
+  mBlocks.Publish();
+}
+
+void
+DATPipeline::Stop()
+{
+  BlockEvent *event;
+
+  if (!mStarted)
+    return;
+
+  event = ReserveBlockEvent();
+  event->type = BlockEvent::STOP;
+  mBlocks.Publish();
+  mFrontEnd.end = Now();
+
+  pthread_join(mAssemblerThread, NULL);
+  pthread_join(mOutputThread, NULL);
+  mStarted = false;
+}
+
+//
+// Get a slot in the block ring, waiting for one if stage 2 has fallen
+// that far behind.
+//
+DATPipeline::BlockEvent *
+DATPipeline::ReserveBlockEvent()
+{
+  BlockEvent *event;
+  unsigned int tries;
+  double start;
+
+  event = mBlocks.Reserve();
+  if (event != NULL)
+    return event;
+
+  start = Now();
+  tries = 0;
+  while ((event = mBlocks.Reserve()) == NULL)
+    SPSCRing<BlockEvent>::Backoff(tries);
+  mFrontEnd.waiting += Now() - start;
+
+  return event;
+}
+
+void *
+DATPipeline::AssemblerMain(void *pipeline)
+{
+  ((DATPipeline *) pipeline)->Assemble();
+  return NULL;
+}
+
+void *
+DATPipeline::OutputMain(void *pipeline)
+{
+  ((DATPipeline *) pipeline)->Output();
+  return NULL;
+}
+
+//
+// Stage 2: put the blocks together into tracks and correct them.
+//
+void
+DATPipeline::Assemble()
+{
+  BlockEvent *event;
+  unsigned int tries;
+  double start;
+  bool stop;
+
+  mAssembly.start = Now();
+
+  for (stop = false; !stop; mBlocks.Consume()) {
+    event = mBlocks.Peek();
+    if (event == NULL) {
+      start = Now();
+      tries = 0;
+      while ((event = mBlocks.Peek()) == NULL)
+        SPSCRing<BlockEvent>::Backoff(tries);
+      mAssembly.waiting += Now() - start;
+    }
+
+    switch (event->type) {
+    case BlockEvent::BLOCK:
+      mAssembler.ReceiveBlock(event->block);
+      break;
+    case BlockEvent::TRACK_UP:
+      mAssembler.TrackDetected(true);
+      break;
+    case BlockEvent::TRACK_DOWN:
+      mAssembler.TrackDetected(false);
+      break;
+    case BlockEvent::ATF_TONE:
+      mAssembler.ReceiveATFTone(event->tone);
+      break;
+    case BlockEvent::STOP:
+      mAssembler.Stop();
+      stop = true;
+      break;
+    }
+  }
+
+  mAssembly.end = Now();
+}
+
+//
+// Hand a finished track (or the NULL end marker) to stage 3.
+//
+void
+DATPipeline::SendTrack(Track *track)
+{
+  Track **slot;
+  unsigned int tries;
+  double start;
+
+  slot = mTracks.Reserve();
+  if (slot == NULL) {
+    start = Now();
+    tries = 0;
+    while ((slot = mTracks.Reserve()) == NULL)
+      SPSCRing<Track *>::Backoff(tries);
+    mAssembly.waiting += Now() - start;
+  }
+
+  *slot = track;
+  mTracks.Publish();
+
+  Sample(mTrackQueue, mTracks.Depth());
+}
+
+//
+// Stage 3: pair the tracks and decode and write out the frames.
+//
+void
+DATPipeline::Output()
+{
+  Track **slot;
+  Track *track;
+  unsigned int tries;
+  double start;
+
+  mOutput.start = Now();
+
+  for (;;) {
+    slot = mTracks.Peek();
+    if (slot == NULL) {
+      start = Now();
+      tries = 0;
+      while ((slot = mTracks.Peek()) == NULL)
+        SPSCRing<Track *>::Backoff(tries);
+      mOutput.waiting += Now() - start;
+    }
+
+    track = *slot;
+    mTracks.Consume();
+
+    if (track == NULL)
+      break;
+    mReceiver.ReceiveTrack(track);
+  }
+
+  mReceiver.Stop();
+
+  mOutput.end = Now();
+}
+
+void
+DATPipeline::Report(FILE *out) const
+{
+  const StageStats *stages[] = { &mFrontEnd, &mAssembly, &mOutput };
+  const char *names[] = { "front end", "assembly/ECC", "output" };
+  const QueueStats *queues[] = { &mBlockQueue, &mTrackQueue };
+  const char *queueNames[] = { "block queue", "track queue" };
+  const size_t capacities[] = { mBlocks.Capacity(), mTracks.Capacity() };
+  int i;
+
+  for (i = 0; i < 3; i++) {
+    double total = stages[i]->end - stages[i]->start;
+    double busy = total > 0 ? 100.0 * (total - stages[i]->waiting) / total : 0;
+    fprintf(out, "Pipeline %-12s %5.1f%% busy, %.3f s waiting\n", names[i],
+      busy, stages[i]->waiting);
+  }
+
+  for (i = 0; i < 2; i++) {
+    double average = queues[i]->samples == 0 ? 0 :
+      (double) queues[i]->depthSum / queues[i]->samples;
+    fprintf(out, "Pipeline %-12s depth %.1f average, %zu max of %zu\n",
+      queueNames[i], average, queues[i]->depthMax, capacities[i]);
+  }
+}
+
+void
+DATPipeline::Sample(QueueStats& stats, size_t depth)
+{
+  stats.samples++;
+  stats.depthSum += depth;
+  if (depth > stats.depthMax)
+    stats.depthMax = depth;
+}
+
+double
+DATPipeline::Now()
+{
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
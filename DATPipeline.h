@@ -0,0 +1,162 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_DAT_PIPELINE_H
+#define RDAT_DAT_PIPELINE_H
+
+//
+// Runs the back end of the decoder on threads of its own, so that the
+// slicer never waits for error correction or for output.
+//
+// The pipeline has three stages, each on its own thread:
+//
+//   1. The front end, on the caller's thread: slicing, deframing and
+//      word decoding, which arrive here as blocks and track events.
+//   2. Track assembly and error correction (Track::Complete()).
+//   3. Track pairing, frame decoding and output, in the track receiver.
+//
+// The stages are joined by bounded, lock-free rings. Blocks are copied
+// into the first ring as they come off the word receiver; finished
+// tracks are handed down the second ring by pointer, along with their
+// ownership.
+//
+
+#include <stdio.h>
+#include <pthread.h>
+#include "DATBlockReceiver.h"
+#include "DATTrackReceiver.h"
+#include "DATTrackAssembler.h"
+#include "SPSCRing.h"
+
+class DATPipeline : public DATBlockReceiver {
+public:
+  DATPipeline(DATTrackReceiver& receiver);
+  ~DATPipeline();
+
+  //
+  // Start the back end threads. Fails if they can't be had.
+  //
+  bool Start();
+
+  //
+  // Front end input, as for any block receiver.
+  //
+  void TrackDetected(bool up);
+  void ReceiveBlock(const DATBlock& block);
+  void ReceiveATFTone(int toneNumber);
+
+  //
+  // All input is done. Waits for the back end to finish everything
+  // that has been queued, up to and including stopping the receiver.
+  //
+  void Stop();
+
+  //
+  // Print the queue depths and how busy each stage was.
+  //
+  void Report(FILE *out) const;
+
+  //
+  // Ring sizes: enough blocks for a few dozen tracks, so that the front
+  // end rides out the correction of a bad track, and enough tracks for
+  // a burst of output.
+  //
+  static const size_t kBlockSlots = 8192;
+  static const size_t kTrackSlots = 64;
+
+protected:
+  //
+  // An entry in the block ring.
+  //
+  struct BlockEvent {
+    enum { BLOCK, TRACK_UP, TRACK_DOWN, ATF_TONE, STOP } type;
+    int tone;
+    DATBlock block;
+  };
+
+  //
+  // How full a ring has been and how long a stage has spent waiting.
+  //
+  struct QueueStats {
+    size_t samples;
+    size_t depthSum;
+    size_t depthMax;
+  };
+  struct StageStats {
+    double start;
+    double end;
+    double waiting;
+  };
+
+  //
+  // Passes the assembler's completed tracks, and then a NULL track to
+  // mark the end, on to stage 3.
+  //
+  class TrackSender : public DATTrackReceiver {
+  public:
+    TrackSender(DATPipeline& pipeline) : mPipeline(pipeline) {}
+    void ReceiveTrack(Track *track) { mPipeline.SendTrack(track); }
+    void Stop() { mPipeline.SendTrack(NULL); }
+  protected:
+    DATPipeline& mPipeline;
+  };
+
+  void SendTrack(Track *track);
+
+  BlockEvent *ReserveBlockEvent();
+  static void *AssemblerMain(void *pipeline);
+  static void *OutputMain(void *pipeline);
+  void Assemble();
+  void Output();
+  static void Sample(QueueStats& stats, size_t depth);
+  static double Now();
+
+  SPSCRing<BlockEvent> mBlocks;
+  SPSCRing<Track *> mTracks;
+
+  TrackSender mSender;
+  DATTrackAssembler mAssembler;
+  DATTrackReceiver& mReceiver;
+
+  bool mStarted;
+  pthread_t mAssemblerThread;
+  pthread_t mOutputThread;
+
+  //
+  // Statistics, each written only by the thread that owns it.
+  //
+  size_t mBlockCount;
+  QueueStats mBlockQueue;
+  QueueStats mTrackQueue;
+  StageStats mFrontEnd;
+  StageStats mAssembly;
+  StageStats mOutput;
+};
+
+#endif
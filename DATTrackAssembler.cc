@@ -0,0 +1,145 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include "DATTrackAssembler.h"
+#include "TrackPool.h"
+
+DATTrackAssembler::DATTrackAssembler(DATTrackReceiver& receiver)
+  : mTracking(false), mATF3Threshold(10), mATF2Count(0), mATF3Count(0),
+    mDeferC2(false),
+    mCurrentTrack(TrackPool::Shared().Get(Track::HEAD_UNKNOWN)),
+    mReceiver(receiver)
+{
+}
+
+DATTrackAssembler::~DATTrackAssembler()
+{
+  TrackPool::Shared().Put(mCurrentTrack);
+}
+
+//
+// Receive DAT 35-byte block.
+//
+void
+DATTrackAssembler::ReceiveBlock(const DATBlock& block)
+{
+  if (!mTracking)
+    //
+    // This shouldn't happen.
+    //
+    return;
+  
+  //
+  // Incorporate the block into the current track.
+  //
+  mCurrentTrack->AddBlock(block);
+}
+
+//
+// Handle a track start/stop indication.
+//
+void
+DATTrackAssembler::TrackDetected(bool up)
+{
+  mTracking = up;
+  
+  //
+  // Wait until tracking is complete (goes down).
+  //
+  if (up)
+    return;
+
+  //
+  // Our current track is complete. Give it a chance to perform
+  // all error correction.
+  //
+  if (mDeferC2)
+    mCurrentTrack->CompleteC1();
+  else
+    mCurrentTrack->Complete();
+  
+  //
+  // If there were any ATF tones detected, use the majority count to
+  // determine whether this was a negative azimuth track or a positive
+  // azimuth track.
+  //
+  // Currently only ATF3 (negative azimuth signal) is likely to be detected,
+  // so if its count is high enough, assume that the track is an A track.
+  //
+  mCurrentTrack->SetATFCounts(mATF2Count, mATF3Count);
+  if (mATF3Count > mATF3Threshold) {
+    mCurrentTrack->SetHead(Track::HEAD_A);
+  }
+
+  //
+  // Hand the track off.
+  //
+  mReceiver.ReceiveTrack(mCurrentTrack);
+
+  //
+  // Reset the automatic track finding tone counts.
+  //
+  mATF2Count = 0;
+  mATF3Count = 0;
+
+  //
+  // Prepare a new track, recycling one that has been finished with.
+  //
+  mCurrentTrack = TrackPool::Shared().Get(Track::HEAD_UNKNOWN);
+}
+
+//
+// Handle detection of a specific automatic track finding tone.
+//
+void
+DATTrackAssembler::ReceiveATFTone(int toneNumber)
+{
+  if (toneNumber == 2)
+    mATF2Count++;
+  else if (toneNumber == 3)
+    mATF3Count++;
+}
+
+void
+DATTrackAssembler::SetDeferC2(bool defer)
+{
+  mDeferC2 = defer;
+}
+
+void
+DATTrackAssembler::Stop()
+{
+  if (mTracking)
+    TrackDetected(false);
+
+  mReceiver.Stop();
+}
@@ -0,0 +1,111 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_DAT_TRACK_ASSEMBLER_H
+#define RDAT_DAT_TRACK_ASSEMBLER_H
+
+//
+// A DAT track assembler receives DAT blocks and carrier information and
+// collects the blocks of each head swipe into a track. When a track ends
+// it is error corrected, marked with the head it most likely came from,
+// and handed to a track receiver.
+//
+// Assembly depends only on the samples of the swipe itself, so separate
+// stretches of a capture can be assembled independently of each other.
+//
+
+#include "DATBlockReceiver.h"
+#include "DATTrackReceiver.h"
+#include "Track.h"
+
+class DATTrackAssembler : public DATBlockReceiver {
+public:
+  DATTrackAssembler(DATTrackReceiver& receiver);
+  ~DATTrackAssembler();
+
+  //
+  // A track is starting (when going up) or stopping
+  // (when going down).
+  //
+  void TrackDetected(bool up);
+
+  //
+  // Receive DAT 35-byte block.
+  //
+  void ReceiveBlock(const DATBlock& block);
+
+  //
+  // An automatic track finding (ATF) tone has been identified within a
+  // track.  
+  //
+  void ReceiveATFTone(int toneNumber);
+  
+  //
+  // All input is done, nothing else will be coming.
+  //
+  void Stop();
+
+  //
+  // Leave C2 to whoever receives the tracks: give them only
+  // Track::CompleteC1(), as is wanted of reads to be fused.
+  //
+  void SetDeferC2(bool defer);
+
+protected:
+  //
+  // The current tracking state.
+  //
+  bool mTracking;
+  
+  //
+  // The number of ATF2 and ATF3 tones received in this track. These
+  // tones help distinguish negative azimuth (A) tracks from positive azimuth
+  // (B) tracks.
+  //
+  const int mATF3Threshold;
+  int mATF2Count;
+  int mATF3Count;
+  
+  //
+  // Whether tracks are handed on having had only C1.
+  //
+  bool mDeferC2;
+
+  //
+  // Track object for collecting the blocks we receive.
+  //
+  Track *mCurrentTrack;
+  
+  //
+  // Where completed tracks go.
+  //
+  DATTrackReceiver& mReceiver;
+};
+
+#endif
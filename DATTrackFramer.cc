@@ -31,137 +31,243 @@
 #include <stdint.h>
 #include <string.h>
 #include "DATTrackFramer.h"
+#include "TrackPool.h"
 
 DATTrackFramer::DATTrackFramer(DATFrameReceiver& receiver)
-  : mReceiver(receiver), mLastTrack(NULL), mTracking(false),
-    mCurrentTrack(new Track(Track::HEAD_UNKNOWN)),
-    mATF2Count(0), mATF3Count(0), mATF3Threshold(10)
+  : mRescuedTracks(0), mTracks(0), mReliabilityRescues(0), mPending(0),
+    mLastFrameEnd(0), mRecoveredFrames(0), mInferredFrames(0),
+    mDiscardedTracks(0), mVerbose(true), mReceiver(receiver)
 {
+  for (size_t i = 0; i < Track::kMaxCorrectionPasses; i++)
+    mRescuedBytes[i] = 0;
 }
 
 DATTrackFramer::~DATTrackFramer()
 {
-  delete mCurrentTrack;
-  delete mLastTrack;
+  for (size_t i = 0; i < mPending; i++)
+    TrackPool::Shared().Put(mWindow[i].track);
 }
 
 //
-// Receive DAT 35-byte block.
+// Receive the next completed track.
 //
 void
-DATTrackFramer::ReceiveBlock(const DATBlock& block)
+DATTrackFramer::ReceiveTrack(Track *track)
 {
-  if (!mTracking)
+  if (mVerbose)
+    printf("Track ATF3 Count: %d\n", track->ATF3Count());
+
+  size_t rescued = 0;
+  for (unsigned int i = 0; i < track->ExtraPasses(); i++) {
+    mRescuedBytes[i] += track->RescuedBytes(i);
+    rescued += track->RescuedBytes(i);
+  }
+  if (rescued > 0)
+    mRescuedTracks++;
+  mTracks++;
+  mReliabilityRescues += track->ReliabilityRescues();
+
+  Pending received = { track, mTracks };
+
+  //
+  // See if this track completes a frame (a pair of tracks) with one of
+  // those waiting, the latest first. The downstream frame receiver has
+  // the say over the track that came just before this one. Those before
+  // that pair with this one only by a matching frame key.
+  //
+  for (size_t i = mPending; i-- > 0; ) {
+    const Track& earlier = *mWindow[i].track;
+    bool pairs = i + 1 == mPending ? mReceiver.IsFrame(earlier, *track) :
+                 KeysMatch(earlier, *track) && MayPair(earlier, *track);
+
+    if (!pairs)
+      continue;
+
     //
-    // This shouldn't happen.
+    // Any tracks in between are strays. Those before may still pair
+    // up with each other, ahead of this frame.
     //
+    Pending first = mWindow[i];
+    if (i + 1 < mPending)
+      mRecoveredFrames++;
+    while (mPending > i + 1)
+      Discard(i + 1);
+    Remove(i, 1);
+    Settle(mPending);
+    Deliver(first, received);
     return;
-  
+  }
+
   //
-  // Incorporate the block into the current track.
+  // No partner yet. Make room for this track to wait for one, settling
+  // the fate of the oldest tracks.
   //
-  mCurrentTrack->AddBlock(block);
+  if (mPending == kWindow)
+    Settle(Inferable(0) ? 2 : 1);
+
+  mWindow[mPending++] = received;
+}
+
+void
+DATTrackFramer::Stop()
+{
+  Settle(mPending);
+
+  if (mRecoveredFrames + mInferredFrames > 0)
+    fprintf(stderr, "Track pairing: %zu frames paired past strays, %zu "
+      "inferred, %zu tracks discarded.\n", mRecoveredFrames,
+      mInferredFrames, mDiscardedTracks);
+
+  if (Track::CorrectionPasses() > 1) {
+    fprintf(stderr, "Extra correction passes rescued bytes in %zu of %zu "
+      "tracks:", mRescuedTracks, mTracks);
+    for (unsigned int i = 0; i + 1 < Track::CorrectionPasses(); i++)
+      fprintf(stderr, " %s%zu", i == 0 ? "" : "+ ", mRescuedBytes[i]);
+    fprintf(stderr, "\n");
+  }
+
+  if (Track::ReliabilityTrials() > 0)
+    fprintf(stderr, "Reliability retries rescued %zu C2 codewords.\n",
+      mReliabilityRescues);
+
+  mReceiver.Stop();
+}
+
+void
+DATTrackFramer::SetVerbose(bool verbose)
+{
+  mVerbose = verbose;
+}
+
+size_t
+DATTrackFramer::RecoveredFrames() const
+{
+  return mRecoveredFrames;
+}
+
+size_t
+DATTrackFramer::InferredFrames() const
+{
+  return mInferredFrames;
+}
+
+size_t
+DATTrackFramer::DiscardedTracks() const
+{
+  return mDiscardedTracks;
 }
 
 //
-// Handle a track start/stop indication.
+// Do both tracks carry the same frame key?
 //
-void
-DATTrackFramer::TrackDetected(bool up)
+bool
+DATTrackFramer::KeysMatch(const Track& a, const Track& b)
 {
-  mTracking = up;
-  
-  //
-  // Wait until tracking is complete (goes down).
-  //
-  if (up)
-    return;
+  const uint8_t *a_key, *b_key;
+
+  return mReceiver.FrameKey(a, &a_key) && mReceiver.FrameKey(b, &b_key) &&
+         memcmp(a_key, b_key, DATFrameReceiver::kFrameKeySize) == 0;
+}
+
+//
+// Are the heads that read the tracks the right way round (as far as is
+// known) for 'a' to be the first track of a frame and 'b' the second?
+//
+bool
+DATTrackFramer::MayPair(const Track& a, const Track& b) const
+{
+  return a.GetHead() != Track::HEAD_B && b.GetHead() != Track::HEAD_A;
+}
+
+//
+// Can the waiting track 'i' be taken to pair with the one after it,
+// without a matching frame key?
+//
+bool
+DATTrackFramer::Inferable(size_t i)
+{
+  if (i + 1 >= mPending)
+    return false;
+
+  const Pending& a = mWindow[i];
+  const Pending& b = mWindow[i + 1];
+  const uint8_t *a_key, *b_key;
+  bool a_keyed = mReceiver.FrameKey(*a.track, &a_key);
+  bool b_keyed = mReceiver.FrameKey(*b.track, &b_key);
 
   //
-  // Our current track is complete. Give it a chance to perform
-  // all error correction.
-  //
-  mCurrentTrack->Complete();
-  
-  //
-  // If there were any ATF tones detected, use the majority count to
-  // determine whether this was a negative azimuth track or a positive
-  // azimuth track.
-  //
-  // Currently only ATF3 (negative azimuth signal) is likely to be detected,
-  // so if its count is high enough, assume that the track is an A track.
+  // They must have been read one after the other, the right way round,
+  // and not be known to belong to different frames.
   //
-  printf("Track ATF3 Count: %d\n", mATF3Count);
-  if (mATF3Count > mATF3Threshold) {
-    mCurrentTrack->SetHead(Track::HEAD_A);
-  }
+  if (b.sequence != a.sequence + 1 || !MayPair(*a.track, *b.track) ||
+      (a_keyed && b_keyed))
+    return false;
 
   //
-  // See if this track completes a frame (a pair of tracks).
+  // If the second track has a partner waiting after it, by frame key,
+  // it is the first track of that frame instead.
   //
-  if (mLastTrack == NULL) {
-    //
-    // There is no previous track. Just stash this one away.
-    //
-    mLastTrack = mCurrentTrack;
-  } else {
-    //
-    // We have a previous track. Are these two a pair or are they
-    // separate?
-    //
-    if (mReceiver.IsFrame(*mLastTrack, *mCurrentTrack)) {
-      //
-      // According to the downstream frame receiver, these two
-      // tracks pair into a full frame. Give them to the
-      // receiver as such.
-      //
-      mReceiver.ReceiveFrame(*mLastTrack, *mCurrentTrack);
-      
-      //
-      // The pair have been shipped off. Prepare for a new set.
-      //
-      delete mLastTrack;
-      delete mCurrentTrack;
-      mLastTrack = NULL;
+  for (size_t j = i + 2; j < mPending; j++)
+    if (KeysMatch(*b.track, *mWindow[j].track))
+      return false;
+
+  bool a_head = a.track->GetHead() == Track::HEAD_A;
+  bool after_frame = mLastFrameEnd != 0 && a.sequence == mLastFrameEnd + 1;
+
+  if (a_keyed || b_keyed)
+    return a_head || after_frame;
+
+  return a_head && after_frame;
+}
+
+//
+// Deliver, or throw away, the oldest 'count' waiting tracks, in order.
+//
+void
+DATTrackFramer::Settle(size_t count)
+{
+  while (count > 0) {
+    if (count >= 2 && Inferable(0)) {
+      Pending first = mWindow[0];
+      Pending second = mWindow[1];
+      Remove(0, 2);
+      mInferredFrames++;
+      Deliver(first, second);
+      count -= 2;
     } else {
-      //
-      // These two don't pair. Dump the last track and continue
-      // searching.
-      //
-      delete mLastTrack;
-      mLastTrack = mCurrentTrack;
+      Discard(0);
+      count--;
     }
   }
-
-  //
-  // Reset the automatic track finding tone counts.
-  //
-  mATF2Count = 0;
-  mATF3Count = 0;
-
-  //
-  // Prepare a new track.
-  //
-  mCurrentTrack = new Track(Track::HEAD_UNKNOWN);
 }
 
 //
-// Handle detection of a specific automatic track finding tone.
+// Take 'count' tracks, starting with 'first', out of the window.
 //
 void
-DATTrackFramer::ReceiveATFTone(int toneNumber)
+DATTrackFramer::Remove(size_t first, size_t count)
 {
-  if (toneNumber == 2)
-    mATF2Count++;
-  else if (toneNumber == 3)
-    mATF3Count++;
+  for (size_t i = first; i + count < mPending; i++)
+    mWindow[i] = mWindow[i + count];
+  mPending -= count;
 }
 
 void
-DATTrackFramer::Stop()
+DATTrackFramer::Discard(size_t i)
 {
-  if (mTracking)
-    TrackDetected(false);
+  TrackPool::Shared().Put(mWindow[i].track);
+  Remove(i, 1);
+  mDiscardedTracks++;
+}
 
-  mReceiver.Stop();
+//
+// Hand a frame to the receiver, and the tracks back to the pool.
+//
+void
+DATTrackFramer::Deliver(const Pending& a, const Pending& b)
+{
+  mReceiver.ReceiveFrame(*a.track, *b.track);
+  mLastFrameEnd = b.sequence;
+  TrackPool::Shared().Put(a.track);
+  TrackPool::Shared().Put(b.track);
 }
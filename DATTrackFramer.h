@@ -31,67 +31,123 @@
 #define RDAT_DAT_TRACK_FRAMER_H
 
 //
-// A DAT track framer receives DAT blocks and carrier information.
-// It tries to organize the blocks into tracks and then tries to
-// pair the tracks into frames with the help of an underlying frame
-// receiver to direct the pairing.
+// A DAT track framer receives completed tracks, in the order in which
+// they were read, and tries to pair them into frames with the help of
+// an underlying frame receiver to direct the pairing. (The tracks
+// themselves are put together by a DATTrackAssembler.)
 //
 // Once track pairs are detected, they are handed to the frame receiver
 // for further handling. The frame handler is in charge of interpreting
 // the data as DAT audio or DDS.
 //
+// Tracks that don't pair straight away wait in a small window rather
+// than being thrown out, so that a track whose partner was lost, or
+// whose sub-codes couldn't be read, gets another chance:
+//
+//   - A track whose frame key (see DATFrameReceiver::FrameKey()) matches
+//     that of an earlier track in the window pairs with it, even if
+//     stray tracks came in between.
+//   - Failing that, two tracks that came in one after the other pair up
+//     if nothing rules it out (different frame keys, or heads the wrong
+//     way round) and something speaks for it: the first track was read
+//     by the A head (by its ATF tones), or it came straight after the
+//     end of the last frame, in which case it ought to be an A track.
+//     Unless both of those hold, at least one of the tracks must have a
+//     frame key.
+//
+// Those guesses are only made for tracks leaving the window, by which
+// time a keyed partner would have turned up. Frames still go downstream
+// in the order in which their tracks were read.
+//
 
-#include "DATBlockReceiver.h"
+#include "DATTrackReceiver.h"
 #include "DATFrameReceiver.h"
 #include "Track.h"
 
-class DATTrackFramer : public DATBlockReceiver {
+class DATTrackFramer : public DATTrackReceiver {
 public:
   DATTrackFramer(DATFrameReceiver& receiver);
   ~DATTrackFramer();
 
   //
-  // A track is starting (when going up) or stopping
-  // (when going down).
+  // Receive the next completed track.
   //
-  void TrackDetected(bool up);
+  void ReceiveTrack(Track *track);
 
   //
-  // Receive DAT 35-byte block.
+  // All input is done, nothing else will be coming. If extra error
+  // correction passes or reliability retries were allowed, reports what
+  // they achieved.
   //
-  void ReceiveBlock(const DATBlock& block);
+  void Stop();
 
   //
-  // An automatic track finding (ATF) tone has been identified within a
-  // track.  
+  // Whether to print what is known of each track as it arrives (the
+  // default).
   //
-  void ReceiveATFTone(int toneNumber);
-  
+  void SetVerbose(bool verbose);
+
   //
-  // All input is done, nothing else will be coming.
+  // The most tracks held waiting for a partner.
   //
-  void Stop();
+  static const size_t kWindow = 4;
+
+  //
+  // The number of frames paired up by a frame key past stray tracks, by
+  // inference, and the number of tracks thrown away unpaired.
+  //
+  size_t RecoveredFrames() const;
+  size_t InferredFrames() const;
+  size_t DiscardedTracks() const;
 
 protected:
   //
-  // The current tracking state.
+  // A track waiting for a partner, and its place in the order in which
+  // tracks were received (counting from one).
   //
-  bool mTracking;
-  
+  struct Pending {
+    Track *track;
+    size_t sequence;
+  };
+
+  bool KeysMatch(const Track& a, const Track& b);
+  bool MayPair(const Track& a, const Track& b) const;
+  bool Inferable(size_t i);
+  void Settle(size_t count);
+  void Remove(size_t first, size_t count);
+  void Discard(size_t i);
+  void Deliver(const Pending& a, const Pending& b);
+
   //
-  // The number of ATF2 and ATF3 tones received in this track. These
-  // tones help distinguish negative azimuth (A) tracks from positive azimuth
-  // (B) tracks.
+  // Totals, over every track, of the bytes each extra error correction
+  // pass rescued, and the number of tracks that had some rescued.
   //
-  const int mATF3Threshold;
-  int mATF2Count;
-  int mATF3Count;
-  
+  size_t mRescuedBytes[Track::kMaxCorrectionPasses];
+  size_t mRescuedTracks;
+  size_t mTracks;
+
+  //
+  // Total C2 codewords rescued by retrying with reliability erasures.
+  //
+  size_t mReliabilityRescues;
+
   //
-  // Track object for collecting the blocks we receive.
+  // The tracks waiting for a partner, oldest first.
   //
-  Track *mCurrentTrack;
-  Track *mLastTrack;
+  Pending mWindow[kWindow];
+  size_t mPending;
+
+  //
+  // The sequence number of the second track of the last frame delivered,
+  // or zero.
+  //
+  size_t mLastFrameEnd;
+
+  size_t mRecoveredFrames;
+  size_t mInferredFrames;
+  size_t mDiscardedTracks;
+
+  bool mVerbose;
   
   //
   // Full frame receiver. This is where DAT and DDS begin
@@ -31,13 +31,6 @@
 #include <stdint.h>
 #include "DATWordReceiver.h"
 
-enum {
-  WORD_INVALID = 0x8000,
-  WORD_SYNC = 0x100,
-  WORD_ATF2 = 0x200, // ATF Tone F2 (1 and 8 zeros), positive az. signal
-  WORD_ATF3 = 0x400, // ATF Tone F3 (1 and 5 zeros), negative az. signal
-};
-
 //
 // R-DAT 10-to-8 conversion table.
 //
@@ -162,104 +155,7 @@ const uint16_t TenToEightTable[0x400] = {
   0x00fc, 0x00ef, 0x00fd, 0x8000, 0x00ea, 0x00fe, 0x00eb,
 };
 
-DATWordReceiver::DATWordReceiver(DATBlockReceiver *r, bool dump) : mDump(dump),
-  mBlockReceiver(r)
-{
-}
-
-DATWordReceiver::~DATWordReceiver()
-{
-}
-
-//
-// Receive a word.
-//
-void
-DATWordReceiver::ReceiveWord(int word)
-{
-  uint16_t decode;
-
-  if (word > 0 && word <= 0x3ff) {
-    //
-    // Decode the ten-bit word into an eight-bit byte.
-    //
-    decode = TenToEightTable[word];
-  } else {
-    //
-    // Caller is sending us something weird.
-    //
-    decode = WORD_INVALID;
-  }
-
-  if (mDump)
-    DumpWord(word, decode);
-  else
-    ReceiveWord(word, decode);
-}
-
-void
-DATWordReceiver::DumpWord(uint16_t raw, uint16_t decode)
-{
-  if (decode & WORD_SYNC) {
-    printf("\nSYNC");
-  } else if (decode & WORD_ATF2) {
-    printf(" AT2");
-  } else if (decode & WORD_ATF3) {
-    printf(" AT3");
-  } else if (decode & WORD_INVALID) {
-    printf(" XXX");
-  } else {
-    printf(" %02x", decode);
-  }
-}
-
-void
-DATWordReceiver::ReceiveWord(uint16_t raw, uint16_t decode)
-{
-  if (decode & WORD_SYNC)
-    mBlock.Reset();
-  if (decode & WORD_ATF2)
-    mBlockReceiver->ReceiveATFTone(2);
-  if (decode & WORD_ATF3)
-    mBlockReceiver->ReceiveATFTone(3);
-
-  bool complete = mBlock.AddByte(raw, decode);
-
-  if (complete)
-    DumpCurrentBlock();
-}
-
-void
-DATWordReceiver::DumpCurrentBlock()
-{
-  mBlockReceiver->ReceiveBlock(mBlock);
-  mBlock.Reset();
-}
-
-void
-DATWordReceiver::TrackDetected(bool up)
-{
-  if (mDump)
-    return;
-
-  if (up == false) {
-    //
-    // Track is ending. Dump any pending blocks.
-    //
-    DumpCurrentBlock();
-  }
-
-  //
-  // Notify the block receiver of the new track state.
-  //
-  mBlockReceiver->TrackDetected(up);
-}
-
-void
-DATWordReceiver::Stop()
+DATWordReceiver::DATWordReceiver(DATBlockReceiver *r, bool dump)
+  : DATWordReceiverT<DATBlockReceiver>(r, dump)
 {
-  if (mBlock.Size() > 0)
-    DumpCurrentBlock();
-  if (mBlockReceiver != NULL)
-    mBlockReceiver->Stop();
 }
@@ -30,14 +30,35 @@
 #ifndef RDAT_DAT_WORD_RECEIVER_H
 #define RDAT_DAT_WORD_RECEIVER_H
 
+#include <stdio.h>
 #include <stdint.h>
 #include "DATBlockReceiver.h"
 
-class DATWordReceiver
+//
+// R-DAT 10-to-8 conversion table, and the flags it sets on the bytes.
+//
+extern const uint16_t TenToEightTable[0x400];
+
+enum {
+  WORD_INVALID = 0x8000,
+  WORD_SYNC = 0x100,
+  WORD_ATF2 = 0x200, // ATF Tone F2 (1 and 8 zeros), positive az. signal
+  WORD_ATF3 = 0x400, // ATF Tone F3 (1 and 5 zeros), negative az. signal
+};
+
+//
+// Decodes ten-bit line words into bytes and collects them into blocks,
+// or just dumps them, for raw mode.
+//
+// Parameterized on the type of the block receiver so that a pipeline
+// built from concrete types compiles down to direct calls; DATWordReceiver,
+// below, hands blocks to any DATBlockReceiver.
+//
+template <class BlockReceiver>
+class DATWordReceiverT
 {
 public:
-  DATWordReceiver(DATBlockReceiver *r, bool dump = true);
-  ~DATWordReceiver();
+  DATWordReceiverT(BlockReceiver *r, bool dump = true);
   
   //
   // Receive a word.
@@ -72,7 +93,119 @@ protected:
   //
   // The downstream block receiver.
   //
-  DATBlockReceiver *mBlockReceiver;
+  BlockReceiver *mBlockReceiver;
+};
+
+template <class BlockReceiver>
+inline
+DATWordReceiverT<BlockReceiver>::DATWordReceiverT(BlockReceiver *r, bool dump)
+  : mDump(dump), mBlockReceiver(r)
+{
+}
+
+//
+// Receive a word.
+//
+template <class BlockReceiver>
+inline void
+DATWordReceiverT<BlockReceiver>::ReceiveWord(int word)
+{
+  uint16_t decode;
+
+  if (word > 0 && word <= 0x3ff) {
+    //
+    // Decode the ten-bit word into an eight-bit byte.
+    //
+    decode = TenToEightTable[word];
+  } else {
+    //
+    // Caller is sending us something weird.
+    //
+    decode = WORD_INVALID;
+  }
+
+  if (mDump)
+    DumpWord(word, decode);
+  else
+    ReceiveWord(word, decode);
+}
+
+template <class BlockReceiver>
+inline void
+DATWordReceiverT<BlockReceiver>::DumpWord(uint16_t raw, uint16_t decode)
+{
+  if (decode & WORD_SYNC) {
+    printf("\nSYNC");
+  } else if (decode & WORD_ATF2) {
+    printf(" AT2");
+  } else if (decode & WORD_ATF3) {
+    printf(" AT3");
+  } else if (decode & WORD_INVALID) {
+    printf(" XXX");
+  } else {
+    printf(" %02x", decode);
+  }
+}
+
+template <class BlockReceiver>
+inline void
+DATWordReceiverT<BlockReceiver>::ReceiveWord(uint16_t raw, uint16_t decode)
+{
+  if (decode & WORD_SYNC)
+    mBlock.Reset();
+  if (decode & WORD_ATF2)
+    mBlockReceiver->ReceiveATFTone(2);
+  if (decode & WORD_ATF3)
+    mBlockReceiver->ReceiveATFTone(3);
+
+  bool complete = mBlock.AddByte(raw, decode);
+
+  if (complete)
+    DumpCurrentBlock();
+}
+
+template <class BlockReceiver>
+inline void
+DATWordReceiverT<BlockReceiver>::DumpCurrentBlock()
+{
+  mBlockReceiver->ReceiveBlock(mBlock);
+  mBlock.Reset();
+}
+
+template <class BlockReceiver>
+inline void
+DATWordReceiverT<BlockReceiver>::TrackDetected(bool up)
+{
+  if (mDump)
+    return;
+
+  if (up == false) {
+    //
+    // Track is ending. Dump any pending blocks.
+    //
+    DumpCurrentBlock();
+  }
+
+  //
+  // Notify the block receiver of the new track state.
+  //
+  mBlockReceiver->TrackDetected(up);
+}
+
+template <class BlockReceiver>
+inline void
+DATWordReceiverT<BlockReceiver>::Stop()
+{
+  if (mBlock.Size() > 0)
+    DumpCurrentBlock();
+  if (mBlockReceiver != NULL)
+    mBlockReceiver->Stop();
+}
+
+class DATWordReceiver : public DATWordReceiverT<DATBlockReceiver>
+{
+public:
+  DATWordReceiver(DATBlockReceiver *r, bool dump = true);
 };
 
 #endif
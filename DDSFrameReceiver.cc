@@ -86,6 +86,12 @@ DDSFrameReceiver::IsFrame(const Track& A, const Track& B)
   return (A_good && B_good && memcmp(A_absframe, B_absframe, 7) == 0);
 }
 
+bool
+DDSFrameReceiver::FrameKey(const Track& track, const uint8_t **key)
+{
+  return track.GetSubcode(3, key);
+}
+
 void
 DDSFrameReceiver::ReceiveFrame(const Track& a, const Track& b)
 {
@@ -99,6 +105,17 @@ DDSFrameReceiver::ReceiveFrame(const Track& a, const Track& b)
   // de-interleaving.
   //
   DDSGroup3::DecodeError result = frame.DecodeFrame(a, b);
+
+  if (result == DDSGroup3::A_MISSING_SUBCODE_3 ||
+      result == DDSGroup3::B_MISSING_SUBCODE_3) {
+    //
+    // (The track framer may pair up tracks without it.) Without the
+    // pack 3 there is nothing to go on as to where the frame belongs.
+    //
+    printf("\nGroup 3 decode: %s\n", DDSGroup3::ErrorDescription(result));
+    fflush(stdout);
+    return;
+  }
   
   //
   // Dump information about the frame.
@@ -148,7 +165,7 @@ DDSFrameReceiver::ReceiveFrame(const Track& a, const Track& b)
   //
   // Print out error statistics for the frame.
   //
-  const DATFrame& underFrame = frame.Frame();
+  const DATFrameView& underFrame = frame.Frame();
 
   unsigned int c1_errors = underFrame.C1Errors();
   unsigned int c1_uncorrectable = underFrame.C1UncorrectableErrors();
@@ -61,6 +61,11 @@ public:
   //
   bool IsFrame(const Track& a, const Track& b);
 
+  //
+  // A track's frame key: its absolute frame number (sub-code 3).
+  //
+  bool FrameKey(const Track& track, const uint8_t **key);
+
   //
   // Receive a DDS frame (a pair of tracks, A and B)
   //
@@ -78,36 +78,23 @@ DDSGroup1::DDSGroup1(DDSGroup3& g3)
   //
   
   //
-  // Fetch a pointer to the data and validity arrays of the G3 frame.
+  // Gather the data and its validity straight from the G3 frame's
+  // tracks, leaving out the header row.
   //
-  const DATFrame::DataArray& data = g3.Frame().Data();
-  const DATFrame::ValidityArray& valid = g3.Frame().Valid();
+  g3.Frame().Gather(1, DATFrame::kUserDataRows - 1, mData, mDataIsValid);
   
   uint16_t lfsr = 1;
   
-  for (size_t i = 1; i < DATFrame::kUserDataRows; i++) {
-    for (size_t j = 0; j < DATFrame::kBytesPerRow; j++) {
-      //
-      // Look up the data.
-      //
-      uint8_t byte = data[i][j];
-      
-      //
-      // Dewhiten it.
-      //
-      byte ^= (lfsr & 0xff);
-      
-      //
-      // Store it in our array.
-      //
-      mData[(i - 1) * 4 + j] = byte;
-      mDataIsValid[(i - 1) * 4 + j] = valid[i][j];
+  for (size_t i = 0; i < kSize; i++) {
+    //
+    // Dewhiten it.
+    //
+    mData[i] ^= (lfsr & 0xff);
        
-      //
-      // Crank the LFSR.
-      //
-      lfsr = (((uint16_t)(G2LFSR[lfsr & 0x1ff])) << 7) | ((lfsr >> 8) & 0xff);
-    }
+    //
+    // Crank the LFSR.
+    //
+    lfsr = (((uint16_t)(G2LFSR[lfsr & 0x1ff])) << 7) | ((lfsr >> 8) & 0xff);
   }
 }
 
@@ -33,6 +33,7 @@
 #include <stdint.h>
 #include <stddef.h>
 #include "DDSGroup3.h"
+#include "BitMask.h"
 
 class DDSGroup1 {
 public:
@@ -42,7 +43,7 @@ public:
   static const size_t kSize = 1439 * 4;
   
   typedef uint8_t DataArray[kSize];
-  typedef bool    ValidArray[kSize];
+  typedef BitMask<kSize> ValidArray;
   
   const DataArray& Data() const;
   const ValidArray& Valid() const;
@@ -64,11 +64,11 @@ static bool GetSubcodePack(unsigned int id, const Track& A, const Track& B,
 //        +------+-----------------------------------+
 //
 static inline uint8_t
-Di(const DATFrame::DataArray& data, size_t i)
+Di(const DATFrameView& data, size_t i)
 {
   size_t row = (i/4) + 1;
   size_t col = (i%4);
-  return data[row][col];
+  return data.Byte(row, col);
 }
 
 //
@@ -90,7 +90,7 @@ DDSGroup3::~DDSGroup3()
 //
 // The underlying frame object upon which this group 3 is built.
 //
-const DATFrame&
+const DATFrameView&
 DDSGroup3::Frame() const
 {
   return mFrame;
@@ -193,11 +193,19 @@ DDSGroup3::DecodeFrame(const Track& A, const Track& B)
   // Retrieve the items from subcode id #3 from both tracks.
   // 
   const uint8_t *a_subcode, *b_subcode;
+  bool a_good = A.GetSubcode(3, &a_subcode);
+  bool b_good = B.GetSubcode(3, &b_subcode);
   
-  if (!A.GetSubcode(3, &a_subcode))
+  //
+  // (Once the track framer has paired the tracks, one of them missing its
+  // pack is no reason to give up; the other track's will do.)
+  //
+  if (!a_good && !b_good)
     return A_MISSING_SUBCODE_3;
-  if (!B.GetSubcode(3, &b_subcode))
-    return B_MISSING_SUBCODE_3;
+  if (!a_good)
+    a_subcode = b_subcode;
+  if (!b_good)
+    b_subcode = a_subcode;
   
   //
   // Every track should have a valid subcode pack 3. Let's fetch it from
@@ -350,9 +358,9 @@ DDSGroup3::HandleDataAreaFrame(const DDSSubcodePack3& sub3, const Track& A,
   sub4.Decode(subcode);
 
   //
-  // Fill in the frame data by demultiplexing the data from both tracks.
+  // Read the frame data through the demultiplexing schedule from here on.
   //
-  mFrame.FillFromTrackPair(A, B);
+  mFrame.Attach(A, B);
   
   //
   // Make certain everything was received ok.
@@ -367,15 +375,15 @@ DDSGroup3::HandleDataAreaFrame(const DDSSubcodePack3& sub3, const Track& A,
   // The logical frame id should be repeated bytes 1 and 3 of the first
   // row of data.
   //
-  const DATFrame::DataArray& data = mFrame.Data();
+  const DATFrameView& data = mFrame;
   
-  if (data[0][1] != original_lfid ||
-      data[0][3] != original_lfid ||
+  if (data.Byte(0, 1) != original_lfid ||
+      data.Byte(0, 3) != original_lfid ||
       //
       // Check that the format id is also zero.
       //
-      data[0][0] != 0 ||
-      data[0][2] != 0) {
+      data.Byte(0, 0) != 0 ||
+      data.Byte(0, 2) != 0) {
     return INVALID_HEADER;  
   }
 
@@ -117,9 +117,10 @@ public:
   ///////////////////////////////////////////////////////////////////////////
 
   //
-  // Access the underlying DAT frame object.
+  // Access the underlying DAT frame, which reads from the track pair given
+  // to DecodeFrame() (and so is only good for as long as they are).
   //
-  const DATFrame& Frame() const;
+  const DATFrameView& Frame() const;
 
   //
   // The tape area to which this frame purports to belong.
@@ -228,7 +229,7 @@ protected:
   //
   // The data in this group.
   //
-  DATFrame mFrame;
+  DATFrameView mFrame;
 };
 
 #endif
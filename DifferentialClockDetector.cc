@@ -28,6 +28,7 @@
 //
 
 #include "DifferentialClockDetector.h"
+#include "WindowScan.h"
 
 #include <math.h>
 
@@ -131,24 +132,15 @@ DifferentialClockDetector::AddAndDetect(float sample)
 void
 DifferentialClockDetector::EvaluateClock()
 {
-  int i, maxI, minI;
+  int maxI;
   float max, min, ratio;
 
-  for (max = min = mWindow[0], i = 1, maxI = 0; i < mWindowSize; i++)
-  {
-    //
-    // Find the highest peak.
-    //
-    if (mWindow[i] > max) {
-      max = mWindow[i];
-      maxI = i;
-    }
-    //
-    // And the lowest valley.
-    //
-    if (mWindow[i] < min)
-      min = mWindow[i];
-  }
+  //
+  // Find the highest peak and the lowest valley.
+  //
+  max = min = mWindow[0];
+  maxI = 0;
+  ScanWindow(mWindow, mWindowSize, max, maxI, min);
   
   if (maxI != mMaximumDiffPos) {
     //
@@ -167,10 +159,7 @@ DifferentialClockDetector::EvaluateClock()
   // If there is a significant difference between the highest
   // peak and the lowest valley then we have a good clock signal.
   //
-  if (max > 0.0)
-    ratio = min / max;
-  else
-    ratio = 0.0;
+  ratio = WindowRatio(min, max, mDetectionThresholdRatio);
 
   bool newDetectionState = ratio <= mDetectionThresholdRatio;
 
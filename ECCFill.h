@@ -65,7 +65,13 @@ public:
   // position represents a known quantity or a known erasure. Some codes
   // use this information to enhance error correction.
   //
-  virtual bool& Valid(size_t position) = 0;
+  virtual bool Valid(size_t position) const = 0;
+
+  //
+  // Change the validity of the selected byte position. (Validity is kept
+  // packed, a bit per byte, so it can't be handed out by reference).
+  //
+  virtual void SetValid(size_t position, bool valid) = 0;
 };
 
 #endif
@@ -125,13 +125,24 @@ ECCFill_C1::Data(size_t position)
   return mData[block][byte];
 }
 
-bool&
-ECCFill_C1::Valid(size_t position)
+bool
+ECCFill_C1::Valid(size_t position) const
+{
+  size_t block, byte;
+  
+  compute_offsets(position, mInterleaveSet == ECCFill_C1::EVEN ? 0 : 1,
+                  mBlockPairStart, block, byte);
+  
+  return mDataIsValid.Test(block * Track::kBlockSize + byte);
+}
+
+void
+ECCFill_C1::SetValid(size_t position, bool valid)
 {
   size_t block, byte;
   
   compute_offsets(position, mInterleaveSet == ECCFill_C1::EVEN ? 0 : 1,
                   mBlockPairStart, block, byte);
   
-  return mDataIsValid[block][byte];
+  mDataIsValid.Set(block * Track::kBlockSize + byte, valid);
 }
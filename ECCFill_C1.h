@@ -49,6 +49,11 @@ public:
   //
   bool CurrentPosition(unsigned int& block, unsigned int& offset);
 
+  //
+  // The number of vectors in a track: two for every pair of blocks.
+  //
+  static const unsigned int kVectors = Track::kBlocks;
+
   ////////////////////////////////////////////////////////////////////////////
   // Methods from parent ECCIterator interface.
   
@@ -70,7 +75,8 @@ public:
   // Methods from grandparent ECCFill interface.
 
   uint8_t& Data(size_t position);
-  bool&    Valid(size_t position);
+  bool     Valid(size_t position) const;
+  void     SetValid(size_t position, bool valid);
 
   // End methods from grandparent ECCFill interface.
   ////////////////////////////////////////////////////////////////////////////
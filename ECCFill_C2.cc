@@ -127,10 +127,20 @@ ECCFill_C2::Data(size_t position)
   return mData[position*4 + offset][mByteSlice];
 }
 
-bool&
-ECCFill_C2::Valid(size_t position)
+bool
+ECCFill_C2::Valid(size_t position) const
+{
+  size_t offset = (size_t) mGroup;
+
+  return mDataIsValid.Test((position*4 + offset) * Track::kBlockSize +
+    mByteSlice);
+}
+
+void
+ECCFill_C2::SetValid(size_t position, bool valid)
 {
   size_t offset = (size_t) mGroup;
 
-  return mDataIsValid[position*4 + offset][mByteSlice];
+  mDataIsValid.Set((position*4 + offset) * Track::kBlockSize + mByteSlice,
+    valid);
 }
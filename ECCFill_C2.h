@@ -72,7 +72,8 @@ public:
   // Methods from grandparent ECCFill interface.
 
   uint8_t& Data(size_t position);
-  bool&    Valid(size_t position);
+  bool     Valid(size_t position) const;
+  void     SetValid(size_t position, bool valid);
 
   // End methods from grandparent ECCFill interface.
   ////////////////////////////////////////////////////////////////////////////
@@ -87,11 +88,7 @@ protected:
   
   //
   // The byte slice within the current group that is being evaluated.
-  // Even-numbered groups have 32 byte slices, odd-numbered groups only
-  // have 24.
   //
-  static const unsigned int kBytesEvenGroup = 32;
-  static const unsigned int kBytesOddGroup = 24;
   unsigned int mByteSlice;
   
   //
@@ -103,6 +100,20 @@ protected:
   //
   static const unsigned int kGroups = 4;
   unsigned int mGroup;
+
+public:
+  //
+  // Even-numbered groups have 32 byte slices, odd-numbered groups only
+  // have 24. The rest of each odd-numbered block holds C1 parity.
+  //
+  static const unsigned int kBytesEvenGroup = 32;
+  static const unsigned int kBytesOddGroup = 24;
+
+  //
+  // The number of vectors in a track.
+  //
+  static const unsigned int kVectors =
+    kGroups / 2 * (kBytesEvenGroup + kBytesOddGroup);
 };
 
 #endif
@@ -144,15 +144,28 @@ ECCFill_C3::Data(size_t position)
     return mECCData[offset];
 }
 
-bool&
-ECCFill_C3::Valid(size_t position)
+bool
+ECCFill_C3::Valid(size_t position) const
+{
+  bool isECC;
+  const size_t offset = compute_offset(position, mByteSlice, mTrackPair,
+    mInterleaveSet, isECC);
+
+  if (!isECC)
+    return mDataIsValid.Test(offset);
+  else
+    return mECCDataIsValid.Test(offset);
+}
+
+void
+ECCFill_C3::SetValid(size_t position, bool valid)
 {
   bool isECC;
   const size_t offset = compute_offset(position, mByteSlice, mTrackPair,
     mInterleaveSet, isECC);
 
   if (!isECC)
-    return mDataIsValid[offset];
+    mDataIsValid.Set(offset, valid);
   else
-    return mECCDataIsValid[offset];
+    mECCDataIsValid.Set(offset, valid);
 }
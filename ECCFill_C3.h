@@ -77,7 +77,8 @@ public:
   // Methods from grandparent ECCFill interface.
 
   uint8_t& Data(size_t position);
-  bool&    Valid(size_t position);
+  bool     Valid(size_t position) const;
+  void     SetValid(size_t position, bool valid);
 
   // End methods from grandparent ECCFill interface.
   ////////////////////////////////////////////////////////////////////////////
@@ -87,6 +88,16 @@ protected:
   static const unsigned int kTrackPairs = 2;
   static const unsigned int kInterleaves = 2;
 
+public:
+  //
+  // The number of vectors in a basic group. (The last byte slice has only
+  // one track pair.)
+  //
+  static const unsigned int kVectors =
+    ((kByteSlices - 1) * kTrackPairs + 1) * kInterleaves;
+
+protected:
+
   //
   // A reference to the underlying data block array from the basic group whence
   // these bytes come and to which they go once they are corrected.
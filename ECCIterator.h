@@ -78,7 +78,8 @@ public:
   // Methods inherited from ECCFill
 
   virtual uint8_t& Data(size_t position) = 0;
-  virtual bool& Valid(size_t position) = 0;
+  virtual bool Valid(size_t position) const = 0;
+  virtual void SetValid(size_t position, bool valid) = 0;
 
   // End Methods inherited from ECCFill
   ///////////////////////////////////////////////////////////////////////////
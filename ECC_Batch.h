@@ -0,0 +1,203 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_ECC_BATCH_H
+#define RDAT_ECC_BATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ECCFill.h"
+#include "ECC_Syndrome.h"
+
+//
+// A gather/scatter map for a set of codewords drawn from a flat array of
+// 'kBytes' bytes and a validity mask with a bit for each byte (as in a
+// Track).
+//
+// The map records, for every byte of every codeword, its offset from
+// the start of the array. It is built once, by walking a fill iterator,
+// so the iterator remains the one definition of which bytes make up
+// which codeword. After that, collecting a codeword is just a table
+// lookup per byte; there are no virtual calls and no divisions.
+//
+// It also records the reverse, for every byte of the array, so that an
+// erasure found in the mask can be charged to its codeword directly.
+//
+template <class Code, size_t kWords, size_t kBytes>
+class ECC_GatherMap {
+public:
+  //
+  // Walk 'fill', whose bytes lie in the array starting at 'base'.
+  //
+  template <class Fill>
+  ECC_GatherMap(Fill fill, const uint8_t *base);
+
+  //
+  // The number of codewords in the map.
+  //
+  size_t Count() const { return mCount; }
+
+  //
+  // The offset of byte 'j' of codeword 'k'.
+  //
+  size_t Offset(size_t j, size_t k) const { return mOffset[j][k]; }
+
+  //
+  // The codeword, and the byte within it, that the byte at 'offset'
+  // belongs to, as k * 64 + j; kNowhere if it belongs to none.
+  //
+  static const uint16_t kNowhere = 0xffff;
+  uint16_t Place(size_t offset) const { return mPlace[offset]; }
+
+protected:
+  static_assert(kWords * 64 <= kNowhere, "codeword places must fit");
+
+  uint16_t mOffset[Code::kN][kWords];
+  uint16_t mPlace[kBytes];
+  size_t   mCount;
+};
+
+//
+// Error correction for every codeword of a track as one batch.
+//
+// The codewords are gathered through a map into the transposed layout
+// that ECC_Syndrome works on, and their syndromes computed together. Only
+// the codewords with erasures or a nonzero syndrome need to go through
+// the corrector; Vector() hands each one over as a fill that reads and
+// writes the track directly, so the corrector's Dump() scatters its
+// result straight back. 'Mask' is the BitMask type of the validity.
+//
+template <class Code, size_t kWords, class Mask>
+class ECC_Batch : public ECC_Screen<Code, kWords> {
+public:
+  typedef ECC_GatherMap<Code, kWords, Mask::kSize> Map;
+
+  ECC_Batch(const Map& map, uint8_t *data, Mask& valid);
+
+  //
+  // Gather every codeword and compute the syndromes.
+  //
+  void Screen();
+
+  size_t Count() const { return mMap.Count(); }
+
+  //
+  // A fill for the k'th codeword.
+  //
+  class Vector : public ECCFill {
+  public:
+    Vector(const ECC_Batch& batch, size_t k) : mBatch(batch), mK(k) {}
+
+    uint8_t& Data(size_t position) {
+      return mBatch.mData[mBatch.mMap.Offset(position, mK)];
+    }
+    bool Valid(size_t position) const {
+      return mBatch.mValid.Test(mBatch.mMap.Offset(position, mK));
+    }
+    void SetValid(size_t position, bool valid) {
+      mBatch.mValid.Set(mBatch.mMap.Offset(position, mK), valid);
+    }
+
+  protected:
+    const ECC_Batch& mBatch;
+    const size_t mK;
+  };
+
+protected:
+  const Map& mMap;
+  uint8_t   *mData;
+  Mask&      mValid;
+};
+
+template <class Code, size_t kWords, size_t kBytes>
+template <class Fill>
+ECC_GatherMap<Code, kWords, kBytes>::ECC_GatherMap(Fill fill,
+  const uint8_t *base)
+{
+  size_t j, k;
+
+  for (size_t i = 0; i < kBytes; i++)
+    mPlace[i] = kNowhere;
+
+  for (k = 0; k < kWords && !fill.End(); k++, fill.Next()) {
+    for (j = 0; j < Code::kN; j++) {
+      mOffset[j][k] = (uint16_t) (&fill.Data(j) - base);
+      mPlace[mOffset[j][k]] = (uint16_t) (k * 64 + j);
+    }
+  }
+  mCount = k;
+}
+
+template <class Code, size_t kWords, class Mask>
+inline
+ECC_Batch<Code, kWords, Mask>::ECC_Batch(const Map& map, uint8_t *data,
+  Mask& valid)
+  : mMap(map), mData(data), mValid(valid)
+{
+}
+
+template <class Code, size_t kWords, class Mask>
+inline void
+ECC_Batch<Code, kWords, Mask>::Screen()
+{
+  const size_t count = mMap.Count();
+  size_t j, k;
+
+  //
+  // Gather a byte position at a time, so that each pass writes one
+  // contiguous row of the transposed buffer.
+  //
+  for (j = 0; j < Code::kN; j++)
+    for (k = 0; k < count; k++)
+      this->mWords[j][k] = mData[mMap.Offset(j, k)];
+
+  //
+  // Erasures are few. Rather than gather a bit for every byte, find the
+  // clear bits a word at a time and charge each to its codeword.
+  //
+  for (k = 0; k < count; k++)
+    this->mErasures[k] = 0;
+
+  for (size_t w = 0; w < Mask::kWords; w++) {
+    uint64_t clear = ~mValid.Word(w);
+    if (w == Mask::kWords - 1 && Mask::kSize % 64 != 0)
+      clear &= ((uint64_t) 1 << (Mask::kSize % 64)) - 1;
+    for (; clear != 0; clear &= clear - 1) {
+      const uint16_t place = mMap.Place(w * 64 + __builtin_ctzll(clear));
+      if (place != Map::kNowhere)
+        this->mErasures[place / 64] |= (uint64_t) 1 << (place % 64);
+    }
+  }
+  this->mCount = count;
+
+  Code::Syndromes().Compute(&this->mWords[0][0], &this->mSyndromes[0][0],
+    count, kWords);
+}
+
+#endif
@@ -30,70 +30,15 @@
 #ifndef RDAT_ECC_C1_H
 #define RDAT_ECC_C1_H
 
-#include <stdint.h>
-#include <stddef.h>
-#include "ECCFill.h"
+#include "ECC_Vector.h"
+#include "ReedSolomon.h"
 
-class ECC_C1 {
-public:
-  ECC_C1();
-  ~ECC_C1();
-  
-  typedef enum {
-    NO_ERRORS = 0,
-    CORRECTED,
-    UNCORRECTABLE
-  } Status;
-
-  //
-  // The block size and number of parity bytes for this code,
-  // respectively.
-  //
-  static const unsigned int kN = 32;
-  static const unsigned int kTwoT = 4;
-  static const unsigned int kT = kTwoT / 2;
-
-  //
-  // Fill this vector from the given filling source.
-  //
-  void Fill(ECCFill& filler);
-  
-  //
-  // Correct this vector, if possible. Returns the correction
-  // status.
-  //
-  Status Correct();
-
-  //
-  // Dump this corrected (or invalidated) vector back to its
-  // source.
-  //
-  void Dump(ECCFill& dumper);
-
-protected:
-  //
-  // Compute the syndrome of the current data.
-  // Returns true if all of the syndrome elements are zero.
-  //
-  bool ComputeSyndrome(uint8_t (&syndrome)[kTwoT]);
-
-  bool HandleSyndrome(uint8_t syndrome[kTwoT],
-     const uint8_t erasures[kTwoT], size_t numErasures);
-  
-  //
-  // The data in the vector.
-  //
-  uint8_t mData[kN];
-  
-  //
-  // Known erasures in this vector.
-  //
-  bool    mDataIsValid[kN];
-
-  //
-  // Number of corrections applied.
-  //
-  int     mCorrectionCount;
+//
+// DAT's (and DDS's) first level of error correction: a (32,28)
+// Reed-Solomon code over alternate bytes of a pair of blocks. It runs
+// ahead of C2 and leaves it bytes that are either right or marked.
+//
+class ECC_C1 : public ECC_Vector<ReedSolomon<32, 4>, ECC_IGNORE_ERASURES> {
 };
 
 #endif
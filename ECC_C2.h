@@ -30,60 +30,15 @@
 #ifndef RDAT_ECC_C2_H
 #define RDAT_ECC_C2_H
 
-#include <stdint.h>
-#include <stddef.h>
-#include "ECCFill.h"
+#include "ECC_Vector.h"
+#include "ReedSolomon.h"
 
-class ECC_C2 {
-public:
-  ECC_C2();
-  ~ECC_C2();
-  
-  typedef enum {
-    NO_ERRORS = 0,
-    CORRECTED,
-    UNCORRECTABLE
-  } Status;
-
-  //
-  // The block size and number of parity bytes for this code,
-  // respectively.
-  //
-  static const unsigned int kN = 32;
-  static const unsigned int kTwoT = 6;
-  static const unsigned int kT = kTwoT / 2;
-
-  //
-  // Fill this vector from the given source.
-  //
-  void Fill(ECCFill& fill);
-
-  //
-  // Correct this vector, if possible. Returns the correction
-  // status.
-  //
-  Status Correct();
-
-  //
-  // Dump this corrected (or invalidated) vector back to its
-  // source.
-  //
-  void Dump(ECCFill& fill);
-
-protected:
-  bool ComputeSyndrome(uint8_t syndrome[kTwoT]);
-  bool HandleSyndrome(uint8_t syndrome[kTwoT],
-     const uint8_t erasures[kTwoT], size_t numErasures);
-  
-  //
-  // The data in the vector.
-  //
-  uint8_t mData[kN];
-  
-  //
-  // Known erasures in this vector.
-  //
-  bool    mDataIsValid[kN];
+//
+// DAT's (and DDS's) second level of error correction: a (32,26)
+// Reed-Solomon code across the blocks of a track, decoded with the
+// erasures C1 leaves behind.
+//
+class ECC_C2 : public ECC_Vector<ReedSolomon<32, 6>, ECC_USE_ERASURES> {
 };
 
 #endif
@@ -30,60 +30,15 @@
 #ifndef RDAT_ECC_C3_H
 #define RDAT_ECC_C3_H
 
-#include <stdint.h>
-#include <stddef.h>
-#include "ECCFill.h"
+#include "ECC_Vector.h"
+#include "ReedSolomon.h"
 
-class ECC_C3 {
-public:
-  ECC_C3();
-  ~ECC_C3();
-  
-  typedef enum {
-    NO_ERRORS = 0,
-    CORRECTED,
-    UNCORRECTABLE
-  } Status;
-
-  //
-  // The block size and number of parity bytes for this code,
-  // respectively.
-  //
-  static const unsigned int kN = 46;
-  static const unsigned int kTwoT = 2;
-  static const unsigned int kT = kTwoT / 2;
-
-  //
-  // Fill this vector from the given source.
-  //
-  void Fill(ECCFill& fill);
-
-  //
-  // Correct this vector, if possible. Returns the correction
-  // status.
-  //
-  Status Correct();
-
-  //
-  // Dump this corrected (or invalidated) vector back to its
-  // source.
-  //
-  void Dump(ECCFill& fill);
-
-protected:
-  bool ComputeSyndrome(uint8_t syndrome[kTwoT]);
-  bool HandleSyndrome(uint8_t syndrome[kTwoT],
-     const uint8_t erasures[kTwoT], size_t numErasures);
-  
-  //
-  // The data in the vector.
-  //
-  uint8_t mData[kN];
-  
-  //
-  // Known erasures in this vector.
-  //
-  bool    mDataIsValid[kN];
+//
+// DDS's final level of error correction: a (46,44) Reed-Solomon code
+// across the tracks of a basic group, decoded with the erasures C1 and
+// C2 leave behind.
+//
+class ECC_C3 : public ECC_Vector<ReedSolomon<46, 2>, ECC_USE_ERASURES> {
 };
 
 #endif
@@ -30,29 +30,13 @@
 #include "ECC_GF28.h"
 
 //
-// The reduction polynomial for this field in binary representation.
-//
-// The real polynomial is understood to be:
-//
-//   g(x) = x^8 + x^4 + x^3 + x^2 + 1
-//
-// but we represent it here as g(2) with the 2^8 power removed.
-//
-static const uint8_t kReductionPoly = 0x1d;
-
-//
-// The field primitive generator.
-//
-// g(x) = x
-//
-// Here it is g(2)
-//
-static const uint8_t kAlpha = 2;
-
+// The field's tables are generated at compile time from its reduction
+// polynomial. The tables printed below, from util/ECC.py, are kept only
+// as a check on the generator.
 //
 // The fully generated field sequence, taken from successive powers of alpha.
 //
-static const uint8_t kPowAlpha[255] = {
+static constexpr uint8_t kPowAlpha[255] = {
   0x01,0x02,0x04,0x08,0x10,0x20,0x40,0x80,0x1d,0x3a,0x74,0xe8,0xcd,0x87,0x13,
   0x26,0x4c,0x98,0x2d,0x5a,0xb4,0x75,0xea,0xc9,0x8f,0x03,0x06,0x0c,0x18,0x30,
   0x60,0xc0,0x9d,0x27,0x4e,0x9c,0x25,0x4a,0x94,0x35,0x6a,0xd4,0xb5,0x77,0xee,
@@ -77,7 +61,7 @@ static const uint8_t kPowAlpha[255] = {
 // for each field element. (The entry for the zero field element is present,
 // but it of course has no valid value as log(0) is undefined).
 //
-static const uint8_t kLogAlpha[256] = {
+static constexpr uint8_t kLogAlpha[256] = {
   0x00,0x00,0x01,0x19,0x02,0x32,0x1a,0xc6,0x03,0xdf,0x33,0xee,0x1b,0x68,0xc7,
   0x4b,0x04,0x64,0xe0,0x0e,0x34,0x8d,0xef,0x81,0x1c,0xc1,0x69,0xf8,0xc8,0x08,
   0x4c,0x71,0x05,0x8a,0x65,0x2f,0xe1,0x24,0x0f,0x21,0x35,0x93,0x8e,0xda,0xf0,
@@ -103,7 +87,7 @@ static const uint8_t kLogAlpha[256] = {
 // has no valid inverse, but it is part of the table to make lookups
 // easier.
 //
-static const uint8_t kInverse[256] = {
+static constexpr uint8_t kInverse[256] = {
   0x00,0x01,0x8e,0xf4,0x47,0xa7,0x7a,0xba,0xad,0x9d,0xdd,0x98,0x3d,0xaa,0x5d,
   0x96,0xd8,0x72,0xc0,0x58,0xe0,0x3e,0x4c,0x66,0x90,0xde,0x55,0x80,0xa0,0x83,
   0x4b,0x2a,0x6c,0xed,0x39,0x51,0x60,0x56,0x2c,0x8a,0x70,0xd0,0x1f,0x4a,0x26,
@@ -124,6 +108,68 @@ static const uint8_t kInverse[256] = {
   0xfd
 };
 
+//
+// The generated tables.
+//
+struct GF28Tables {
+  uint8_t powAlpha[255];
+  uint8_t logAlpha[256];
+  uint8_t inverse[256];
+
+  //
+  // For each c, the even solution y of y^2 + y = c. (The other solution
+  // is y + 1.) Odd entries mark the c for which there is no solution.
+  //
+  uint8_t quadratic[256];
+
+  constexpr GF28Tables()
+    : powAlpha(), logAlpha(), inverse(), quadratic()
+  {
+    uint8_t a = 1;
+
+    for (size_t n = 0; n < 255; n++) {
+      powAlpha[n] = a;
+      logAlpha[a] = (uint8_t) n;
+      a = ECC_GF28_times_alpha(a);
+    }
+
+    //
+    // The inverse of alpha^n is alpha^(255-n).
+    //
+    for (size_t n = 0; n < 255; n++)
+      inverse[powAlpha[n]] = powAlpha[(255 - n) % 255];
+
+    for (size_t c = 0; c < 256; c++)
+      quadratic[c] = 1;
+    quadratic[0] = 0;
+    for (size_t n = 0; n < 255; n++) {
+      const uint8_t y = powAlpha[n];
+      const uint8_t c = powAlpha[(2 * n) % 255] ^ y;
+      if ((y & 1) == 0)
+        quadratic[c] = y;
+    }
+  }
+};
+
+static constexpr GF28Tables kTables;
+
+static constexpr bool
+tables_match(const uint8_t *a, const uint8_t *b, size_t n)
+{
+  for (size_t i = 0; i < n; i++)
+    if (a[i] != b[i])
+      return false;
+
+  return true;
+}
+
+static_assert(tables_match(kTables.powAlpha, kPowAlpha, 255),
+  "generated powers of alpha disagree with the printed table");
+static_assert(tables_match(kTables.logAlpha + 1, kLogAlpha + 1, 255),
+  "generated logarithms disagree with the printed table");
+static_assert(tables_match(kTables.inverse + 1, kInverse + 1, 255),
+  "generated inverses disagree with the printed table");
+
 uint8_t
 ECC_GF28_multiply(uint8_t a, uint8_t b)
 {
@@ -140,13 +186,30 @@ ECC_GF28_multiply(uint8_t a, uint8_t b)
   // Use the discrete logarithm table to make multiplicaton an O(1)
   // operation.
   //
-  return kPowAlpha[(kLogAlpha[a] + kLogAlpha[b]) % 255];
+  return kTables.powAlpha[(kTables.logAlpha[a] + kTables.logAlpha[b]) % 255];
 }
 
 uint8_t
 ECC_GF28_invert(uint8_t a)
 {
-  return kInverse[a];
+  return kTables.inverse[a];
+}
+
+//
+// Return the power of alpha that makes 'a'. (Zero has no logarithm.)
+//
+uint8_t
+ECC_GF28_log_alpha(uint8_t a)
+{
+  return kTables.logAlpha[a];
+}
+
+bool
+ECC_GF28_solve_quadratic(uint8_t c, uint8_t& y)
+{
+  y = kTables.quadratic[c];
+
+  return (y & 1) == 0;
 }
 
 //
@@ -175,5 +238,5 @@ ECC_GF28_pow_alpha(uint8_t n)
   if (n > 254)
     n = 0;
   
-  return kPowAlpha[n];
+  return kTables.powAlpha[n];
 }
@@ -33,9 +33,52 @@
 #include <stdint.h>
 #include <stddef.h>
 
+//
+// The reduction polynomial for this field in binary representation.
+//
+// The real polynomial is understood to be:
+//
+//   g(x) = x^8 + x^4 + x^3 + x^2 + 1
+//
+// but we represent it here as g(2) with the 2^8 power removed.
+//
+static const uint8_t kECC_GF28_ReductionPoly = 0x1d;
+
+//
+// Multiply a field element by the field primitive generator, alpha
+// (g(x) = x, or g(2) = 2): shift it left and reduce it.
+//
+constexpr uint8_t
+ECC_GF28_times_alpha(uint8_t a)
+{
+  return (uint8_t) ((a << 1) ^ ((a & 0x80) ? kECC_GF28_ReductionPoly : 0));
+}
+
+//
+// Alpha raised to the n'th power, worked out step by step so that it
+// can be used to generate tables at compile time.
+//
+constexpr uint8_t
+ECC_GF28_generate_pow_alpha(size_t n)
+{
+  uint8_t r = 1;
+
+  for (size_t i = 0; i < n % 255; i++)
+    r = ECC_GF28_times_alpha(r);
+
+  return r;
+}
+
 uint8_t ECC_GF28_multiply(uint8_t a, uint8_t b);
 uint8_t ECC_GF28_invert(uint8_t a);
 uint8_t ECC_GF28_pow_alpha(uint8_t n);
+uint8_t ECC_GF28_log_alpha(uint8_t a);
 uint8_t ECC_GF28_evaluate(const uint8_t p[], uint8_t x, size_t n);
 
+//
+// Solve y^2 + y = c. There are either two solutions, y and y + 1, or
+// none. Returns false if there are none.
+//
+bool ECC_GF28_solve_quadratic(uint8_t c, uint8_t& y);
+
 #endif
@@ -0,0 +1,288 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <string.h>
+#include <time.h>
+#include "ECC_GF28_Arith.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RDAT_ECC_GF28_X86
+#include <immintrin.h>
+#endif
+
+//
+// All of the tables are generated at compile time from the field's
+// reduction polynomial, like those in ECC_GF28.cc.
+//
+constexpr
+ECC_GF28_Lookups::Tables::Tables()
+  : log(), exp(), inverse()
+{
+  uint8_t a = 1;
+
+  for (size_t n = 0; n < 255; n++) {
+    exp[n] = a;
+    exp[n + 255] = a;
+    log[a] = (uint16_t) n;
+    a = ECC_GF28_times_alpha(a);
+  }
+  log[0] = kLogZero;
+
+  for (size_t n = 0; n < 255; n++)
+    inverse[exp[n]] = exp[255 - n];
+}
+
+const ECC_GF28_Lookups::Tables ECC_GF28_Lookups::kTables;
+
+constexpr
+ECC_GF28_ProductTable::Products::Products()
+  : product()
+{
+  const Tables tables;
+
+  for (size_t a = 1; a < 256; a++)
+    for (size_t b = 1; b < 256; b++)
+      product[a][b] = tables.exp[tables.log[a] + tables.log[b]];
+}
+
+const ECC_GF28_ProductTable::Products ECC_GF28_ProductTable::kProducts;
+
+//
+// The affine instruction computes bit i of each result byte as the parity
+// of the byte AND matrix byte 7 - i. Multiplication by c takes bit j of
+// its input to c * alpha^j, so matrix byte 7 - i has bit j set if bit i
+// of c * alpha^j is.
+//
+constexpr
+ECC_GF28_Affine::Matrices::Matrices()
+  : matrix()
+{
+  for (size_t c = 0; c < 256; c++) {
+    uint8_t column = (uint8_t) c;
+
+    for (size_t j = 0; j < 8; j++) {
+      for (size_t i = 0; i < 8; i++)
+        if (column & (1 << i))
+          matrix[c] |= (uint64_t) 1 << (8 * (7 - i) + j);
+      column = ECC_GF28_times_alpha(column);
+    }
+  }
+}
+
+const ECC_GF28_Affine::Matrices ECC_GF28_Affine::kMatrices;
+
+#if defined(RDAT_ECC_GF28_X86)
+__attribute__((target("gfni")))
+uint8_t
+ECC_GF28_Affine::Multiply(uint8_t a, uint8_t b)
+{
+  const __m128i x = _mm_cvtsi32_si128(a);
+  const __m128i m = _mm_set1_epi64x((long long) kMatrices.matrix[b]);
+
+  return (uint8_t) _mm_cvtsi128_si32(_mm_gf2p8affine_epi64_epi8(x, m, 0));
+}
+
+__attribute__((target("gfni")))
+void
+ECC_GF28_Affine::Scale(const uint8_t *in, uint8_t s, uint8_t *out,
+  size_t n)
+{
+  const __m128i m = _mm_set1_epi64x((long long) kMatrices.matrix[s]);
+  size_t i;
+
+  for (i = 0; i + 16 <= n; i += 16) {
+    __m128i x = _mm_loadu_si128((const __m128i *) &in[i]);
+    _mm_storeu_si128((__m128i *) &out[i], _mm_gf2p8affine_epi64_epi8(x, m, 0));
+  }
+
+  if (i < n) {
+    uint8_t buf[16];
+    memcpy(buf, &in[i], n - i);
+    __m128i x = _mm_loadu_si128((const __m128i *) buf);
+    _mm_storeu_si128((__m128i *) buf, _mm_gf2p8affine_epi64_epi8(x, m, 0));
+    memcpy(&out[i], buf, n - i);
+  }
+}
+#else
+uint8_t
+ECC_GF28_Affine::Multiply(uint8_t a, uint8_t b)
+{
+  return ECC_GF28_LogExp::Multiply(a, b);
+}
+
+void
+ECC_GF28_Affine::Scale(const uint8_t *in, uint8_t s, uint8_t *out,
+  size_t n)
+{
+  ECC_GF28_LogExp::Scale(in, s, out, n);
+}
+#endif
+
+//
+// The benchmark: the decoder's two kinds of work, in about the
+// proportion it does them. Each step scales a locator-sized polynomial,
+// as the Euclidean algorithm does, and multiplies a few terms by
+// constants, as the Chien search does. Each step depends on the last so
+// that none of it can be skipped.
+//
+template <class GF>
+static uint8_t
+workload(const uint8_t *data, size_t steps)
+{
+  uint8_t poly[7] = { 1, 2, 3, 4, 5, 6, 7 };
+  uint8_t scaled[7];
+  uint8_t acc = 1;
+
+  for (size_t s = 0; s < steps; s++) {
+    const uint8_t *d = &data[(s * 7) & 0xff];
+
+    GF::Scale(poly, d[0] ^ acc, scaled, 7);
+    for (size_t k = 0; k < 7; k++)
+      poly[k] = scaled[k] ^ d[k + 1];
+    for (size_t k = 0; k < 4; k++)
+      acc ^= GF::Multiply(poly[k], d[k + 8]);
+  }
+
+  return acc;
+}
+
+static const size_t kBenchmarkSteps = 2000;
+static const size_t kBenchmarkRuns = 3;
+
+template <class GF>
+static double
+benchmark()
+{
+  uint8_t data[256 + 16];
+  uint32_t seed = 1;
+  volatile uint8_t sink = 0;
+  double best = 0;
+
+  for (size_t i = 0; i < sizeof(data); i++) {
+    seed = seed * 1103515245 + 12345;
+    data[i] = (uint8_t) (seed >> 16);
+  }
+
+  for (size_t run = 0; run < kBenchmarkRuns; run++) {
+    struct timespec start, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    sink = sink ^ workload<GF>(data, kBenchmarkSteps);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ns = (end.tv_sec - start.tv_sec) * 1e9 +
+                (end.tv_nsec - start.tv_nsec);
+    if (run == 0 || ns < best)
+      best = ns;
+  }
+
+  return best / kBenchmarkSteps;
+}
+
+static ECC_GF28_Arith::Implementation sSelected = ECC_GF28_Arith::Fastest();
+
+bool
+ECC_GF28_Arith::Available(Implementation implementation)
+{
+  switch (implementation) {
+  case LOG_EXP:
+  case PRODUCT_TABLE:
+    return true;
+#if defined(RDAT_ECC_GF28_X86)
+  case AFFINE:
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("gfni");
+#endif
+  default:
+    return false;
+  }
+}
+
+bool
+ECC_GF28_Arith::Select(Implementation implementation)
+{
+  if (!Available(implementation))
+    return false;
+
+  sSelected = implementation;
+
+  return true;
+}
+
+ECC_GF28_Arith::Implementation
+ECC_GF28_Arith::Selected()
+{
+  return sSelected;
+}
+
+const char *
+ECC_GF28_Arith::Name(Implementation implementation)
+{
+  switch (implementation) {
+  case LOG_EXP:       return "log/exp";
+  case PRODUCT_TABLE: return "product table";
+  case AFFINE:        return "gfni affine";
+  }
+
+  return "unknown";
+}
+
+double
+ECC_GF28_Arith::Benchmark(Implementation implementation)
+{
+  if (!Available(implementation))
+    return 0;
+
+  switch (implementation) {
+  case LOG_EXP:       return benchmark<ECC_GF28_LogExp>();
+  case PRODUCT_TABLE: return benchmark<ECC_GF28_ProductTable>();
+  case AFFINE:        return benchmark<ECC_GF28_Affine>();
+  }
+
+  return 0;
+}
+
+ECC_GF28_Arith::Implementation
+ECC_GF28_Arith::Fastest()
+{
+  Implementation fastest = LOG_EXP;
+  double best = 0;
+
+  for (size_t i = 0; i < kImplementations; i++) {
+    const Implementation implementation = (Implementation) i;
+    const double ns = Benchmark(implementation);
+
+    if (ns > 0 && (best == 0 || ns < best)) {
+      fastest = implementation;
+      best = ns;
+    }
+  }
+
+  return fastest;
+}
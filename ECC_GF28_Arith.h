@@ -0,0 +1,189 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_ECC_GF28_ARITH_H
+#define RDAT_ECC_GF28_ARITH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ECC_GF28.h"
+
+//
+// Interchangeable ways of doing the GF(2^8) arithmetic that the
+// Reed-Solomon decoder spends its time in. Each is a class of static,
+// branch-free functions:
+//
+//   Multiply(a, b)           - a * b
+//   Scale(in, s, out, n)     - out[i] = s * in[i], for i < n; 'in' and
+//                              'out' may be the same
+//   Invert(a)                - 1 / a (zero for zero)
+//   PowAlpha(n)              - alpha^n, for n < 255
+//   LogAlpha(a)              - the n for which alpha^n = a (not zero)
+//
+// The decoder is a template over these classes and is instantiated for
+// each one, so the choice between them is made once per codeword rather
+// than once per multiplication. ECC_GF28_Arith chooses.
+//
+
+//
+// Functions that are plain lookups whichever way multiplication is done.
+//
+class ECC_GF28_Lookups {
+public:
+  static uint8_t Invert(uint8_t a) { return kTables.inverse[a]; }
+  static uint8_t PowAlpha(uint8_t n) { return kTables.exp[n]; }
+  static uint8_t LogAlpha(uint8_t a) { return (uint8_t) kTables.log[a]; }
+
+  //
+  // The logarithm of zero is given as kLogZero, so large that any sum of
+  // two logarithms that includes it lands in the zero part of the
+  // exponent table, which runs that far beyond the 509 entries nonzero
+  // products need. That way neither a zero test nor a "% 255" is needed.
+  //
+  static const uint16_t kLogZero = 511;
+
+  struct Tables {
+    uint16_t log[256];
+    uint8_t  exp[2 * kLogZero + 2];
+    uint8_t  inverse[256];
+
+    constexpr Tables();
+  };
+
+  static_assert(2 * kLogZero < sizeof(Tables::exp),
+    "the product of two zeros must land inside the exponent table");
+
+protected:
+  static const Tables kTables;
+};
+
+//
+// Multiplication by adding logarithms.
+//
+class ECC_GF28_LogExp : public ECC_GF28_Lookups {
+public:
+  static uint8_t Multiply(uint8_t a, uint8_t b) {
+    return kTables.exp[kTables.log[a] + kTables.log[b]];
+  }
+
+  static void Scale(const uint8_t *in, uint8_t s, uint8_t *out, size_t n) {
+    const uint16_t log = kTables.log[s];
+
+    for (size_t i = 0; i < n; i++)
+      out[i] = kTables.exp[kTables.log[in[i]] + log];
+  }
+};
+
+//
+// Multiplication by looking up the full 64 KB table of products.
+//
+class ECC_GF28_ProductTable : public ECC_GF28_Lookups {
+public:
+  static uint8_t Multiply(uint8_t a, uint8_t b) {
+    return kProducts.product[a][b];
+  }
+
+  static void Scale(const uint8_t *in, uint8_t s, uint8_t *out, size_t n) {
+    const uint8_t *row = kProducts.product[s];
+
+    for (size_t i = 0; i < n; i++)
+      out[i] = row[in[i]];
+  }
+
+  struct Products {
+    uint8_t product[256][256];
+
+    constexpr Products();
+  };
+
+protected:
+  static const Products kProducts;
+};
+
+//
+// Multiplication with the x86 GFNI affine transform instruction. Its own
+// multiply instruction is fixed to the AES field (reduction polynomial
+// 0x11b), not this one (0x11d), but multiplying by a constant is linear
+// over GF(2) whatever the field, so it is an 8x8 bit matrix that the
+// affine instruction can apply to up to sixteen bytes at once. The
+// functions are compiled for GFNI on their own and so are not inline;
+// only call them if ECC_GF28_Arith says the processor has it.
+//
+class ECC_GF28_Affine : public ECC_GF28_Lookups {
+public:
+  static uint8_t Multiply(uint8_t a, uint8_t b);
+  static void Scale(const uint8_t *in, uint8_t s, uint8_t *out, size_t n);
+
+  //
+  // The matrix for multiplication by each constant.
+  //
+  struct Matrices {
+    uint64_t matrix[256];
+
+    constexpr Matrices();
+  };
+
+protected:
+  static const Matrices kMatrices;
+};
+
+//
+// Chooses the arithmetic the decoder uses.
+//
+class ECC_GF28_Arith {
+public:
+  typedef enum {
+    LOG_EXP,
+    PRODUCT_TABLE,
+    AFFINE
+  } Implementation;
+
+  static const size_t kImplementations = AFFINE + 1;
+
+  //
+  // Select a particular implementation, if the processor supports it.
+  // (The fastest one is selected to begin with.)
+  //
+  static bool Select(Implementation implementation);
+  static Implementation Selected();
+  static const char *Name(Implementation implementation);
+  static bool Available(Implementation implementation);
+
+  //
+  // Time a mix of the operations the decoder does, as it does them, and
+  // return the nanoseconds per operation (the best of a few short runs);
+  // or zero if the implementation isn't available. Fastest() does this
+  // for each one and returns the winner. It takes well under a
+  // millisecond.
+  //
+  static double Benchmark(Implementation implementation);
+  static Implementation Fastest();
+};
+
+#endif
@@ -0,0 +1,297 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include "ECC_Syndrome.h"
+#include "ECC_GF28.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define RDAT_ECC_SYNDROME_X86
+#include <immintrin.h>
+#endif
+
+//
+// The tables for matrix element (i, j).
+//
+static inline const uint8_t *
+element(const uint8_t *tables, size_t n, size_t i, size_t j)
+{
+  return &tables[(i * n + j) * 32];
+}
+
+//
+// The scalar kernel: the same split tables, a byte at a time.
+//
+static void
+scalar_kernel(const uint8_t *tables, size_t twoT, size_t n,
+  const uint8_t *words, uint8_t *syndromes, size_t count, size_t stride)
+{
+  uint8_t s[ECC_Syndrome::kMaxTwoT];
+  size_t i, j, k;
+
+  for (k = 0; k < count; k++) {
+    for (i = 0; i < twoT; i++)
+      s[i] = 0;
+    for (j = 0; j < n; j++) {
+      uint8_t x = words[j * stride + k];
+      for (i = 0; i < twoT; i++) {
+        const uint8_t *t = element(tables, n, i, j);
+        s[i] ^= t[x & 0xf] ^ t[16 + (x >> 4)];
+      }
+    }
+    for (i = 0; i < twoT; i++)
+      syndromes[i * stride + k] = s[i];
+  }
+}
+
+#if defined(RDAT_ECC_SYNDROME_X86)
+//
+// Sixteen codewords at a time with SSSE3. 'TwoT' is fixed so that the
+// accumulators all live in registers.
+//
+template <size_t TwoT>
+__attribute__((target("ssse3")))
+static void
+ssse3_kernel(const uint8_t *tables, size_t twoT, size_t n,
+  const uint8_t *words, uint8_t *syndromes, size_t count, size_t stride)
+{
+  const __m128i nibble = _mm_set1_epi8(0x0f);
+  __m128i acc[TwoT];
+  size_t i, j, k;
+
+  for (k = 0; count - k >= 16; k += 16) {
+    for (i = 0; i < TwoT; i++)
+      acc[i] = _mm_setzero_si128();
+    for (j = 0; j < n; j++) {
+      __m128i x = _mm_loadu_si128((const __m128i *) &words[j * stride + k]);
+      __m128i lo = _mm_and_si128(x, nibble);
+      __m128i hi = _mm_and_si128(_mm_srli_epi16(x, 4), nibble);
+      for (i = 0; i < TwoT; i++) {
+        const uint8_t *t = element(tables, n, i, j);
+        __m128i tlo = _mm_loadu_si128((const __m128i *) t);
+        __m128i thi = _mm_loadu_si128((const __m128i *) &t[16]);
+        acc[i] = _mm_xor_si128(acc[i], _mm_xor_si128(
+          _mm_shuffle_epi8(tlo, lo), _mm_shuffle_epi8(thi, hi)));
+      }
+    }
+    for (i = 0; i < TwoT; i++)
+      _mm_storeu_si128((__m128i *) &syndromes[i * stride + k], acc[i]);
+  }
+
+  scalar_kernel(tables, twoT, n, &words[k], &syndromes[k], count - k,
+    stride);
+}
+
+//
+// Thirty-two codewords at a time with AVX2. The byte shuffle works within
+// each 128-bit half, so each table is loaded into both halves.
+//
+template <size_t TwoT>
+__attribute__((target("avx2")))
+static void
+avx2_kernel(const uint8_t *tables, size_t twoT, size_t n,
+  const uint8_t *words, uint8_t *syndromes, size_t count, size_t stride)
+{
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  __m256i acc[TwoT];
+  size_t i, j, k;
+
+  for (k = 0; count - k >= 32; k += 32) {
+    for (i = 0; i < TwoT; i++)
+      acc[i] = _mm256_setzero_si256();
+    for (j = 0; j < n; j++) {
+      __m256i x = _mm256_loadu_si256(
+        (const __m256i *) &words[j * stride + k]);
+      __m256i lo = _mm256_and_si256(x, nibble);
+      __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), nibble);
+      for (i = 0; i < TwoT; i++) {
+        const uint8_t *t = element(tables, n, i, j);
+        __m256i tlo = _mm256_broadcastsi128_si256(
+          _mm_loadu_si128((const __m128i *) t));
+        __m256i thi = _mm256_broadcastsi128_si256(
+          _mm_loadu_si128((const __m128i *) &t[16]));
+        acc[i] = _mm256_xor_si256(acc[i], _mm256_xor_si256(
+          _mm256_shuffle_epi8(tlo, lo), _mm256_shuffle_epi8(thi, hi)));
+      }
+    }
+    for (i = 0; i < TwoT; i++)
+      _mm256_storeu_si256((__m256i *) &syndromes[i * stride + k], acc[i]);
+  }
+
+  ssse3_kernel<TwoT>(tables, twoT, n, &words[k], &syndromes[k], count - k,
+    stride);
+}
+#endif
+
+static ECC_Syndrome::Implementation best_implementation();
+
+static ECC_Syndrome::Implementation sSelected = best_implementation();
+
+//
+// The fastest implementation this processor can run.
+//
+static ECC_Syndrome::Implementation
+best_implementation()
+{
+#if defined(RDAT_ECC_SYNDROME_X86)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2"))
+    return ECC_Syndrome::AVX2;
+  if (__builtin_cpu_supports("ssse3"))
+    return ECC_Syndrome::SSSE3;
+#endif
+  return ECC_Syndrome::SCALAR;
+}
+
+//
+// The kernel for the selected implementation and the number of
+// syndromes. The vector kernels come in the sizes the DAT and DDS codes
+// use.
+//
+static ECC_Syndrome::Kernel
+select_kernel(size_t twoT)
+{
+#if defined(RDAT_ECC_SYNDROME_X86)
+  switch (sSelected) {
+  case ECC_Syndrome::AVX2:
+    switch (twoT) {
+    case 2: return avx2_kernel<2>;
+    case 4: return avx2_kernel<4>;
+    case 6: return avx2_kernel<6>;
+    }
+    break;
+  case ECC_Syndrome::SSSE3:
+    switch (twoT) {
+    case 2: return ssse3_kernel<2>;
+    case 4: return ssse3_kernel<4>;
+    case 6: return ssse3_kernel<6>;
+    }
+    break;
+  default:
+    break;
+  }
+#endif
+  return scalar_kernel;
+}
+
+ECC_Syndrome::ECC_Syndrome(const uint8_t *matrix, size_t twoT, size_t n)
+  : mTables(new uint8_t[twoT * n * 32]),
+    mTwoT(twoT), mN(n)
+{
+  size_t i, j, x;
+
+  //
+  // Computing fewer syndromes than asked for would leave the rest of
+  // the caller's syndrome unset, to be taken as real.
+  //
+  if (mTwoT > kMaxTwoT)
+    abort();
+
+  for (i = 0; i < mTwoT; i++) {
+    for (j = 0; j < mN; j++) {
+      uint8_t c = matrix[i * n + j];
+      uint8_t *t = &mTables[(i * mN + j) * 32];
+      for (x = 0; x < 16; x++) {
+        t[x] = ECC_GF28_multiply(c, x);
+        t[16 + x] = ECC_GF28_multiply(c, x << 4);
+      }
+    }
+  }
+}
+
+ECC_Syndrome::~ECC_Syndrome()
+{
+  delete [] mTables;
+}
+
+void
+ECC_Syndrome::Compute(const uint8_t *words, uint8_t *syndromes,
+  size_t count, size_t stride) const
+{
+  select_kernel(mTwoT)(mTables, mTwoT, mN, words, syndromes, count, stride);
+}
+
+bool
+ECC_Syndrome::Compute(const uint8_t *word, uint8_t *syndrome) const
+{
+  size_t i;
+  bool zero;
+
+  scalar_kernel(mTables, mTwoT, mN, word, syndrome, 1, 1);
+
+  zero = true;
+  for (i = 0; i < mTwoT; i++)
+    zero = zero && syndrome[i] == 0;
+
+  return zero;
+}
+
+bool
+ECC_Syndrome::Select(Implementation implementation)
+{
+  switch (implementation) {
+  case SCALAR:
+    break;
+#if defined(RDAT_ECC_SYNDROME_X86)
+  case SSSE3:
+    if (!__builtin_cpu_supports("ssse3"))
+      return false;
+    break;
+  case AVX2:
+    if (!__builtin_cpu_supports("avx2"))
+      return false;
+    break;
+#endif
+  default:
+    return false;
+  }
+
+  sSelected = implementation;
+
+  return true;
+}
+
+ECC_Syndrome::Implementation
+ECC_Syndrome::Selected()
+{
+  return sSelected;
+}
+
+const char *
+ECC_Syndrome::Name(Implementation implementation)
+{
+  switch (implementation) {
+  case SCALAR: return "scalar";
+  case SSSE3:  return "ssse3";
+  case AVX2:   return "avx2";
+  }
+
+  return "unknown";
+}
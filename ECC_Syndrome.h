@@ -0,0 +1,193 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_ECC_SYNDROME_H
+#define RDAT_ECC_SYNDROME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// Computes Reed-Solomon syndromes -- the product of a check matrix and
+// a codeword -- for many codewords at once.
+//
+// Each product term multiplies a data byte by a constant matrix element.
+// Multiplication by a constant c is linear over GF(2), so it splits into
+// two sixteen-entry tables, one for each nibble of the data byte:
+//
+//   c * x = low[x & 0xf] ^ high[x >> 4]
+//
+// Sixteen-entry tables are exactly what a byte shuffle (PSHUFB) looks
+// up, sixteen or thirty-two bytes at a time. So that one matrix element
+// applies to every lane, the codewords are laid out transposed: byte j
+// of codeword k is at words[j * stride + k] and syndrome i of codeword k
+// goes to syndromes[i * stride + k].
+//
+// The vector kernels are chosen at run time to suit the processor, with
+// a scalar version of the same tables behind them.
+//
+class ECC_Syndrome {
+public:
+  //
+  // Prepare for the 'twoT' by 'n' check matrix, given row by row.
+  //
+  ECC_Syndrome(const uint8_t *matrix, size_t twoT, size_t n);
+  ~ECC_Syndrome();
+
+  //
+  // Compute the syndromes of 'count' transposed codewords.
+  //
+  void Compute(const uint8_t *words, uint8_t *syndromes, size_t count,
+    size_t stride) const;
+
+  //
+  // Compute the syndrome of one codeword, stored in order. Returns true
+  // if every element is zero.
+  //
+  bool Compute(const uint8_t *word, uint8_t *syndrome) const;
+
+  typedef enum {
+    SCALAR,
+    SSSE3,
+    AVX2
+  } Implementation;
+
+  //
+  // Select a particular implementation, if the processor supports it.
+  // (The best one is selected to begin with.)
+  //
+  static bool Select(Implementation implementation);
+  static Implementation Selected();
+  static const char *Name(Implementation implementation);
+
+  typedef void (*Kernel)(const uint8_t *tables, size_t twoT, size_t n,
+    const uint8_t *words, uint8_t *syndromes, size_t count, size_t stride);
+
+  //
+  // The largest number of syndromes the kernels handle. Check matrices
+  // with more rows are refused.
+  //
+  static const size_t kMaxTwoT = 16;
+
+protected:
+  //
+  // The split multiplication tables: for each matrix element, row by
+  // row, sixteen low-nibble products followed by sixteen high-nibble
+  // products.
+  //
+  uint8_t *mTables;
+  const size_t mTwoT;
+  const size_t mN;
+};
+
+//
+// Screens a whole set of codewords for errors, up front, so that the
+// codewords which are already good can be passed over.
+//
+// 'Code' is one of the ECC_Cx classes, 'kWords' the most codewords the
+// screen holds; codewords beyond that are never passed over.
+//
+template <class Code, size_t kWords>
+class ECC_Screen {
+public:
+  ECC_Screen() : mCount(0) {}
+
+  //
+  // Gather every codeword from a fresh fill iterator and compute the
+  // syndromes together.
+  //
+  template <class Fill>
+  void Screen(Fill fill);
+
+  //
+  // Does the k'th codeword need to go through correction? It doesn't if
+  // it has no erasures and a zero syndrome.
+  //
+  bool NeedsCorrection(size_t k) const;
+
+  //
+  // The erasures in the k'th codeword, as a mask with bit 'j' set if byte
+  // 'j' is erased; and whether there are any at all.
+  //
+  uint64_t Erasures(size_t k) const { return mErasures[k]; }
+  bool Erased(size_t k) const { return k < mCount && mErasures[k] != 0; }
+
+  //
+  // Byte 'j' of the k'th codeword, as gathered, and element 'i' of its
+  // syndrome.
+  //
+  uint8_t Byte(size_t j, size_t k) const { return mWords[j][k]; }
+  uint8_t Syndrome(size_t i, size_t k) const { return mSyndromes[i][k]; }
+
+protected:
+  static_assert(Code::kN <= 64, "codeword erasures must fit in a word");
+
+  uint8_t  mWords[Code::kN][kWords];
+  uint8_t  mSyndromes[Code::kTwoT][kWords];
+  uint64_t mErasures[kWords];
+  size_t   mCount;
+};
+
+template <class Code, size_t kWords>
+template <class Fill>
+inline void
+ECC_Screen<Code, kWords>::Screen(Fill fill)
+{
+  size_t j, k;
+
+  for (k = 0; k < kWords && !fill.End(); k++, fill.Next()) {
+    mErasures[k] = 0;
+    for (j = 0; j < Code::kN; j++) {
+      mWords[j][k] = fill.Data(j);
+      mErasures[k] |= (uint64_t) !fill.Valid(j) << j;
+    }
+  }
+  mCount = k;
+
+  Code::Syndromes().Compute(&mWords[0][0], &mSyndromes[0][0], mCount,
+    kWords);
+}
+
+template <class Code, size_t kWords>
+inline bool
+ECC_Screen<Code, kWords>::NeedsCorrection(size_t k) const
+{
+  size_t i;
+
+  if (k >= mCount || mErasures[k] != 0)
+    return true;
+
+  for (i = 0; i < Code::kTwoT; i++)
+    if (mSyndromes[i][k] != 0)
+      return true;
+
+  return false;
+}
+
+#endif
@@ -0,0 +1,299 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_ECC_VECTOR_H
+#define RDAT_ECC_VECTOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ECCFill.h"
+#include "BitMask.h"
+#include "ECC_Syndrome.h"
+
+//
+// What a correction vector does with the erasure indications that come
+// in with its bytes.
+//
+// ECC_IGNORE_ERASURES - Count the erasures, but don't tell the decoder
+//      where they are. Every erasure position handed to the decoder costs
+//      it error detection ability, and the first level of correction
+//      should above all be sure of what it passes on.
+//
+// ECC_USE_ERASURES - Decode with the erasure positions. The level before
+//      has already sorted bytes into good and bad, so the code can fill
+//      twice as many gaps, with no detection ability left over.
+//
+typedef enum {
+  ECC_IGNORE_ERASURES,
+  ECC_USE_ERASURES
+} ECC_ErasureMode;
+
+//
+// A vector of bytes to be checked and corrected by one of the DAT and
+// DDS error correcting codes. 'Codec' is a ReedSolomon code.
+//
+template <class Codec, ECC_ErasureMode Mode>
+class ECC_Vector {
+public:
+  ECC_Vector();
+
+  typedef Codec Code;
+
+  typedef enum {
+    NO_ERRORS = 0,
+    CORRECTED,
+    UNCORRECTABLE
+  } Status;
+
+  //
+  // The block size and number of parity bytes for this code,
+  // respectively.
+  //
+  static const unsigned int kN = Codec::kN;
+  static const unsigned int kTwoT = Codec::kTwoT;
+  static const unsigned int kT = kTwoT / 2;
+
+  //
+  // Fill this vector from the given filling source.
+  //
+  void Fill(ECCFill& filler);
+
+  //
+  // Fill this vector from the k'th codeword of a screen of this code,
+  // which has already gathered its bytes, found its erasures and worked
+  // out its syndrome.
+  //
+  template <class Screened, size_t kWords>
+  void Fill(const ECC_Screen<Screened, kWords>& screen, size_t k);
+
+  //
+  // Correct this vector, if possible. Returns the correction
+  // status.
+  //
+  Status Correct();
+
+  //
+  // The number of bytes the last Correct() changed.
+  //
+  size_t Corrections() const { return mCorrections; }
+
+  //
+  // Dump this corrected (or invalidated) vector back to its
+  // source.
+  //
+  void Dump(ECCFill& dumper);
+
+  //
+  // The syndrome calculator for this code.
+  //
+  static const ECC_Syndrome& Syndromes() { return Codec::Syndromes(); }
+
+protected:
+  static_assert(kN <= 64, "a vector's validity must fit in a word");
+
+  //
+  // The data in the vector.
+  //
+  uint8_t mData[kN];
+
+  //
+  // Known erasures in this vector.
+  //
+  BitMask<kN> mDataIsValid;
+
+  //
+  // Find the erasures in the validity, and list the positions of the
+  // first kTwoT of them as the powers the decoder wants.
+  //
+  void FindErasures();
+
+  //
+  // The number of erasures, and the powers of the first kTwoT of them.
+  //
+  size_t  mNumErasures;
+  uint8_t mErasures[kTwoT];
+
+  //
+  // The syndrome, if the vector came from a screen that had worked it out.
+  //
+  uint8_t mSyndrome[kTwoT];
+  bool    mHaveSyndrome;
+
+  //
+  // The number of bytes the last correction changed.
+  //
+  size_t mCorrections;
+};
+
+template <class Codec, ECC_ErasureMode Mode>
+inline
+ECC_Vector<Codec, Mode>::ECC_Vector()
+  : mNumErasures(0), mHaveSyndrome(false), mCorrections(0)
+{
+}
+
+template <class Codec, ECC_ErasureMode Mode>
+inline void
+ECC_Vector<Codec, Mode>::Fill(ECCFill& filler)
+{
+  uint64_t valid = 0;
+
+  for (size_t i = 0; i < kN; i++) {
+    mData[i] = filler.Data(i);
+    valid |= (uint64_t) filler.Valid(i) << i;
+  }
+  mDataIsValid.Put(0, kN, valid);
+  mHaveSyndrome = false;
+
+  FindErasures();
+}
+
+template <class Codec, ECC_ErasureMode Mode>
+template <class Screened, size_t kWords>
+inline void
+ECC_Vector<Codec, Mode>::Fill(const ECC_Screen<Screened, kWords>& screen,
+  size_t k)
+{
+  static_assert(Screened::kN == kN && Screened::kTwoT == kTwoT,
+    "the screen must be of the same code");
+
+  for (size_t i = 0; i < kN; i++)
+    mData[i] = screen.Byte(i, k);
+  mDataIsValid.Put(0, kN, ~screen.Erasures(k));
+
+  for (size_t i = 0; i < kTwoT; i++)
+    mSyndrome[i] = screen.Syndrome(i, k);
+  mHaveSyndrome = true;
+
+  FindErasures();
+}
+
+template <class Codec, ECC_ErasureMode Mode>
+inline void
+ECC_Vector<Codec, Mode>::FindErasures()
+{
+  uint64_t clear = ~mDataIsValid.Get(0, kN);
+  size_t n = 0;
+
+  if (kN < 64)
+    clear &= ((uint64_t) 1 << kN) - 1;
+  mNumErasures = __builtin_popcountll(clear);
+
+  for (; clear != 0 && n < kTwoT; clear &= clear - 1)
+    mErasures[n++] = Codec::Power(__builtin_ctzll(clear));
+}
+
+template <class Codec, ECC_ErasureMode Mode>
+inline void
+ECC_Vector<Codec, Mode>::Dump(ECCFill& filler)
+{
+  const uint64_t valid = mDataIsValid.Get(0, kN);
+
+  for (size_t i = 0; i < kN; i++) {
+    filler.Data(i) = mData[i];
+    filler.SetValid(i, (valid >> i) & 1);
+  }
+}
+
+template <class Codec, ECC_ErasureMode Mode>
+typename ECC_Vector<Codec, Mode>::Status
+ECC_Vector<Codec, Mode>::Correct()
+{
+  uint8_t syndrome[kTwoT];
+  size_t  corrections = 0;
+  bool    ok = true;
+  bool    corrected = false;
+  bool    zero = true;
+
+  if (mHaveSyndrome) {
+    //
+    // The screen has already multiplied the vector by the check matrix.
+    // A clean codeword is done with before anything else is looked at.
+    //
+    mHaveSyndrome = false;
+    for (size_t i = 0; i < kTwoT; i++) {
+      syndrome[i] = mSyndrome[i];
+      zero = zero && syndrome[i] == 0;
+    }
+    if (zero && mNumErasures == 0) {
+      mCorrections = 0;
+      return NO_ERRORS;
+    }
+  } else if (mNumErasures <= kTwoT) {
+    //
+    // Multiply the vector by the check matrix; everything is ok if the
+    // syndrome is all zero.
+    //
+    zero = Codec::Syndromes().Compute(mData, syndrome);
+  }
+
+  if (mNumErasures > kTwoT) {
+    //
+    // Too many erasures. This vector will not be correctable.
+    //
+    ok = false;
+  } else if (!zero) {
+    //
+    // The known erasures (if any) are under control, but there's a
+    // non-zero syndrome. Attempt to correct the errors.
+    //
+    ok = Codec::Correct(mData, syndrome, mErasures,
+      Mode == ECC_USE_ERASURES ? mNumErasures : 0, corrections);
+    corrected = ok;
+  }
+
+  mCorrections = corrections;
+
+  if (ok) {
+    if (mNumErasures || corrected) {
+      //
+      // The data entered with some erasures or errors. It has now been
+      // fully validated, so mark every byte as good -- unless, without
+      // the help of erasure positions, the correction used up every
+      // parity byte and left nothing to vouch for it.
+      //
+      mDataIsValid.Fill(Mode == ECC_USE_ERASURES || corrections < kTwoT);
+
+      return CORRECTED;
+    }
+    //
+    // Everything came in good. No modifications necessary.
+    //
+    return NO_ERRORS;
+  }
+
+  //
+  // There are uncorrectable errors. Mark the whole vector as invalid.
+  //
+  mDataIsValid.Fill(false);
+
+  return UNCORRECTABLE;
+}
+
+#endif
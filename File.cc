@@ -27,16 +27,29 @@
 // POSSIBILITY OF SUCH DAMAGE.
 //
 
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
 #include <unistd.h>
 #include <fcntl.h>
 #include <string.h>
 #include "File.h"
 
+//
+// How far ahead of the consumer to ask the system to pull in pages of a
+// mapped file, and how much consumed data to let pile up behind it
+// before handing the pages back. Both are issued in large steps so that
+// the cost of the madvise() calls themselves stays negligible.
+//
+static const size_t kReadAhead = 64 * 1024 * 1024;
+static const size_t kReleaseStep = 16 * 1024 * 1024;
+
 //
 // A simple AT&T streams-like file interface that is reliably cancelable.
 //
 
-File::File() : mOpen(false), mResidual(NULL), mQuanta(0)
+File::File() : mOpen(false), mResidual(NULL), mQuanta(0),
+  mFetchBuffer(NULL), mFetchBufferSize(0), mMapped(false), mMapBase(NULL)
 {
 }
 
@@ -45,6 +58,7 @@ File::~File()
   if (mOpen)
     Close();
   delete mResidual;
+  delete [] mFetchBuffer;
 }
 
 bool
@@ -82,6 +96,7 @@ File::Close()
   if (!mOpen)
     return;
 
+  Unmap();
   ::close(mFd);
   
   mOpen = false;
@@ -144,3 +159,125 @@ File::Read(void *buf, size_t count)
 
   return pos / mQuanta;
 }
+
+bool
+File::Map()
+{
+  struct stat sb;
+  void *base;
+
+  if (!mOpen || mMapped)
+    return mMapped;
+
+  //
+  // Only regular files can be mapped and only whole quanta are of any
+  // use to the reader.
+  //
+  if (fstat(mFd, &sb) != 0 || !S_ISREG(sb.st_mode) || sb.st_size <= 0)
+    return false;
+
+  if ((unsigned long long) sb.st_size > (size_t) -1)
+    return false;
+
+  size_t length = (size_t) sb.st_size;
+
+  base = ::mmap(NULL, length, PROT_READ, MAP_SHARED, mFd, 0);
+  if (base == MAP_FAILED)
+    return false;
+
+  mMapBase = (char *) base;
+  mMapLength = length;
+  mMapPos = 0;
+  mMapAdvised = 0;
+  mMapReleased = 0;
+  mMapped = true;
+
+  //
+  // The decoder walks the capture strictly front to back.
+  //
+  ::madvise(mMapBase, mMapLength, MADV_SEQUENTIAL);
+  Advise(0);
+
+  return true;
+}
+
+void
+File::Unmap()
+{
+  if (!mMapped)
+    return;
+
+  ::munmap(mMapBase, mMapLength);
+  mMapBase = NULL;
+  mMapped = false;
+}
+
+//
+// Keep the readahead window in front of the read position and return
+// the pages that the consumer is finished with. Everything before 'pos'
+// has been handed out and released by the caller.
+//
+void
+File::Advise(size_t pos)
+{
+  size_t page = (size_t) sysconf(_SC_PAGESIZE);
+
+  if (pos + kReadAhead / 2 > mMapAdvised && mMapAdvised < mMapLength) {
+    size_t end = pos + kReadAhead;
+    if (end > mMapLength)
+      end = mMapLength;
+    ::madvise(mMapBase + mMapAdvised, end - mMapAdvised, MADV_WILLNEED);
+    mMapAdvised = end;
+  }
+
+  size_t done = pos - pos % page;
+  if (done >= mMapReleased + kReleaseStep) {
+    ::madvise(mMapBase + mMapReleased, done - mMapReleased, MADV_DONTNEED);
+    mMapReleased = done;
+  }
+}
+
+size_t
+File::Fetch(const void *& span, size_t count)
+{
+  if (!mOpen || count == 0)
+    return 0;
+
+  if (!mMapped) {
+    //
+    // Not mapped. Read into a private buffer instead.
+    //
+    size_t need = count * mQuanta;
+    if (need > mFetchBufferSize) {
+      delete [] mFetchBuffer;
+      mFetchBuffer = new char[need];
+      mFetchBufferSize = need;
+    }
+    span = mFetchBuffer;
+    return Read(mFetchBuffer, count);
+  }
+
+  //
+  // The previous span is no longer in use by the caller.
+  //
+  Advise(mMapPos);
+
+  size_t avail = (mMapLength - mMapPos) / mQuanta;
+  if (count > avail)
+    count = avail;
+
+  span = mMapBase + mMapPos;
+  mMapPos += count * mQuanta;
+
+  return count;
+}
+
+size_t
+File::Mapping(const void *& base) const
+{
+  if (!mMapped)
+    return 0;
+
+  base = mMapBase;
+  return mMapLength / mQuanta;
+}
@@ -45,14 +45,57 @@ public:
   size_t Read(void *buf, size_t count);
   void Close();
 
+  //
+  // Attempt to map the open file into memory. Once mapped, Fetch()
+  // hands out spans that point directly into the mapping. Fails on
+  // pipes, terminals and anything else that can't be mapped, in which
+  // case Fetch() quietly falls back to Read().
+  //
+  bool Map();
+  bool IsMapped() const { return mMapped; }
+
+  //
+  // Obtain a pointer to the next span of up to 'count' quanta. The
+  // span remains valid only until the next call to Fetch() or Close().
+  // Returns the number of quanta in the span; zero at end of input.
+  //
+  size_t Fetch(const void *& span, size_t count);
+
+  //
+  // Get the whole mapping at once, for readers that don't take the
+  // input strictly front to back. Returns the number of whole quanta
+  // in it; zero if the file isn't mapped.
+  //
+  size_t Mapping(const void *& base) const;
+
 protected:
   void Reset(size_t quanta);
+  void Unmap();
+  void Advise(size_t pos);
 
   bool mOpen;
   int mFd;
   char *mResidual;
   size_t mQuanta;
   size_t mResidualCount;
+
+  //
+  // Buffer used by Fetch() when the file isn't mapped.
+  //
+  char *mFetchBuffer;
+  size_t mFetchBufferSize;
+
+  //
+  // Memory-mapped input state. Offsets are in bytes from the start of
+  // the mapping. Pages below mMapReleased have been handed back to the
+  // system; pages below mMapAdvised have been scheduled for readahead.
+  //
+  bool mMapped;
+  char *mMapBase;
+  size_t mMapLength;
+  size_t mMapPos;
+  size_t mMapAdvised;
+  size_t mMapReleased;
 };
 
 #endif
@@ -0,0 +1,100 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <math.h>
+#include "GapScanner.h"
+
+//
+// A block is quiet if it is at least this many times quieter than the
+// loudest block seen.
+//
+static const float kQuietRatio = 8.0;
+
+GapScanner::GapScanner(const SampleConverter& converter)
+  : mConverter(converter)
+{
+}
+
+size_t
+GapScanner::FindSplit(const void *samples, size_t count, size_t from) const
+{
+  const char *raw = (const char *) samples;
+  size_t frameSize = mConverter.FrameSize();
+  size_t pos, quiet;
+  float level, peak;
+
+  peak = 0.0;
+  quiet = 0;
+
+  for (pos = from; pos < count && count - pos >= kBlockSize;
+       pos += kBlockSize) {
+    level = BlockLevel(&raw[pos * frameSize]);
+    if (level > peak)
+      peak = level;
+
+    if (level * kQuietRatio < peak) {
+      quiet++;
+      continue;
+    }
+
+    //
+    // Something is on the tape here. If it ends a long enough quiet
+    // stretch, that was a gap.
+    //
+    if (quiet >= kMinGapBlocks)
+      return pos - kSettleBlocks * kBlockSize;
+    quiet = 0;
+  }
+
+  return count;
+}
+
+//
+// The average magnitude of the samples in one block.
+//
+float
+GapScanner::BlockLevel(const char *block) const
+{
+  float converted[kBlockSize];
+  const float *samples;
+  float sum;
+  size_t i;
+
+  samples = (const float *) block;
+  if (!mConverter.IsNative()) {
+    mConverter.Convert(block, converted, kBlockSize);
+    samples = converted;
+  }
+
+  sum = 0.0;
+  for (i = 0; i < kBlockSize; i++)
+    sum += fabsf(samples[i]);
+
+  return sum / kBlockSize;
+}
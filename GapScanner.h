@@ -0,0 +1,81 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_GAP_SCANNER_H
+#define RDAT_GAP_SCANNER_H
+
+#include <stddef.h>
+#include "SampleConverter.h"
+
+//
+// Finds the quiet gaps between head swipes in a capture, where it can
+// safely be cut into pieces that decode independently.
+//
+// The scan looks only at the average signal level of fixed-size blocks
+// of samples, which is far cheaper than decoding them. A block is quiet
+// when its level is well below that of the loudest block seen so far in
+// the scan; a gap is a long enough run of quiet blocks.
+//
+class GapScanner
+{
+public:
+  GapScanner(const SampleConverter& converter);
+
+  //
+  // Find a split point in the 'count' frames of capture at 'samples',
+  // at or after frame 'from'. The split is placed shortly before the
+  // end of the first gap found, so that a decoder started there has
+  // some quiet to settle in before the next track. Returns 'count' if
+  // there is no gap.
+  //
+  size_t FindSplit(const void *samples, size_t count, size_t from) const;
+
+  //
+  // The number of frames in each block whose level is measured.
+  //
+  static const size_t kBlockSize = 4096;
+
+  //
+  // The number of quiet blocks that make a gap.
+  //
+  static const size_t kMinGapBlocks = 16;
+
+  //
+  // The number of quiet blocks left between the split and the next
+  // track.
+  //
+  static const size_t kSettleBlocks = 4;
+
+protected:
+  float BlockLevel(const char *block) const;
+
+  const SampleConverter& mConverter;
+};
+
+#endif
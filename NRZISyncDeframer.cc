@@ -30,155 +30,52 @@
 #include "NRZISyncDeframer.h"
 
 NRZISyncDeframer::NRZISyncDeframer(DATWordReceiver *receiver)
-  : mReceiver(receiver), mTrackDetected(false)
+  : mDeframer(receiver)
 {
-  Reset();
 }
 
 NRZISyncDeframer::~NRZISyncDeframer()
 {
 }
 
-//
-// Reset the deframer. Dumps any accumulated bits and reverts to sync search
-// state.
-//
 void
 NRZISyncDeframer::Reset()
 {
-  mState = STATE_SYNC_SEARCH;
-  mFrame = 0;
-  mLastBit = false;
-  mPreambleCheck = 0;
-  mPreambleSymbolCount = 0;
-  mTrackDetected = false;
+  mDeframer.Reset();
 }
 
-//
-// Called by lower-level bit slicer. Notifies decoder that the carrier/clock
-// PLL state has changed.  When carrier is dropped, the deframer resets
-// itself.
-//
 void
 NRZISyncDeframer::ClockDetected(bool detected)
 {
-  if (!detected)
-    Reset();
+  mDeframer.ClockDetected(detected);
 }
 
-//
-// Called by lower-level bit slicer when it decodes a bit. This in turn may
-// cause a frame to be delivered to the downstream receiver.
-//
 void
-NRZISyncDeframer::ReceiveBit(bool bit_in)
+NRZISyncDeframer::ReceiveBit(bool bit)
 {
-  bool bit;
-  size_t bit_count;
-  
-  //
-  // NRZI decode the bit.
-  //
-  bit = bit_in != mLastBit;
-  mLastBit = bit_in;
-
-  //
-  // Accumulate a new bit into the large shift register.
-  //
-  mFrame  &= 0x1ff;
-  mFrame <<= 1;
-  mFrame  |= bit;
-
-  //
-  // If the caller is trying to detect a track start, do pre-amble
-  // detection.
-  //  
-  if (!mTrackDetected) {
-    //
-    // Check for pre-amble words every ten symbols.
-    //
-    if (++mPreambleCheck == 10) {
-      //
-      // If this is a pre-amble sequence (all ones) then increment the preamble
-      // count. Otherwise, reset it. (This is used in track start/stop
-      // detection)
-      //
-      mPreambleCheck = 0;
-      if (mFrame == 0x3ff)
-        mPreambleSymbolCount++;
-      else
-        mPreambleSymbolCount = 0;
-    }
-  }
-  
-  //
-  // Are we currently searching for frame sync and have we received
-  // a sync word?
-  //
-  if ((mFrame & 0x1ff) == 0x111) {
-    //
-    // We've found a sync pattern. Enter sync state.
-    //
-    mSyncBitCount = 0;
-    mState = STATE_SYNCED;
-
-    //
-    // Notify the upstream frame receiver of the sync word.
-    //
-    mReceiver->ReceiveWord(mFrame);
-  } else if (mState == STATE_SYNCED) {
-    //
-    // We're in a synchronized state. We should keep accepting bits into
-    // the accumulator until a full frame is built up. Has a frame been
-    // built up?
-    //
-    mSyncBitCount += 1;
-    if (mSyncBitCount == 10) {
-      //
-      // There's a full frame built up.
-      //
-      mSyncBitCount = 0;
-      
-      //
-      // Deliver it upstream.
-      //
-      mReceiver->ReceiveWord(mFrame);
-    }
-  }
+  mDeframer.ReceiveBit(bit);
 }
 
 void
-NRZISyncDeframer::TrackDetected(bool detected)
+NRZISyncDeframer::ReceiveBits(uint64_t bits, size_t count)
 {
-  //
-  // A track has begun or ended. Cache the state.
-  //
-  mTrackDetected = detected;
-  
-  //
-  // If a track has stopped, reset the preamble detection logic
-  // so that it is ready to detect a new track.
-  //
-  if (!detected) {
-    mPreambleSymbolCount = 0;
-    mPreambleCheck = 0;
-  }
-  
-  //
-  // Let the downstream word collector know that the track detection
-  // has changed.
-  //
-  mReceiver->TrackDetected(detected);
+  mDeframer.ReceiveBits(bits, count);
 }
 
 bool
 NRZISyncDeframer::PreambleDetected(void) const
 {
-  return mPreambleSymbolCount > 10;
+  return mDeframer.PreambleDetected();
+}
+
+void
+NRZISyncDeframer::TrackDetected(bool start)
+{
+  mDeframer.TrackDetected(start);
 }
 
 void
-NRZISyncDeframer::Stop(void)
+NRZISyncDeframer::Stop()
 {
-  mReceiver->Stop();
+  mDeframer.Stop();
 }
@@ -0,0 +1,328 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdio.h>
+#include <string.h>
+#include "ParallelDecoder.h"
+#include "GapScanner.h"
+#include "RDATDecoder.h"
+#include "NRZISyncDeframer.h"
+#include "DATWordReceiver.h"
+#include "DATTrackAssembler.h"
+#include "RationalResampler.h"
+#include "Track.h"
+#include "TrackPool.h"
+
+//
+// Frames handed to a segment's decoder at a time: large spans when the
+// samples can be used where they lie, cache-sized pieces when they must
+// first be converted or resampled.
+//
+enum { FRAMES_PER_SPAN = 1024 * 1024, FRAMES_PER_CONVERT = 4096 };
+
+//
+// How many segments, per thread, the workers may run ahead of the
+// stitching.
+//
+static const size_t kLookahead = 2;
+
+//
+// Holds on to the tracks of one segment until it is their turn to be
+// handed on.
+//
+class SegmentTracks : public DATTrackReceiver {
+public:
+  SegmentTracks() : mTracks(NULL), mCount(0), mSize(0) {}
+  ~SegmentTracks();
+
+  void ReceiveTrack(Track *track);
+  void Stop() {}
+
+  //
+  // Hand all of the tracks, in order, to 'receiver'.
+  //
+  void Deliver(DATTrackReceiver& receiver);
+
+protected:
+  Track **mTracks;
+  size_t mCount;
+  size_t mSize;
+};
+
+SegmentTracks::~SegmentTracks()
+{
+  size_t i;
+
+  for (i = 0; i < mCount; i++)
+    TrackPool::Shared().Put(mTracks[i]);
+  delete [] mTracks;
+}
+
+void
+SegmentTracks::ReceiveTrack(Track *track)
+{
+  if (mCount == mSize) {
+    size_t size = mSize == 0 ? 16 : mSize * 2;
+    Track **tracks = new Track*[size];
+    if (mCount > 0)
+      memcpy(tracks, mTracks, mCount * sizeof(Track *));
+    delete [] mTracks;
+    mTracks = tracks;
+    mSize = size;
+  }
+
+  mTracks[mCount++] = track;
+}
+
+void
+SegmentTracks::Deliver(DATTrackReceiver& receiver)
+{
+  size_t i;
+
+  for (i = 0; i < mCount; i++)
+    receiver.ReceiveTrack(mTracks[i]);
+  mCount = 0;
+}
+
+ParallelDecoder::ParallelDecoder(const SampleConverter& converter,
+  float decoderRate, unsigned int threads)
+  : mConverter(converter), mDecoderRate(decoderRate),
+    mThreads(threads == 0 ? 1 : threads), mInterpolation(0), mDecimation(0),
+    mSamples(NULL), mRunning(NULL), mSegments(NULL), mSegmentCount(0),
+    mNextSegment(0), mStitched(0)
+{
+  pthread_mutex_init(&mLock, NULL);
+  pthread_cond_init(&mCond, NULL);
+}
+
+ParallelDecoder::~ParallelDecoder()
+{
+  pthread_cond_destroy(&mCond);
+  pthread_mutex_destroy(&mLock);
+  delete [] mSegments;
+}
+
+void
+ParallelDecoder::SetResampling(unsigned int interpolation,
+  unsigned int decimation)
+{
+  mInterpolation = interpolation;
+  mDecimation = decimation;
+}
+
+void
+ParallelDecoder::Decode(const void *samples, size_t count,
+  DATTrackReceiver& receiver, const volatile bool *running)
+{
+  pthread_t *workers;
+  unsigned int i, started;
+  size_t s;
+
+  mSamples = (const char *) samples;
+  mRunning = running;
+  Split(count);
+
+  mNextSegment = 0;
+  mStitched = 0;
+
+  workers = new pthread_t[mThreads];
+  for (started = 0; started < mThreads; started++)
+    if (pthread_create(&workers[started], NULL, WorkerMain, this) != 0)
+      break;
+
+  if (started == 0) {
+    //
+    // No threads to be had. Do all the work right here.
+    //
+    fprintf(stderr, "Can't start decoding threads; using just one.\n");
+    for (s = 0; s < mSegmentCount; s++) {
+      if (*mRunning)
+        DecodeSegment(mSegments[s]);
+      if (mSegments[s].tracks != NULL) {
+        mSegments[s].tracks->Deliver(receiver);
+        delete mSegments[s].tracks;
+      }
+    }
+  }
+
+  //
+  // Stitch the segments back together, in order, as they finish.
+  //
+  for (s = 0; started > 0 && s < mSegmentCount; s++) {
+    pthread_mutex_lock(&mLock);
+    while (!mSegments[s].done)
+      pthread_cond_wait(&mCond, &mLock);
+    pthread_mutex_unlock(&mLock);
+
+    if (mSegments[s].tracks != NULL) {
+      mSegments[s].tracks->Deliver(receiver);
+      delete mSegments[s].tracks;
+    }
+
+    pthread_mutex_lock(&mLock);
+    mStitched = s + 1;
+    pthread_cond_broadcast(&mCond);
+    pthread_mutex_unlock(&mLock);
+  }
+
+  for (i = 0; i < started; i++)
+    pthread_join(workers[i], NULL);
+  delete [] workers;
+
+  receiver.Stop();
+}
+
+//
+// Cut the capture into segments of about kSegmentFrames each, at gaps.
+//
+void
+ParallelDecoder::Split(size_t count)
+{
+  GapScanner scanner(mConverter);
+  size_t start, end, size;
+
+  delete [] mSegments;
+  mSegments = NULL;
+  mSegmentCount = 0;
+  size = 0;
+
+  for (start = 0; start < count; start = end) {
+    if (count - start <= kSegmentFrames)
+      end = count;
+    else
+      end = scanner.FindSplit(mSamples, count, start + kSegmentFrames);
+
+    if (mSegmentCount == size) {
+      size = size == 0 ? 64 : size * 2;
+      Segment *segments = new Segment[size];
+      if (mSegmentCount > 0)
+        memcpy(segments, mSegments, mSegmentCount * sizeof(Segment));
+      delete [] mSegments;
+      mSegments = segments;
+    }
+
+    mSegments[mSegmentCount].start = start;
+    mSegments[mSegmentCount].end = end;
+    mSegments[mSegmentCount].tracks = NULL;
+    mSegments[mSegmentCount].done = false;
+    mSegmentCount++;
+  }
+}
+
+void *
+ParallelDecoder::WorkerMain(void *decoder)
+{
+  ((ParallelDecoder *) decoder)->Work();
+  return NULL;
+}
+
+//
+// Take up segments, in order, until there are none left.
+//
+void
+ParallelDecoder::Work()
+{
+  Segment *segment;
+
+  pthread_mutex_lock(&mLock);
+  for (;;) {
+    while (mNextSegment < mSegmentCount &&
+           mNextSegment >= mStitched + kLookahead * mThreads)
+      pthread_cond_wait(&mCond, &mLock);
+    if (mNextSegment == mSegmentCount)
+      break;
+
+    segment = &mSegments[mNextSegment++];
+    pthread_mutex_unlock(&mLock);
+
+    if (*mRunning)
+      DecodeSegment(*segment);
+
+    pthread_mutex_lock(&mLock);
+    segment->done = true;
+    pthread_cond_broadcast(&mCond);
+  }
+  pthread_mutex_unlock(&mLock);
+}
+
+//
+// Decode one segment with a fresh decoding chain of its own.
+//
+void
+ParallelDecoder::DecodeSegment(Segment& segment)
+{
+  typedef DATWordReceiverT<DATTrackAssembler> Words;
+  typedef NRZISyncDeframerT<Words> Deframer;
+
+  SegmentTracks *tracks = new SegmentTracks();
+  DATTrackAssembler assembler(*tracks);
+  Words words(&assembler, false);
+  Deframer deframer(&words);
+  RDATDecoderT<Deframer> decoder(mDecoderRate);
+  RationalResampler *resampler = NULL;
+  float converted[FRAMES_PER_CONVERT];
+  float *resampled = NULL;
+  size_t frameSize, remaining, chunk, n;
+  const char *raw;
+
+  decoder.SetSymbolDecoder(&deframer);
+
+  if (mInterpolation != 0) {
+    resampler = new RationalResampler(mInterpolation, mDecimation);
+    resampled = new float[resampler->MaxOutput(FRAMES_PER_CONVERT)];
+  }
+
+  chunk = mConverter.IsNative() && resampler == NULL ? FRAMES_PER_SPAN :
+    FRAMES_PER_CONVERT;
+  frameSize = mConverter.FrameSize();
+  raw = &mSamples[segment.start * frameSize];
+  remaining = segment.end - segment.start;
+
+  while (remaining > 0 && *mRunning) {
+    n = remaining < chunk ? remaining : chunk;
+    const float *samples = (const float *) raw;
+    if (!mConverter.IsNative()) {
+      mConverter.Convert(raw, converted, n);
+      samples = converted;
+    }
+    if (resampler != NULL)
+      decoder.Process(resampled, resampler->Process(samples, n, resampled));
+    else
+      decoder.Process(samples, n);
+    raw += n * frameSize;
+    remaining -= n;
+  }
+
+  decoder.Stop();
+
+  delete [] resampled;
+  delete resampler;
+
+  segment.tracks = tracks;
+}
@@ -0,0 +1,117 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_PARALLEL_DECODER_H
+#define RDAT_PARALLEL_DECODER_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include "SampleConverter.h"
+#include "DATTrackReceiver.h"
+
+class SegmentTracks;
+
+//
+// Decodes a whole capture, already in memory, on several threads.
+//
+// The capture is cut into segments at the quiet gaps between head
+// swipes (see GapScanner), where the slicer carries nothing of use from
+// one track to the next. Each segment is then sliced, deframed and
+// assembled into error-corrected tracks by a chain of its own, on a
+// pool of worker threads. The tracks are stitched back together in
+// sample order and handed on, for pairing, as though a single decoder
+// had produced them.
+//
+class ParallelDecoder
+{
+public:
+  ParallelDecoder(const SampleConverter& converter, float decoderRate,
+    unsigned int threads);
+  ~ParallelDecoder();
+
+  //
+  // Resample the input by interpolation / decimation before decoding it.
+  //
+  void SetResampling(unsigned int interpolation, unsigned int decimation);
+
+  //
+  // Decode the 'count' frames at 'samples', handing every track to
+  // 'receiver' in order, then stop the receiver. Decoding stops early
+  // if 'running' goes false.
+  //
+  void Decode(const void *samples, size_t count, DATTrackReceiver& receiver,
+    const volatile bool *running);
+
+  //
+  // The size, in frames, that the capture is cut into, give or take the
+  // distance to the next gap.
+  //
+  static const size_t kSegmentFrames = 32 * 1024 * 1024;
+
+protected:
+  struct Segment {
+    size_t start;
+    size_t end;
+    SegmentTracks *tracks;
+    bool done;
+  };
+
+  static void *WorkerMain(void *decoder);
+  void Work();
+  void Split(size_t count);
+  void DecodeSegment(Segment& segment);
+
+  const SampleConverter& mConverter;
+  const float mDecoderRate;
+  const unsigned int mThreads;
+  unsigned int mInterpolation;
+  unsigned int mDecimation;
+
+  //
+  // The capture being decoded and the flag that cancels decoding.
+  //
+  const char *mSamples;
+  const volatile bool *mRunning;
+
+  //
+  // The segments of the capture, the next one a worker should take up
+  // and the number that have been handed on so far. Workers stay no
+  // more than a few segments ahead of the stitching, so that finished
+  // tracks don't pile up in memory.
+  //
+  Segment *mSegments;
+  size_t mSegmentCount;
+  size_t mNextSegment;
+  size_t mStitched;
+
+  pthread_mutex_t mLock;
+  pthread_cond_t mCond;
+};
+
+#endif
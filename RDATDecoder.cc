@@ -30,19 +30,24 @@
 #include <math.h>
 #include <stdio.h>
 #include "RDATDecoder.h"
+#include "WindowScan.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 static const float kSymbolRate = 9408000;
 
-RDATDecoder::RDATDecoder(float sampleRate)
+RDATDecoderBase::RDATDecoderBase(float sampleRate)
 : mSyncWindowCurPos(0), mSyncWindowSyncPos(0),
   mClockDetected(false), mClockRatioThreshold(0.97),
   mClockAlpha(1.0 / 30.0),
+  mTrackInProgress(false),
   //
   // A track is 196 blocks in duration. Convert that to samples and
   // add padding.
   //
-  mTrackDuration((sampleRate / kSymbolRate) * 10 * 36 * 196 * 1.05),
-  mTrackInProgress(false)
+  mTrackDuration((sampleRate / kSymbolRate) * 10 * 36 * 196 * 1.05)
 {
   int i;
   
@@ -61,167 +66,40 @@ RDATDecoder::RDATDecoder(float sampleRate)
   // Keep a history of the sign of the last sample.
   //
   mLastSign = 0;
-}
+  mIntegrator = 0.0;
 
-RDATDecoder::~RDATDecoder()
-{
-  delete mSyncWindow;
+  mBits = 0;
+  mBitCount = 0;
 }
 
-void
-RDATDecoder::SetSymbolDecoder(SymbolDecoder *d)
+RDATDecoderBase::~RDATDecoderBase()
 {
-  mDecoder = d;
-}
-
-void
-RDATDecoder::Process(float *samples, size_t count)
-{
-  size_t i;
-  float signal;
-  bool sign, zeroCross;
-  
-  for (i = 0; i < count; i++) {
-    //
-    // Look at the sample.
-    //
-    signal = samples[i];
-
-    //
-    // Check if this sample has made a zero-crossing.
-    //
-    sign = signal > 0.0;
-    zeroCross = sign != mLastSign;
-
-    //
-    // Send the baseband signal to the clock detector.
-    // If it returns true, then the clock detector has
-    // achieved a good lock and suggests sampling the
-    // signal now.
-    //
-    if (ClockDetect(zeroCross)) {
-      //
-      // Signal should be sampled now. Dump our integrator.
-      //
-      mDecoder->ReceiveBit(mIntegrator > 0.0);
-      mIntegrator = 0.0;
-    }
-
-    //
-    // Update the integrator.
-    //
-    mIntegrator += signal;
-    mLastSign = sign;
-
-    //
-    // If there's no track in progress, see if a new one has perhaps
-    // started.
-    //
-    if (!mTrackInProgress) {
-      //
-      // We're in the idle time between tracks. Check if a track has started.
-      //
-      if (mDecoder->PreambleDetected()) {
-        //
-        // A track appears to have started. Start the track progress timer.
-        //
-        mTrackInProgress = true;
-        mTrackSampleCount = mTrackDuration;
-
-        //
-        // Notify the downstream decoder.
-        //
-        mDecoder->TrackDetected(true);
-      }
-    } else {
-      //
-      // There's a track in progress. See if the track timer has expired.
-      //
-      mTrackSampleCount--;
-      if (mTrackSampleCount == 0) {
-        //
-        // The track should have ended by now. Declare it over.
-        //
-        mTrackInProgress = false;
-        mDecoder->TrackDetected(false);
-      }
-    }
-  }
+  delete mSyncWindow;
 }
 
-void
-RDATDecoder::Stop()
+RDATDecoder::RDATDecoder(float sampleRate)
+  : RDATDecoderT<SymbolDecoder>(sampleRate)
 {
-  //
-  // No further input is coming. Notify upstream symbol receiver.
-  //
-  mDecoder->Stop();
 }
 
+//
+// Scan the clock window (or, mid-cycle in ProcessWindow(), a copy of it
+// as it stands at that sample) for the best sampling position and decide
+// whether there's a clock at all. Returns true if the clock detection
+// state has changed.
+//
 bool
-RDATDecoder::ClockDetect(float sample)
+RDATDecoderBase::EvaluateClock(const float *window)
 {
-  bool syncNow = false;
-  
-  mSyncWindow[mSyncWindowCurPos] *= (1.0 - mClockAlpha);
-  mSyncWindow[mSyncWindowCurPos] += fabs(sample) * mClockAlpha;
-
-  //
-  // If we're at the currently suggested sync window position,
-  // remember so.
-  //
-  if (mSyncWindowCurPos == mSyncWindowSyncPos) {
-    syncNow = true;
-    
-    //
-    // Do a staggered update of the sync window evaluation
-    // position based on the last position calculation.
-    //
-    mSyncWindowEvalPos = mSyncWindowNextEvalPos;
-  }
+  int maxI;
+  float max = 0.0, min = 100.0, ratio;
+  bool detected;
 
-  if (mSyncWindowCurPos == mSyncWindowEvalPos) {
-      //
-      // Take this opportunity to rescan the window,
-      // looking for the highest energy peak and thus, the
-      // best synchronization point.
-      //
-      EvaluateClock();
-  }
-  
   //
-  // Advance the window, wrapping if necessary.
+  // Find the highest peak and the lowest valley.
   //
-  if (++mSyncWindowCurPos == mSyncWindowSize)
-    //
-    // We've reached the end of the window.
-    // Wrap around.
-    //
-    mSyncWindowCurPos = 0;  
-  
-  return mClockDetected && syncNow;
-}
-
-void
-RDATDecoder::EvaluateClock()
-{
-  int i, maxI, minI;
-  float max = 0.0, min = 100.0, ratio;
-
-  for (i = maxI = 0; i < mSyncWindowSize; i++) {
-    //
-    // Find the highest peak.
-    //
-    if (mSyncWindow[i] > max) {
-      max = mSyncWindow[i];
-      maxI = i;
-    }
-    //
-    // And the lowest valley.
-    //
-    if (mSyncWindow[i] < min)
-      min = mSyncWindow[i];
-  }
+  maxI = 0;
+  ScanWindow(window, mSyncWindowSize, max, maxI, min);
   
   if (maxI != mSyncWindowSyncPos) {
     //
@@ -237,30 +115,107 @@ RDATDecoder::EvaluateClock()
   // If there is a significant difference between the highest
   // peak and the lowest valley then we have a good clock signal.
   //
-  if (max > 0.0)
-    ratio = min / max;
-  else
-    ratio = 0.0;
+  ratio = WindowRatio(min, max, mClockRatioThreshold);
+
+  detected = ratio < mClockRatioThreshold;
+  if (detected == mClockDetected)
+    return false;
 
-  if (ratio < mClockRatioThreshold) {
-    if (!mClockDetected && mDecoder != NULL)
-      mDecoder->ClockDetected(true);
-    mClockDetected = true;
-  } else {
-    if (mClockDetected && mDecoder != NULL)
-      mDecoder->ClockDetected(false);
-    mClockDetected = false;
+  mClockDetected = detected;
+  return true;
+}
+
+//
+// Do the clock window update for one whole window cycle of samples,
+// saving the window as it was in 'previous' and leaving the sign of the
+// last sample in mLastSign. The arithmetic is that of ClockDetect(), lane for lane:
+// the decay is a double-precision multiply rounded back to float.
+//
+void
+RDATDecoderBase::UpdateWindow(const float *samples, float *previous)
+{
+  int i = 0;
+  bool sign, zeroCross;
+
+#if defined(__SSE2__)
+  if (mSyncWindowSize % 4 == 0) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 alpha = _mm_set1_ps(mClockAlpha);
+    const __m128d decay = _mm_set1_pd(1.0 - mClockAlpha);
+    __m128i last = _mm_cvtsi32_si128(mLastSign ? -1 : 0);
+
+    for (; i < mSyncWindowSize; i += 4) {
+      //
+      // The signs of these four samples and of the four before them
+      // (shifting in the last sign of the previous group) give the
+      // zero-crossing flags.
+      //
+      __m128i signs = _mm_castps_si128(_mm_cmpgt_ps(_mm_loadu_ps(&samples[i]),
+                                                    zero));
+      __m128i prev = _mm_or_si128(_mm_slli_si128(signs, 4), last);
+      __m128 crossed = _mm_castsi128_ps(_mm_xor_si128(signs, prev));
+      last = _mm_srli_si128(signs, 12);
+
+      __m128 w = _mm_loadu_ps(&mSyncWindow[i]);
+      _mm_storeu_ps(&previous[i], w);
+      __m128 lo = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(w), decay));
+      __m128 hi = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(w, w)),
+                                          decay));
+      w = _mm_movelh_ps(lo, hi);
+      w = _mm_add_ps(w, _mm_and_ps(crossed, alpha));
+      _mm_storeu_ps(&mSyncWindow[i], w);
+    }
+    mLastSign = _mm_cvtsi128_si32(last) != 0;
+    return;
+  }
+#endif
+
+  for (; i < mSyncWindowSize; i++) {
+    sign = samples[i] > 0.0;
+    zeroCross = sign != mLastSign;
+    mLastSign = sign;
+    previous[i] = mSyncWindow[i];
+    mSyncWindow[i] *= (1.0 - mClockAlpha);
+    mSyncWindow[i] += fabs((float) zeroCross) * mClockAlpha;
+  }
+}
+
+//
+// Evaluate the clock partway through a window cycle being handled by
+// ProcessWindow(). The evaluation must see this cycle's updates up to and
+// including 'position', and the previous cycle's values beyond it.
+//
+bool
+RDATDecoderBase::EvaluateClockAt(const float *previous, int position)
+{
+  float mixed[kMaxBlockWindow];
+  int i = 0;
+
+#if defined(__SSE2__)
+  for (; i + 4 <= mSyncWindowSize; i += 4) {
+    __m128i lane = _mm_add_epi32(_mm_set1_epi32(i), _mm_set_epi32(3, 2, 1, 0));
+    __m128 fresh = _mm_castsi128_ps(_mm_cmpgt_epi32(_mm_set1_epi32(position + 1),
+                                                    lane));
+    _mm_storeu_ps(&mixed[i],
+      _mm_or_ps(_mm_and_ps(fresh, _mm_loadu_ps(&mSyncWindow[i])),
+                _mm_andnot_ps(fresh, _mm_loadu_ps(&previous[i]))));
   }
+#endif
+
+  for (; i < mSyncWindowSize; i++)
+    mixed[i] = i <= position ? mSyncWindow[i] : previous[i];
+
+  return EvaluateClock(mixed);
 }
 
 void
-RDATDecoder::SetClockRatioThreshold(float threshhold)
+RDATDecoderBase::SetClockRatioThreshold(float threshhold)
 {
   mClockRatioThreshold = threshhold;
 }
 
 void
-RDATDecoder::SetClockAlpha(float alpha)
+RDATDecoderBase::SetClockAlpha(float alpha)
 {
   mClockAlpha = alpha;
 }
@@ -27,31 +27,39 @@
 // POSSIBILITY OF SUCH DAMAGE.
 //
 
+#ifndef RDAT_RDAT_DECODER_H
+#define RDAT_RDAT_DECODER_H
+
 #include <sys/types.h>
+#include <stdint.h>
+#include <math.h>
 #include "SymbolDecoder.h"
 
-class RDATDecoder
+//
+// The bit slicer's clock detector and the state it shares with the
+// rest of the decoder, none of which depends on where the bits go.
+//
+class RDATDecoderBase
 {
 public:
-	RDATDecoder(float sampleRate);
-	virtual ~RDATDecoder();
-	
-	void SetSymbolDecoder(SymbolDecoder *b);
-	void Process(float *samples, size_t count);
-	void Stop();
-
 	void SetClockRatioThreshold(float threshhold);
 	void SetClockAlpha(float alpha);
-	
-private:
-	bool ClockDetect(float sample);
-	void EvaluateClock(void);
+
+protected:
+	RDATDecoderBase(float sampleRate);
+	~RDATDecoderBase();
+
+	bool ClockDetect(float sample, bool& clockChanged);
+	bool EvaluateClock(const float *window);
+	bool EvaluateClockAt(const float *previous, int position);
+	void UpdateWindow(const float *samples, float *previous);
 
 	//
-	// The upstream receive to whom we should send decoded bits.
+	// The largest clock window that Process() handles a window cycle at
+	// a time. Larger windows fall back to ProcessScalar().
 	//
-	SymbolDecoder *mDecoder;
-	
+	static const int kMaxBlockWindow = 64;
+
 	//
 	// Clock detection variables.
 	//
@@ -85,6 +93,13 @@ private:
 	//
 	float mIntegrator;
 
+	//
+	// Decoded bits not yet handed to the symbol decoder, earliest
+	// most significant, and how many there are.
+	//
+	uint64_t mBits;
+	size_t   mBitCount;
+
 	//
 	// The current "track-in-progress" state.
 	//
@@ -101,3 +116,356 @@ private:
 	//
 	size_t mTrackSampleCount;
 };
+
+//
+// The bit slicer, parameterized on the type of the symbol decoder it
+// feeds. With a concrete decoder type the per-sample and per-bit work
+// all inlines into Process(); RDATDecoder, below, feeds any
+// SymbolDecoder.
+//
+template <class Decoder>
+class RDATDecoderT : public RDATDecoderBase
+{
+public:
+	RDATDecoderT(float sampleRate);
+
+	void SetSymbolDecoder(Decoder *d);
+	void Process(const float *samples, size_t count);
+	void ProcessScalar(const float *samples, size_t count);
+	void Stop();
+
+protected:
+	void ProcessWindow(const float *samples);
+	void FlushBits(void);
+
+	//
+	// The upstream receive to whom we should send decoded bits.
+	//
+	Decoder *mDecoder;
+};
+
+class RDATDecoder : public RDATDecoderT<SymbolDecoder>
+{
+public:
+	RDATDecoder(float sampleRate);
+};
+
+//
+// Advance the clock detector by one sample. Returns true if the clock
+// detector has a good lock and suggests sampling the signal now. Sets
+// 'clockChanged' if the lock was just gained or lost.
+//
+inline bool
+RDATDecoderBase::ClockDetect(float sample, bool& clockChanged)
+{
+  bool syncNow = false;
+  
+  mSyncWindow[mSyncWindowCurPos] *= (1.0 - mClockAlpha);
+  mSyncWindow[mSyncWindowCurPos] += fabs(sample) * mClockAlpha;
+
+  //
+  // If we're at the currently suggested sync window position,
+  // remember so.
+  //
+  if (mSyncWindowCurPos == mSyncWindowSyncPos) {
+    syncNow = true;
+    
+    //
+    // Do a staggered update of the sync window evaluation
+    // position based on the last position calculation.
+    //
+    mSyncWindowEvalPos = mSyncWindowNextEvalPos;
+  }
+
+  clockChanged = false;
+  if (mSyncWindowCurPos == mSyncWindowEvalPos) {
+      //
+      // Take this opportunity to rescan the window,
+      // looking for the highest energy peak and thus, the
+      // best synchronization point.
+      //
+      clockChanged = EvaluateClock(mSyncWindow);
+  }
+  
+  //
+  // Advance the window, wrapping if necessary.
+  //
+  if (++mSyncWindowCurPos == mSyncWindowSize)
+    //
+    // We've reached the end of the window.
+    // Wrap around.
+    //
+    mSyncWindowCurPos = 0;  
+  
+  return mClockDetected && syncNow;
+}
+
+template <class Decoder>
+inline
+RDATDecoderT<Decoder>::RDATDecoderT(float sampleRate)
+  : RDATDecoderBase(sampleRate), mDecoder(NULL)
+{
+}
+
+template <class Decoder>
+inline void
+RDATDecoderT<Decoder>::SetSymbolDecoder(Decoder *d)
+{
+  mDecoder = d;
+}
+
+//
+// Process a run of samples. Whole cycles of the clock window are handled
+// a cycle at a time by ProcessWindow(); the decisions are exactly those
+// ProcessScalar() would make.
+//
+template <class Decoder>
+void
+RDATDecoderT<Decoder>::Process(const float *samples, size_t count)
+{
+  size_t i, head, window;
+
+  window = mSyncWindowSize;
+  if (window > kMaxBlockWindow) {
+    ProcessScalar(samples, count);
+    return;
+  }
+
+  //
+  // Get to the start of a window cycle.
+  //
+  head = mSyncWindowCurPos == 0 ? 0 : window - mSyncWindowCurPos;
+  if (head > count)
+    head = count;
+  ProcessScalar(samples, head);
+
+  for (i = head; count - i >= window; i += window)
+    ProcessWindow(&samples[i]);
+
+  ProcessScalar(&samples[i], count - i);
+}
+
+//
+// Process a run of samples one at a time. This is the reference for the
+// block implementation above.
+//
+template <class Decoder>
+void
+RDATDecoderT<Decoder>::ProcessScalar(const float *samples, size_t count)
+{
+  size_t i;
+  float signal;
+  bool sign, zeroCross, bitNow, clockChanged;
+  
+  for (i = 0; i < count; i++) {
+    //
+    // Look at the sample.
+    //
+    signal = samples[i];
+
+    //
+    // Check if this sample has made a zero-crossing.
+    //
+    sign = signal > 0.0;
+    zeroCross = sign != mLastSign;
+
+    //
+    // Send the baseband signal to the clock detector.
+    // If it returns true, then the clock detector has
+    // achieved a good lock and suggests sampling the
+    // signal now.
+    //
+    bitNow = ClockDetect(zeroCross, clockChanged);
+    if (clockChanged && mDecoder != NULL) {
+      //
+      // The clock was just gained or lost. Deliver the bits that
+      // came before the change, then the change itself.
+      //
+      FlushBits();
+      mDecoder->ClockDetected(mClockDetected);
+    }
+    if (bitNow) {
+      //
+      // Signal should be sampled now. Dump our integrator into the
+      // bit accumulator, which is handed over a word at a time.
+      //
+      mBits = (mBits << 1) | (mIntegrator > 0.0);
+      mIntegrator = 0.0;
+      if (++mBitCount == 64)
+        FlushBits();
+    }
+
+    //
+    // Update the integrator.
+    //
+    mIntegrator += signal;
+    mLastSign = sign;
+
+    //
+    // If there's no track in progress, see if a new one has perhaps
+    // started.
+    //
+    if (!mTrackInProgress) {
+      //
+      // We're in the idle time between tracks. Check if a track has started.
+      // The pre-amble detector must see every bit as it arrives and can
+      // only change its mind when it does, so there's no batching here and
+      // nothing to ask it on samples without a bit.
+      //
+      if (!bitNow)
+        continue;
+      FlushBits();
+      if (mDecoder->PreambleDetected()) {
+        //
+        // A track appears to have started. Start the track progress timer.
+        //
+        mTrackInProgress = true;
+        mTrackSampleCount = mTrackDuration;
+
+        //
+        // Notify the downstream decoder.
+        //
+        mDecoder->TrackDetected(true);
+      }
+    } else {
+      //
+      // There's a track in progress. See if the track timer has expired.
+      //
+      mTrackSampleCount--;
+      if (mTrackSampleCount == 0) {
+        //
+        // The track should have ended by now. Declare it over.
+        //
+        mTrackInProgress = false;
+        FlushBits();
+        mDecoder->TrackDetected(false);
+      }
+    }
+  }
+}
+
+//
+// Process one whole cycle of the clock window, starting at window
+// position zero.
+//
+// The window update and the zero-crossing detection for the cycle are
+// done up front, in vector form, keeping the previous window contents
+// for any evaluation that falls mid-cycle. Then, rather than step through every
+// sample, skip from one sample that needs attention to the next -- the
+// clock sync position, the clock evaluation position and the end of the
+// track timer -- and simply integrate the samples in between.
+//
+template <class Decoder>
+void
+RDATDecoderT<Decoder>::ProcessWindow(const float *samples)
+{
+  float previous[kMaxBlockWindow];
+  float integrator;
+  int p, next, window;
+  bool syncNow, bitNow, clockChanged;
+
+  window = mSyncWindowSize;
+  UpdateWindow(samples, previous);
+
+  integrator = mIntegrator;
+  p = 0;
+
+  for (;;) {
+    //
+    // Find the next sample that needs more than integration.
+    //
+    next = window;
+    if (mSyncWindowSyncPos >= p)
+      next = mSyncWindowSyncPos;
+    if (mSyncWindowEvalPos >= p && mSyncWindowEvalPos < next)
+      next = mSyncWindowEvalPos;
+    if (mTrackInProgress && mTrackSampleCount <= (size_t) (next - p))
+      next = p + mTrackSampleCount - 1;
+
+    if (mTrackInProgress)
+      mTrackSampleCount -= next - p;
+    for (; p < next; p++)
+      integrator += samples[p];
+
+    if (p == window)
+      break;
+
+    //
+    // This sample gets the full treatment, as in ProcessScalar(), except
+    // that its window position has already been updated.
+    //
+    syncNow = p == mSyncWindowSyncPos;
+    if (syncNow)
+      mSyncWindowEvalPos = mSyncWindowNextEvalPos;
+
+    clockChanged = false;
+    if (p == mSyncWindowEvalPos)
+      clockChanged = EvaluateClockAt(previous, p);
+    if (clockChanged && mDecoder != NULL) {
+      FlushBits();
+      mDecoder->ClockDetected(mClockDetected);
+    }
+
+    bitNow = mClockDetected && syncNow;
+    if (bitNow) {
+      mBits = (mBits << 1) | (integrator > 0.0);
+      integrator = 0.0;
+      if (++mBitCount == 64)
+        FlushBits();
+    }
+
+    integrator += samples[p];
+
+    if (!mTrackInProgress) {
+      if (bitNow) {
+        FlushBits();
+        if (mDecoder->PreambleDetected()) {
+          mTrackInProgress = true;
+          mTrackSampleCount = mTrackDuration;
+          mDecoder->TrackDetected(true);
+        }
+      }
+    } else {
+      mTrackSampleCount--;
+      if (mTrackSampleCount == 0) {
+        mTrackInProgress = false;
+        FlushBits();
+        mDecoder->TrackDetected(false);
+      }
+    }
+
+    p++;
+  }
+
+  mIntegrator = integrator;
+}
+
+template <class Decoder>
+void
+RDATDecoderT<Decoder>::Stop()
+{
+  //
+  // No further input is coming. Notify upstream symbol receiver.
+  //
+  FlushBits();
+  mDecoder->Stop();
+}
+
+//
+// Hand any accumulated bits to the symbol decoder. This must happen before
+// any clock or track event is raised, so that the event lands at the right
+// place in the bit stream.
+//
+template <class Decoder>
+inline void
+RDATDecoderT<Decoder>::FlushBits()
+{
+  if (mBitCount == 0)
+    return;
+
+  mDecoder->ReceiveBits(mBits, mBitCount);
+  mBits = 0;
+  mBitCount = 0;
+}
+
+#endif
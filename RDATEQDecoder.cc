@@ -30,6 +30,7 @@
 #include <math.h>
 #include <stdio.h>
 #include "RDATEQDecoder.h"
+#include "WindowScan.h"
 
 static const float kSymbolRate = 9408000;
 
@@ -64,7 +65,7 @@ RDATEQDecoder::SetSymbolDecoder(EQSymbolDecoder *d)
 }
 
 void
-RDATEQDecoder::Process(float *samples, size_t count)
+RDATEQDecoder::Process(const float *samples, size_t count)
 {
   size_t i;
   float signal;
@@ -138,23 +139,14 @@ RDATEQDecoder::ClockDetect(float sample)
 void
 RDATEQDecoder::EvaluateClock()
 {
-  int i, maxI, minI;
+  int maxI;
   float max = 0.0, min = 100.0, ratio;
 
-  for (i = maxI = 0; i < mSyncWindowSize; i++) {
-    //
-    // Find the highest peak.
-    //
-    if (mSyncWindow[i] > max) {
-      max = mSyncWindow[i];
-      maxI = i;
-    }
-    //
-    // And the lowest valley.
-    //
-    if (mSyncWindow[i] < min)
-      min = mSyncWindow[i];
-  }
+  //
+  // Find the highest peak and the lowest valley.
+  //
+  maxI = 0;
+  ScanWindow(mSyncWindow, mSyncWindowSize, max, maxI, min);
   
   if (maxI != mSyncWindowSyncPos) {
     //
@@ -170,10 +162,7 @@ RDATEQDecoder::EvaluateClock()
   // If there is a significant difference between the highest
   // peak and the lowest valley then we have a good clock signal.
   //
-  if (max > 0.0)
-    ratio = min / max;
-  else
-    ratio = 0.0;
+  ratio = WindowRatio(min, max, mClockRatioThreshold);
 
   if (ratio < mClockRatioThreshold)
     mClockDetected = true;
@@ -40,7 +40,7 @@ public:
 	virtual ~RDATEQDecoder();
 	
 	void SetSymbolDecoder(EQSymbolDecoder *b);
-	void Process(float *samples, size_t count);
+	void Process(const float *samples, size_t count);
 	void Stop();
 
 	void SetClockRatioThreshold(float threshhold);
@@ -0,0 +1,293 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <math.h>
+#include <stdio.h>
+#include "RDATGardnerDecoder.h"
+
+static const float kSymbolRate = 9408000;
+
+//
+// Defaults for the timing loop. The bandwidth is a fraction of the
+// symbol rate; the loop is critically damped.
+//
+static const float kDefaultLoopBandwidth = 0.005;
+static const double kDamping = 0.707;
+
+//
+// Time constant, in symbols, of the level averages.
+//
+static const float kLevelAlpha = 1.0 / 64.0;
+
+//
+// Lock is declared below one threshold and released above a slightly
+// higher one, so that the decision doesn't chatter.
+//
+static const float kDefaultLockThreshold = 0.5;
+static const float kLockHysteresis = 0.1;
+
+//
+// Below this average strobe magnitude there is no signal to speak of.
+//
+static const float kMinimumLevel = 1e-6;
+
+//
+// The loop integrator holds the clock frequency error, in symbols per
+// symbol. Tape speed never strays far from nominal, so keep the loop
+// from wandering off while it is fed only noise or silence.
+//
+static const double kMaxFrequencyError = 0.02;
+
+RDATGardnerDecoder::RDATGardnerDecoder(float sampleRate)
+: mDecoder(NULL),
+  mSamplesPerSymbol(sampleRate / kSymbolRate),
+  mLockThreshold(kDefaultLockThreshold),
+  //
+  // A track is 196 blocks in duration. Convert that to samples and
+  // add padding.
+  //
+  mTrackDuration((sampleRate / kSymbolRate) * 10 * 36 * 196 * 1.05)
+{
+  SetLoopBandwidth(kDefaultLoopBandwidth);
+  Reset();
+}
+
+RDATGardnerDecoder::~RDATGardnerDecoder()
+{
+}
+
+void
+RDATGardnerDecoder::SetSymbolDecoder(SymbolDecoder *d)
+{
+  mDecoder = d;
+}
+
+void
+RDATGardnerDecoder::Reset()
+{
+  for (int i = 0; i < 4; i++)
+    mHistory[i] = 0.0;
+  mNext = 0.0;
+  mAtStrobe = true;
+  mLastStrobe = 0.0;
+  mMidpoint = 0.0;
+  mLoopIntegrator = 0.0;
+  mStrobeLevel = 0.0;
+  mMidpointLevel = 0.0;
+  mClockDetected = false;
+  mTrackInProgress = false;
+  mTrackSampleCount = 0;
+}
+
+//
+// Compute the proportional and integral gains of a second order loop
+// with the given noise bandwidth (normalized to the symbol rate). The
+// normalized timing error has a slope of about 2 per symbol of offset.
+//
+void
+RDATGardnerDecoder::SetLoopBandwidth(float bandwidth)
+{
+  const double kDetectorGain = 2.0;
+  double theta = bandwidth / (kDamping + 0.25 / kDamping);
+  double d = 1.0 + 2.0 * kDamping * theta + theta * theta;
+
+  mKp = (4.0 * kDamping * theta / d) / kDetectorGain;
+  mKi = (4.0 * theta * theta / d) / kDetectorGain;
+}
+
+void
+RDATGardnerDecoder::SetLockThreshold(float threshold)
+{
+  mLockThreshold = threshold;
+}
+
+void
+RDATGardnerDecoder::Process(const float *samples, size_t count)
+{
+  size_t i;
+
+  for (i = 0; i < count; i++) {
+    mHistory[0] = mHistory[1];
+    mHistory[1] = mHistory[2];
+    mHistory[2] = mHistory[3];
+    mHistory[3] = samples[i];
+
+    //
+    // The interpolation window has slid forward by one sample. If the
+    // next interpolant now lies between the middle two samples, compute
+    // it. Interpolants are always more than one sample apart, so there
+    // is at most one per input sample.
+    //
+    mNext -= 1.0;
+    if (mNext < 1.0) {
+      float mu = mNext < 0.0 ? 0.0 : mNext;
+
+      //
+      // Cubic Lagrange interpolation in Farrow form.
+      //
+      float x0 = mHistory[0], x1 = mHistory[1];
+      float x2 = mHistory[2], x3 = mHistory[3];
+      float c3 = (x3 - x0) / 6.0f + (x1 - x2) / 2.0f;
+      float c2 = (x0 + x2) / 2.0f - x1;
+      float c1 = x2 - x1 / 2.0f - x0 / 3.0f - x3 / 6.0f;
+      float y = ((c3 * mu + c2) * mu + c1) * mu + x1;
+
+      Interpolated(y);
+    }
+
+    //
+    // If there's no track in progress, see if a new one has perhaps
+    // started.
+    //
+    if (!mTrackInProgress) {
+      if (mDecoder != NULL && mDecoder->PreambleDetected()) {
+        //
+        // A track appears to have started. Start the track progress timer.
+        //
+        mTrackInProgress = true;
+        mTrackSampleCount = mTrackDuration;
+        mDecoder->TrackDetected(true);
+      }
+    } else {
+      //
+      // There's a track in progress. See if the track timer has expired.
+      //
+      mTrackSampleCount--;
+      if (mTrackSampleCount == 0) {
+        mTrackInProgress = false;
+        if (mDecoder != NULL)
+          mDecoder->TrackDetected(false);
+      }
+    }
+  }
+}
+
+//
+// Handle a new interpolant and schedule the next one.
+//
+void
+RDATGardnerDecoder::Interpolated(float value)
+{
+  double step = mSamplesPerSymbol / 2.0;
+
+  if (mAtStrobe) {
+    Strobe(value);
+
+    //
+    // Gardner timing error: the midpoint sample, weighted by the
+    // direction of the transition it sits in. It is zero when the
+    // midpoint lands on the crossing and negative when we sample late.
+    // Normalize it by the signal level so that the loop gain doesn't
+    // depend on the capture's amplitude.
+    //
+    double error = 0.0;
+    if (mStrobeLevel > kMinimumLevel)
+      error = mMidpoint * (mLastStrobe - value) /
+              (mStrobeLevel * mStrobeLevel);
+    if (error < -1.0)
+      error = -1.0;
+    else if (error > 1.0)
+      error = 1.0;
+
+    mLoopIntegrator += mKi * error;
+    if (mLoopIntegrator > kMaxFrequencyError)
+      mLoopIntegrator = kMaxFrequencyError;
+    else if (mLoopIntegrator < -kMaxFrequencyError)
+      mLoopIntegrator = -kMaxFrequencyError;
+    double adjust = mKp * error + mLoopIntegrator;
+
+    //
+    // The loop's output is in symbols. Apply it to the time until the
+    // next midpoint; a late loop shortens the interval.
+    //
+    step += adjust * mSamplesPerSymbol;
+
+    mLastStrobe = value;
+  } else {
+    mMidpoint = value;
+  }
+
+  mNext += step;
+  mAtStrobe = !mAtStrobe;
+}
+
+//
+// A symbol strobe. Slice it into a bit if the clock is locked.
+//
+void
+RDATGardnerDecoder::Strobe(float value)
+{
+  mStrobeLevel += (fabsf(value) - mStrobeLevel) * kLevelAlpha;
+
+  //
+  // Only midpoints that sit between two differing symbols say anything
+  // about the timing.
+  //
+  if ((value > 0.0) != (mLastStrobe > 0.0))
+    mMidpointLevel += (fabsf(mMidpoint) - mMidpointLevel) * kLevelAlpha;
+
+  UpdateLock();
+
+  if (mClockDetected && mDecoder != NULL)
+    mDecoder->ReceiveBit(value > 0.0);
+}
+
+//
+// When locked, strobes sit on the flat tops of the symbols and the
+// midpoints between differing symbols sit on the zero crossings, so the
+// latter are much smaller on average. Without a signal, the two look
+// alike.
+//
+void
+RDATGardnerDecoder::UpdateLock()
+{
+  float ratio = 1.0;
+
+  if (mStrobeLevel > kMinimumLevel)
+    ratio = mMidpointLevel / mStrobeLevel;
+
+  if (!mClockDetected && ratio < mLockThreshold) {
+    mClockDetected = true;
+    if (mDecoder != NULL)
+      mDecoder->ClockDetected(true);
+  } else if (mClockDetected && ratio > mLockThreshold + kLockHysteresis) {
+    mClockDetected = false;
+    if (mDecoder != NULL)
+      mDecoder->ClockDetected(false);
+  }
+}
+
+void
+RDATGardnerDecoder::Stop()
+{
+  //
+  // No further input is coming. Notify upstream symbol receiver.
+  //
+  if (mDecoder != NULL)
+    mDecoder->Stop();
+}
@@ -0,0 +1,123 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#ifndef RDAT_GARDNER_DECODER_H
+#define RDAT_GARDNER_DECODER_H
+
+#include <stddef.h>
+#include "SymbolDecoder.h"
+
+//
+// A symbol slicer that recovers the symbol clock with an interpolating
+// Gardner timing loop rather than by looking for the best of a whole
+// number of sample phases. It works at any sample rate above roughly 2.2
+// times the symbol rate, so it can decode captures at the A/D's own rate.
+//
+// Twice per symbol a cubic interpolator estimates the signal between the
+// input samples: once at the symbol center (the strobe) and once halfway
+// between symbols. The midpoint falls on the zero crossing of every
+// transition when the timing is right; when it is early or late it leans
+// towards one of the neighboring strobes, and that lean steers the loop.
+//
+class RDATGardnerDecoder
+{
+public:
+  RDATGardnerDecoder(float sampleRate);
+  ~RDATGardnerDecoder();
+
+  void SetSymbolDecoder(SymbolDecoder *d);
+  void Reset();
+  void Process(const float *samples, size_t count);
+  void Stop();
+
+  //
+  // Set the timing loop's noise bandwidth, as a fraction of the symbol
+  // rate.
+  //
+  void SetLoopBandwidth(float bandwidth);
+
+  //
+  // Largest ratio of average midpoint magnitude (between differing
+  // symbols) to average strobe magnitude that is considered a clock lock.
+  //
+  void SetLockThreshold(float threshold);
+
+private:
+  void Interpolated(float value);
+  void Strobe(float value);
+  void UpdateLock();
+
+  //
+  // The upstream receiver to whom we should send decoded bits.
+  //
+  SymbolDecoder *mDecoder;
+
+  //
+  // Nominal samples per symbol.
+  //
+  const double mSamplesPerSymbol;
+
+  //
+  // The last four input samples, oldest first, and the position of the
+  // next interpolant measured in samples from the second of them.
+  //
+  float mHistory[4];
+  double mNext;
+
+  //
+  // True if the next interpolant is a strobe rather than a midpoint.
+  //
+  bool mAtStrobe;
+  float mLastStrobe;
+  float mMidpoint;
+
+  //
+  // Loop filter state and gains.
+  //
+  double mLoopIntegrator;
+  double mKp;
+  double mKi;
+
+  //
+  // Running averages of strobe and midpoint magnitudes, used for
+  // normalizing the timing error and for lock detection.
+  //
+  float mStrobeLevel;
+  float mMidpointLevel;
+  float mLockThreshold;
+  bool mClockDetected;
+
+  //
+  // Track timing; identical in spirit to RDATDecoder.
+  //
+  bool mTrackInProgress;
+  const size_t mTrackDuration;
+  size_t mTrackSampleCount;
+};
+
+#endif
@@ -89,7 +89,7 @@ RDATSlopeDecoder::SetSymbolDecoder(SymbolDecoder *d)
 }
 
 void
-RDATSlopeDecoder::Process(float *samples, size_t count)
+RDATSlopeDecoder::Process(const float *samples, size_t count)
 {
   size_t i;
   float signal;
@@ -41,7 +41,7 @@ public:
 
   void SetSymbolDecoder(SymbolDecoder *);
   void Reset();
-  void Process(float *samples, size_t count);
+  void Process(const float *samples, size_t count);
   void Stop();
 
 protected:
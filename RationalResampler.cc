@@ -0,0 +1,250 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <math.h>
+#include <string.h>
+#include "RationalResampler.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+//
+// Input is copied into the working buffer in blocks of at most this
+// many samples.
+//
+static const size_t kBlock = 4096;
+
+//
+// Kaiser window shape parameter; about 70 dB of stopband rejection.
+//
+static const double kKaiserBeta = 7.0;
+
+//
+// Zeroth-order modified Bessel function of the first kind, for the
+// Kaiser window.
+//
+static double
+bessel_i0(double x)
+{
+  double sum = 1.0, term = 1.0;
+
+  for (int k = 1; k < 50; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < sum * 1e-12)
+      break;
+  }
+
+  return sum;
+}
+
+static unsigned long long
+gcd(unsigned long long a, unsigned long long b)
+{
+  while (b != 0) {
+    unsigned long long t = a % b;
+    a = b;
+    b = t;
+  }
+
+  return a;
+}
+
+static float
+dot(const float *h, const float *x, unsigned int n)
+{
+  unsigned int i = 0;
+
+#if defined(__SSE__)
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+
+  for (; i + 8 <= n; i += 8) {
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(&h[i + 0]),
+                                       _mm_loadu_ps(&x[i + 0])));
+    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(&h[i + 4]),
+                                       _mm_loadu_ps(&x[i + 4])));
+  }
+  for (; i + 4 <= n; i += 4)
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(&h[i]),
+                                       _mm_loadu_ps(&x[i])));
+
+  float lanes[4];
+  _mm_storeu_ps(lanes, _mm_add_ps(acc0, acc1));
+
+  return (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#else
+  float acc[4] = { 0.0, 0.0, 0.0, 0.0 };
+
+  for (; i < n; i += 4) {
+    acc[0] += h[i + 0] * x[i + 0];
+    acc[1] += h[i + 1] * x[i + 1];
+    acc[2] += h[i + 2] * x[i + 2];
+    acc[3] += h[i + 3] * x[i + 3];
+  }
+
+  return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+}
+
+RationalResampler::RationalResampler(unsigned int interpolation,
+  unsigned int decimation, unsigned int tapsPerPhase)
+  : mL(interpolation), mM(decimation),
+    mTaps((tapsPerPhase + 3) & ~3U)
+{
+  mBank = new float[(size_t) mL * mTaps];
+  mBufferSize = mTaps - 1 + kBlock;
+  mBuffer = new float[mBufferSize];
+
+  Design();
+  Reset();
+}
+
+RationalResampler::~RationalResampler()
+{
+  delete [] mBank;
+  delete [] mBuffer;
+}
+
+bool
+RationalResampler::Ratio(double inRate, double outRate,
+  unsigned int& interpolation, unsigned int& decimation)
+{
+  if (inRate < 1.0 || outRate < 1.0)
+    return false;
+
+  unsigned long long in = (unsigned long long) inRate;
+  unsigned long long out = (unsigned long long) outRate;
+
+  if ((double) in != inRate || (double) out != outRate)
+    return false;
+
+  unsigned long long g = gcd(in, out);
+
+  if (out / g > kMaxPhases || in / g > kMaxPhases)
+    return false;
+
+  interpolation = out / g;
+  decimation = in / g;
+
+  return true;
+}
+
+//
+// Design the prototype low-pass filter, a Kaiser-windowed sinc running
+// at the interpolated rate, and split it into the polyphase bank. The
+// cutoff sits at the lower of the input and output Nyquist frequencies.
+//
+void
+RationalResampler::Design()
+{
+  size_t length = (size_t) mL * mTaps;
+  double cutoff = 0.5 / (mL > mM ? mL : mM);
+  double center = (length - 1) / 2.0;
+  double norm = bessel_i0(kKaiserBeta);
+  double sum = 0.0;
+  size_t i;
+  unsigned int p, j;
+
+  double *proto = new double[length];
+
+  for (i = 0; i < length; i++) {
+    double t = i - center;
+    double r = t / (center + 1.0);
+    double w = bessel_i0(kKaiserBeta * sqrt(1.0 - r * r)) / norm;
+    double s = t == 0.0 ? 2.0 * cutoff
+                        : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+    proto[i] = s * w;
+    sum += proto[i];
+  }
+
+  //
+  // Each output draws on one branch, so scale for unity gain per branch
+  // on average.
+  //
+  for (p = 0; p < mL; p++)
+    for (j = 0; j < mTaps; j++)
+      mBank[(size_t) p * mTaps + (mTaps - 1 - j)] =
+        proto[p + (size_t) j * mL] * mL / sum;
+
+  delete [] proto;
+}
+
+void
+RationalResampler::Reset()
+{
+  //
+  // Start with a history of silence.
+  //
+  for (size_t i = 0; i < mBufferSize; i++)
+    mBuffer[i] = 0.0;
+
+  mNext = mTaps - 1;
+  mPhase = 0;
+}
+
+size_t
+RationalResampler::MaxOutput(size_t count) const
+{
+  return (count * mL) / mM + 1 + (count + kBlock - 1) / kBlock;
+}
+
+size_t
+RationalResampler::Process(const float *in, size_t count, float *out)
+{
+  const size_t history = mTaps - 1;
+  size_t produced = 0;
+
+  while (count > 0) {
+    size_t n = count < kBlock ? count : kBlock;
+
+    memcpy(&mBuffer[history], in, n * sizeof(float));
+
+    size_t avail = history + n;
+
+    while (mNext < avail) {
+      out[produced++] = dot(&mBank[(size_t) mPhase * mTaps],
+                            &mBuffer[mNext - history], mTaps);
+      mPhase += mM;
+      mNext += mPhase / mL;
+      mPhase %= mL;
+    }
+
+    //
+    // Slide the tail of this block down to become the next history.
+    //
+    memmove(mBuffer, &mBuffer[avail - history], history * sizeof(float));
+    mNext -= n;
+
+    in += n;
+    count -= n;
+  }
+
+  return produced;
+}
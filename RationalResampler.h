@@ -0,0 +1,105 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#ifndef RDAT_RATIONAL_RESAMPLER_H
+#define RDAT_RATIONAL_RESAMPLER_H
+
+#include <stddef.h>
+
+//
+// A polyphase FIR resampler that changes the sample rate by the rational
+// factor interpolation / decimation. It lets captures taken at the A/D's
+// own rate be brought up to the rate the decoders expect without first
+// expanding them on disk.
+//
+class RationalResampler
+{
+public:
+  RationalResampler(unsigned int interpolation, unsigned int decimation,
+    unsigned int tapsPerPhase = kDefaultTapsPerPhase);
+  ~RationalResampler();
+
+  //
+  // Reduce an input and output sample rate, in Hz, to the smallest
+  // interpolation and decimation factors. Fails if the rates aren't
+  // whole numbers or if the filter bank would be unreasonably large.
+  //
+  static bool Ratio(double inRate, double outRate,
+    unsigned int& interpolation, unsigned int& decimation);
+
+  //
+  // Discard all history.
+  //
+  void Reset();
+
+  //
+  // The most output samples that 'count' input samples can produce.
+  //
+  size_t MaxOutput(size_t count) const;
+
+  //
+  // Resample 'count' input samples into 'out', which must have room for
+  // MaxOutput(count) samples. Returns the number of samples produced.
+  //
+  size_t Process(const float *in, size_t count, float *out);
+
+  static const unsigned int kDefaultTapsPerPhase = 24;
+  static const unsigned int kMaxPhases = 65536;
+
+protected:
+  void Design();
+
+  //
+  // Interpolation and decimation factors.
+  //
+  const unsigned int mL;
+  const unsigned int mM;
+
+  //
+  // Taps in each polyphase branch (a multiple of four) and the bank of
+  // branches themselves, mL rows of mTaps coefficients. Each row is
+  // stored time-reversed so that it lines up with the input history.
+  //
+  const unsigned int mTaps;
+  float *mBank;
+
+  //
+  // Input history followed by the block currently being processed.
+  //
+  float *mBuffer;
+  size_t mBufferSize;
+
+  //
+  // Index in mBuffer of the newest input sample the next output depends
+  // on, and the filter branch that produces it.
+  //
+  size_t mNext;
+  unsigned int mPhase;
+};
+
+#endif
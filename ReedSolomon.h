@@ -0,0 +1,372 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_REEDSOLOMON_H
+#define RDAT_REEDSOLOMON_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "ECC_GF28.h"
+#include "ECC_GF28_Arith.h"
+#include "ECC_Syndrome.h"
+#include "ReedSolomon_EUA.h"
+
+//
+// How the coefficients of a codeword polynomial are laid out in memory.
+// DAT and DDS store the highest-order coefficient first.
+//
+typedef enum {
+  RS_HIGH_FIRST,
+  RS_LOW_FIRST
+} RS_Order;
+
+//
+// A Reed-Solomon codec over GF(2^8) for an (N, N - TwoT) code whose
+// generator polynomial has the roots alpha^FirstRoot through
+// alpha^(FirstRoot + TwoT - 1).
+//
+// Everything the decoder needs that depends only on the code -- the
+// check matrix, and the Chien search and Forney constants for each byte
+// position -- is worked out at compile time, so each code is a fixed-size
+// decoder that the compiler can unroll. A new code is one line:
+//
+//   typedef ReedSolomon<32, 6> DAT_C2;
+//
+template <size_t N, size_t TwoT, size_t FirstRoot = 0,
+          RS_Order Order = RS_HIGH_FIRST>
+class ReedSolomon {
+public:
+  static const size_t kN = N;
+  static const size_t kTwoT = TwoT;
+  static const size_t kT = TwoT / 2;
+
+  static_assert(N <= 255, "codewords can be at most 255 bytes long");
+  static_assert(TwoT % 2 == 0 && TwoT < N, "bad number of parity bytes");
+  static_assert(TwoT <= ECC_Syndrome::kMaxTwoT,
+    "too many parity bytes for the syndrome kernels");
+
+  //
+  // The power of x whose coefficient is stored at memory position 'j'.
+  //
+  static constexpr size_t
+  Power(size_t j)
+  {
+    return Order == RS_HIGH_FIRST ? N - 1 - j : j;
+  }
+
+  struct Tables {
+    //
+    // The check matrix, by memory position: check[i][j] is
+    // alpha^((FirstRoot + i) * Power(j)).
+    //
+    uint8_t check[TwoT][N];
+
+    //
+    // alpha^-Power(j): the root of the error locator polynomial when the
+    // byte at position j is in error.
+    //
+    uint8_t chien[N];
+
+    //
+    // The factor Forney's formula needs for the roots of a code that
+    // doesn't start at alpha^0: (alpha^-Power(j))^FirstRoot.
+    //
+    uint8_t forney[N];
+
+    //
+    // alpha^-k: what the k'th term of the error locator polynomial is
+    // multiplied by from one power of x to the next during the Chien
+    // search.
+    //
+    uint8_t step[TwoT+1];
+
+    constexpr Tables()
+      : check(), chien(), forney(), step()
+    {
+      for (size_t j = 0; j < N; j++) {
+        const size_t p = Power(j);
+
+        for (size_t i = 0; i < TwoT; i++)
+          check[i][j] = ECC_GF28_generate_pow_alpha((FirstRoot + i) * p);
+        chien[j] = ECC_GF28_generate_pow_alpha(255 - p);
+        forney[j] = ECC_GF28_generate_pow_alpha((255 - p) * FirstRoot);
+      }
+      for (size_t k = 0; k <= TwoT; k++)
+        step[k] = ECC_GF28_generate_pow_alpha(255 - k);
+    }
+  };
+
+  static constexpr Tables kTables = Tables();
+
+  //
+  // Does the generated check matrix match the given one? (For checking
+  // the generator against the published tables at compile time.)
+  //
+  static constexpr bool Matches(const uint8_t (&check)[TwoT][N]);
+
+  //
+  // The syndrome calculator for this code's check matrix.
+  //
+  static const ECC_Syndrome& Syndromes();
+
+  //
+  // Correct 'word' given its (nonzero) syndrome and the powers of any
+  // known erasures. Returns true, with the word corrected and the number
+  // of bytes changed in 'corrections', if the corrections found account
+  // for the whole syndrome. Returns false, with the word untouched, if
+  // they don't. The syndrome is consumed either way.
+  //
+  // The arithmetic is whichever ECC_GF28_Arith has selected. Decode()
+  // does the same with the given arithmetic.
+  //
+  static bool Correct(uint8_t (&word)[N], uint8_t (&syndrome)[TwoT],
+    const uint8_t erasures[TwoT], size_t numErasures, size_t& corrections);
+
+  template <class GF>
+  static bool Decode(uint8_t (&word)[N], uint8_t (&syndrome)[TwoT],
+    const uint8_t erasures[TwoT], size_t numErasures, size_t& corrections);
+
+protected:
+  //
+  // Find the memory positions of the errors: the roots of the error
+  // locator polynomial, of the given degree, that fall in the codeword.
+  // Returns how many there are.
+  //
+  template <class GF>
+  static size_t FindErrors(const uint8_t (&locator)[TwoT+1], size_t degree,
+    size_t (&positions)[TwoT]);
+
+  //
+  // Add the position that the root 'x' of the error locator stands for,
+  // if it is in the codeword.
+  //
+  template <class GF>
+  static void AddRoot(uint8_t x, size_t (&positions)[TwoT], size_t& count);
+};
+
+template <size_t N, size_t TwoT, size_t FirstRoot, RS_Order Order>
+constexpr bool
+ReedSolomon<N, TwoT, FirstRoot, Order>::Matches(
+  const uint8_t (&check)[TwoT][N])
+{
+  for (size_t i = 0; i < TwoT; i++)
+    for (size_t j = 0; j < N; j++)
+      if (kTables.check[i][j] != check[i][j])
+        return false;
+
+  return true;
+}
+
+template <size_t N, size_t TwoT, size_t FirstRoot, RS_Order Order>
+inline const ECC_Syndrome&
+ReedSolomon<N, TwoT, FirstRoot, Order>::Syndromes()
+{
+  static const ECC_Syndrome syndromes(&kTables.check[0][0], TwoT, N);
+
+  return syndromes;
+}
+
+template <size_t N, size_t TwoT, size_t FirstRoot, RS_Order Order>
+inline bool
+ReedSolomon<N, TwoT, FirstRoot, Order>::Correct(uint8_t (&word)[N],
+  uint8_t (&syndrome)[TwoT], const uint8_t erasures[TwoT],
+  size_t numErasures, size_t& corrections)
+{
+  switch (ECC_GF28_Arith::Selected()) {
+  case ECC_GF28_Arith::PRODUCT_TABLE:
+    return Decode<ECC_GF28_ProductTable>(word, syndrome, erasures,
+      numErasures, corrections);
+  case ECC_GF28_Arith::AFFINE:
+    return Decode<ECC_GF28_Affine>(word, syndrome, erasures, numErasures,
+      corrections);
+  default:
+    return Decode<ECC_GF28_LogExp>(word, syndrome, erasures, numErasures,
+      corrections);
+  }
+}
+
+template <size_t N, size_t TwoT, size_t FirstRoot, RS_Order Order>
+template <class GF>
+inline bool
+ReedSolomon<N, TwoT, FirstRoot, Order>::Decode(uint8_t (&word)[N],
+  uint8_t (&syndrome)[TwoT], const uint8_t erasures[TwoT],
+  size_t numErasures, size_t& corrections)
+{
+  uint8_t locator[TwoT+1], magnitude[TwoT];
+
+  //
+  // Run the extended Euclidean algorithm, with erasures, to find the
+  // error locator polynomial and the error magnitude polynomial.
+  //
+  corrections = 0;
+  if (!RS_Solve<kT, GF>(syndrome, erasures, numErasures, locator, magnitude))
+    return false;
+
+  //
+  // The errors should be correctable. Find the error locations from the
+  // roots of the error locator polynomial.
+  //
+  size_t degree = TwoT;
+  while (degree > 0 && locator[degree] == 0)
+    degree--;
+
+  size_t  positions[TwoT];
+  uint8_t values[TwoT];
+  size_t  count = FindErrors<GF>(locator, degree, positions);
+  bool    corrected = false;
+
+  for (size_t k = 0; k < count; k++) {
+    const size_t j = positions[k];
+    const uint8_t x = kTables.chien[j];
+
+    //
+    // Use Forney's formula to calculate the error value.
+    //
+    uint8_t value = RS_GetErrorAtLocation<kT, GF>(locator, magnitude, x);
+    if (FirstRoot != 0)
+      value = GF::Multiply(value, kTables.forney[j]);
+    values[k] = value;
+
+    //
+    // Update the syndrome with this correction.
+    //
+    corrected = true;
+    for (size_t i = 0; i < TwoT; i++) {
+      syndrome[i] ^= GF::Multiply(value, kTables.check[i][j]);
+      corrected = corrected && syndrome[i] == 0;
+    }
+  }
+
+  //
+  // If the planned corrections don't fix the syndrome completely then the
+  // errors are uncorrectable.
+  //
+  if (!corrected)
+    return false;
+
+  for (size_t k = 0; k < count; k++)
+    word[positions[k]] ^= values[k];
+  corrections = count;
+
+  return true;
+}
+
+template <size_t N, size_t TwoT, size_t FirstRoot, RS_Order Order>
+template <class GF>
+inline size_t
+ReedSolomon<N, TwoT, FirstRoot, Order>::FindErrors(
+  const uint8_t (&locator)[TwoT+1], size_t degree, size_t (&positions)[TwoT])
+{
+  size_t count = 0;
+
+  if (degree == 0) {
+    //
+    // A constant has no roots. (Nor does the zero polynomial point at
+    // any sensible set of errors.)
+    //
+    return 0;
+  }
+
+  if (degree == 1) {
+    //
+    // One error: the root is l0 / l1.
+    //
+    AddRoot<GF>(GF::Multiply(locator[0], GF::Invert(locator[1])),
+      positions, count);
+    return count;
+  }
+
+  if (degree == 2 && locator[1] != 0) {
+    //
+    // Two errors. Substituting x = (l1 / l2) y turns
+    //
+    //   l2 x^2 + l1 x + l0 = 0    into    y^2 + y = l0 l2 / l1^2,
+    //
+    // which the field's quadratic table solves directly. (Without an x
+    // term there is only a repeated root, which no pair of errors makes;
+    // the general search below deals with that.)
+    //
+    const uint8_t inv1 = GF::Invert(locator[1]);
+    const uint8_t a = GF::Multiply(locator[1], GF::Invert(locator[2]));
+    const uint8_t c = GF::Multiply(GF::Multiply(locator[0], locator[2]),
+      GF::Multiply(inv1, inv1));
+    uint8_t y;
+
+    if (!ECC_GF28_solve_quadratic(c, y))
+      return 0;
+
+    const uint8_t x = GF::Multiply(a, y);
+    AddRoot<GF>(x, positions, count);
+    AddRoot<GF>(x ^ a, positions, count);
+    return count;
+  }
+
+  //
+  // The Chien search: evaluate the locator at x = alpha^-p for every
+  // power p in the codeword. Going from one power to the next multiplies
+  // the k'th term by the constant alpha^-k, so each step costs one
+  // multiplication per term. A polynomial has no more roots than its
+  // degree, so stop once they are all found.
+  //
+  uint8_t terms[TwoT+1];
+  for (size_t k = 0; k <= degree; k++)
+    terms[k] = locator[k];
+
+  for (size_t p = 0; p < N && count < degree; p++) {
+    uint8_t sum = terms[0];
+    for (size_t k = 1; k <= degree; k++) {
+      sum ^= terms[k];
+      terms[k] = GF::Multiply(terms[k], kTables.step[k]);
+    }
+    if (sum == 0)
+      positions[count++] = Power(p);
+  }
+
+  return count;
+}
+
+template <size_t N, size_t TwoT, size_t FirstRoot, RS_Order Order>
+template <class GF>
+inline void
+ReedSolomon<N, TwoT, FirstRoot, Order>::AddRoot(uint8_t x,
+  size_t (&positions)[TwoT], size_t& count)
+{
+  if (x == 0)
+    return;
+
+  //
+  // x = alpha^-p, for the power p. Power() maps a power back to its
+  // memory position just as it maps a position to its power.
+  //
+  const size_t p = (255 - GF::LogAlpha(x)) % 255;
+  if (p < N)
+    positions[count++] = Power(p);
+}
+
+#endif
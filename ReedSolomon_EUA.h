@@ -31,11 +31,12 @@
 #define RDAT_REEDSOLOMON_EUA_H
 
 #include <stddef.h>
-#include "ECC_GF28.h"
+#include "ECC_GF28_Arith.h"
 
 //
 // These are helper polynomials. Skip down further to find the Reed-Solomon
-// algorithms.
+// algorithms. Those that multiply do so with the field arithmetic 'GF',
+// one of the classes in ECC_GF28_Arith.h.
 //
 template <size_t n>
 void
@@ -50,12 +51,11 @@ poly_multiply_by_x(const uint8_t (&in)[n], uint8_t (&out)[n])
   out[0] = 0;
 };
 
-template <size_t n>
+template <class GF, size_t n>
 void
 poly_multiply_scalar(const uint8_t (&in)[n], const uint8_t s, uint8_t (&out)[n])
 {
-  for (size_t i = 0; i < n; i++)
-    out[i] = ECC_GF28_multiply(in[i], s);
+  GF::Scale(in, s, out, n);
 };
 
 template <size_t n>
@@ -74,7 +74,7 @@ poly_copy(const uint8_t (&in)[n], uint8_t (&out)[n])
     out[i] = in[i];
 };
 
-template <size_t n>
+template <class GF, size_t n>
 uint8_t
 poly_evaluate(const uint8_t (&in)[n], uint8_t x)
 {
@@ -82,8 +82,8 @@ poly_evaluate(const uint8_t (&in)[n], uint8_t x)
   uint8_t r = in[0];
   
   for (size_t i = 1; i < n; i++) {
-    r ^= ECC_GF28_multiply(in[i], y);
-    y = ECC_GF28_multiply(y, x);
+    r ^= GF::Multiply(in[i], y);
+    y = GF::Multiply(y, x);
   }
   
   return r;
@@ -159,7 +159,9 @@ poly_evaluate(const uint8_t (&in)[n], uint8_t x)
 // value is true and the caller can find a root to the error-locator
 // polynomial within the code word size.
 //
-template <size_t kT>
+// GF - The field arithmetic to use.
+//
+template <size_t kT, class GF>
 bool
 RS_Solve(const uint8_t syndrome[2*kT], const uint8_t erasures[2*kT],
   size_t erasure_count, uint8_t (&r_sigma)[2*kT+1], uint8_t (&r_omega)[2*kT])
@@ -216,7 +218,7 @@ RS_Solve(const uint8_t syndrome[2*kT], const uint8_t erasures[2*kT],
       // Erasures processing. Get next erasure symbol and convert it
       // into a power of alpha.
       //
-      G = ECC_GF28_pow_alpha(erasures[p++]);
+      G = GF::PowAlpha(erasures[p++]);
       Z = 1;
     } else {
       //
@@ -235,11 +237,11 @@ RS_Solve(const uint8_t syndrome[2*kT], const uint8_t erasures[2*kT],
     uint8_t v_adjust[kTwoT+1];
     uint8_t x_adjust[kTwoT+1];
     if (first) {
-      poly_multiply_scalar<kTwoT+1>(V, Z, v_adjust);
-      poly_multiply_scalar<kTwoT+1>(X, Z, x_adjust);
+      poly_multiply_scalar<GF, kTwoT+1>(V, Z, v_adjust);
+      poly_multiply_scalar<GF, kTwoT+1>(X, Z, x_adjust);
     } else {
-      poly_multiply_scalar<kTwoT+1>(U, Z, v_adjust);
-      poly_multiply_scalar<kTwoT+1>(W, Z, x_adjust);
+      poly_multiply_scalar<GF, kTwoT+1>(U, Z, v_adjust);
+      poly_multiply_scalar<GF, kTwoT+1>(W, Z, x_adjust);
     }
     
     //
@@ -256,8 +258,8 @@ RS_Solve(const uint8_t syndrome[2*kT], const uint8_t erasures[2*kT],
     // Compute G z V(z) and
     //         G z X(z)
     //
-    poly_multiply_scalar<kTwoT+1>(new_V, G, new_V);
-    poly_multiply_scalar<kTwoT+1>(new_X, G, new_X);
+    poly_multiply_scalar<GF, kTwoT+1>(new_V, G, new_V);
+    poly_multiply_scalar<GF, kTwoT+1>(new_X, G, new_X);
     
     poly_add<kTwoT+1>(new_V, v_adjust, new_V);
     poly_add<kTwoT+1>(new_X, x_adjust, new_X);
@@ -287,9 +289,12 @@ RS_Solve(const uint8_t syndrome[2*kT], const uint8_t erasures[2*kT],
 };
 
 //
-// Document this.
+// Forney's formula: the value of the error at the position whose error
+// locator is 'location', given the error-locator and error-magnitude
+// polynomials that RS_Solve() found, worked out with the field
+// arithmetic 'GF'.
 //
-template <size_t kT>
+template <size_t kT, class GF>
 uint8_t
 RS_GetErrorAtLocation(const uint8_t (&sigma)[2*kT+1],
   const uint8_t (&omega)[2*kT], uint8_t location)
@@ -300,7 +305,7 @@ RS_GetErrorAtLocation(const uint8_t (&sigma)[2*kT+1],
   // Evaluate the top part of Forney's formula: send the error locator
   // through omega.
   //
-  uint8_t top = poly_evaluate<kTwoT>(omega, location);
+  uint8_t top = poly_evaluate<GF, kTwoT>(omega, location);
 
   // 
   // To complete the top of Forney's formula we must multiply the previous
@@ -340,24 +345,24 @@ RS_GetErrorAtLocation(const uint8_t (&sigma)[2*kT+1],
       // This is one of the coefficients we want to evaluate.
       // Multiply it by the current power of location.
       //
-      res ^= ECC_GF28_multiply(sigma[i], y);
+      res ^= GF::Multiply(sigma[i], y);
     }
     //
     // Increase the power of the location.
     //
-    y = ECC_GF28_multiply(y, location);
+    y = GF::Multiply(y, location);
   }
   
   //
   // Like the top portion, the bottom portion must be multiplied by a value.
   // In this case it is just the error position indicator.
   //
-  uint8_t bottom = ECC_GF28_multiply(res, location);
+  uint8_t bottom = GF::Multiply(res, location);
   
   //
   // The return value is the top value divided by the bottom value.
   //
-  return ECC_GF28_multiply(top, ECC_GF28_invert(bottom));
+  return GF::Multiply(top, GF::Invert(bottom));
 };
 
 #endif
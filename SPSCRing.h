@@ -0,0 +1,194 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_SPSC_RING_H
+#define RDAT_SPSC_RING_H
+
+#include <stddef.h>
+#include <sched.h>
+#include <time.h>
+
+//
+// A bounded, lock-free ring of slots between exactly one producing and
+// one consuming thread.
+//
+// Slots are filled and emptied in place: the producer reserves the next
+// free slot, fills it and publishes it; the consumer peeks at the
+// oldest published slot, uses it and consumes it. Each side keeps a
+// private copy of the other side's index and only refreshes it when the
+// ring looks full (or empty), so that the two sides rarely touch each
+// other's cache lines.
+//
+template <class T>
+class SPSCRing
+{
+public:
+  //
+  // Create a ring of 'capacity' slots, which must be a power of two.
+  //
+  SPSCRing(size_t capacity);
+  ~SPSCRing();
+
+  //
+  // Producer: the next free slot, or NULL if the ring is full.
+  //
+  T *Reserve();
+
+  //
+  // Producer: hand the reserved slot to the consumer.
+  //
+  void Publish();
+
+  //
+  // Consumer: the oldest published slot, or NULL if the ring is empty.
+  //
+  T *Peek();
+
+  //
+  // Consumer: hand the slot last peeked at back to the producer.
+  //
+  void Consume();
+
+  //
+  // The number of published slots not yet consumed. Only a snapshot;
+  // either side may be moving.
+  //
+  size_t Depth() const;
+
+  size_t Capacity() const { return mMask + 1; }
+
+  //
+  // Wait a little, for the other side to catch up. 'tries' counts the
+  // consecutive waits so far; the wait gets longer as it grows.
+  //
+  static void Backoff(unsigned int& tries);
+
+protected:
+  T *mSlots;
+  size_t mMask;
+
+  //
+  // Producer side: the index of the next slot to publish and the last
+  // consumer index seen.
+  //
+  char mPad0[64];
+  size_t mHead;
+  size_t mTailSeen;
+
+  //
+  // Consumer side: the index of the next slot to consume and the last
+  // producer index seen.
+  //
+  char mPad1[64];
+  size_t mTail;
+  size_t mHeadSeen;
+  char mPad2[64];
+};
+
+template <class T>
+SPSCRing<T>::SPSCRing(size_t capacity)
+  : mSlots(new T[capacity]), mMask(capacity - 1), mHead(0), mTailSeen(0),
+    mTail(0), mHeadSeen(0)
+{
+}
+
+template <class T>
+SPSCRing<T>::~SPSCRing()
+{
+  delete [] mSlots;
+}
+
+template <class T>
+inline T *
+SPSCRing<T>::Reserve()
+{
+  if (mHead - mTailSeen > mMask) {
+    mTailSeen = __atomic_load_n(&mTail, __ATOMIC_ACQUIRE);
+    if (mHead - mTailSeen > mMask)
+      return NULL;
+  }
+
+  return &mSlots[mHead & mMask];
+}
+
+template <class T>
+inline void
+SPSCRing<T>::Publish()
+{
+  __atomic_store_n(&mHead, mHead + 1, __ATOMIC_RELEASE);
+}
+
+template <class T>
+inline T *
+SPSCRing<T>::Peek()
+{
+  if (mTail == mHeadSeen) {
+    mHeadSeen = __atomic_load_n(&mHead, __ATOMIC_ACQUIRE);
+    if (mTail == mHeadSeen)
+      return NULL;
+  }
+
+  return &mSlots[mTail & mMask];
+}
+
+template <class T>
+inline void
+SPSCRing<T>::Consume()
+{
+  __atomic_store_n(&mTail, mTail + 1, __ATOMIC_RELEASE);
+}
+
+template <class T>
+inline size_t
+SPSCRing<T>::Depth() const
+{
+  size_t tail = __atomic_load_n(&mTail, __ATOMIC_ACQUIRE);
+  size_t head = __atomic_load_n(&mHead, __ATOMIC_ACQUIRE);
+
+  return head - tail;
+}
+
+//
+// Yield the processor for the first few tries, which is all it takes
+// when the other side is running, then sleep, so that a side with
+// nothing to do for a while doesn't keep a processor busy.
+//
+template <class T>
+void
+SPSCRing<T>::Backoff(unsigned int& tries)
+{
+  static const struct timespec kNap = { 0, 50000 };
+
+  if (tries++ < 16)
+    sched_yield();
+  else
+    nanosleep(&kNap, NULL);
+}
+
+#endif
@@ -0,0 +1,245 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include <stdint.h>
+#include <string.h>
+#include "SampleConverter.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//
+// Integer samples are scaled into [-1.0, 1.0).
+//
+static const float kScaleS8 = 1.0 / 128.0;
+static const float kScaleS16 = 1.0 / 32768.0;
+
+SampleConverter::SampleConverter()
+  : mFormat(FLOAT), mComplex(false), mChannel(0)
+{
+}
+
+bool
+SampleConverter::SetFormat(const char *name)
+{
+  bool complex = false;
+
+  if (name[0] == 'c') {
+    complex = true;
+    name++;
+  }
+
+  if (strcmp(name, "f32") == 0)
+    mFormat = FLOAT;
+  else if (strcmp(name, "s8") == 0)
+    mFormat = S8;
+  else if (strcmp(name, "s16le") == 0)
+    mFormat = S16LE;
+  else if (strcmp(name, "s16be") == 0)
+    mFormat = S16BE;
+  else
+    return false;
+
+  mComplex = complex;
+
+  return true;
+}
+
+bool
+SampleConverter::SetChannel(unsigned int channel)
+{
+  if (channel > 1)
+    return false;
+
+  mChannel = channel;
+
+  return true;
+}
+
+size_t
+SampleConverter::FrameSize() const
+{
+  size_t size;
+
+  switch (mFormat) {
+  case S8:
+    size = 1;
+    break;
+  case S16LE:
+  case S16BE:
+    size = 2;
+    break;
+  case FLOAT:
+  default:
+    size = sizeof(float);
+    break;
+  }
+
+  return mComplex ? size * 2 : size;
+}
+
+bool
+SampleConverter::IsNative() const
+{
+  return mFormat == FLOAT && !mComplex;
+}
+
+//
+// Conversion kernels. Each takes a pointer to the first sample frame,
+// the number of samples per frame (1 for real input, 2 for complex-
+// interleaved) and the channel within the frame to convert. The SSE2
+// variants handle the bulk of the buffer; the scalar loops finish the
+// tail and serve as the portable fallback, where the compiler is left
+// to vectorize them. Multi-byte samples are read little-endian unless
+// 'swap' is set.
+//
+
+static void
+ConvertFloat(const float *in, size_t stride, size_t channel, float *out,
+  size_t count)
+{
+  for (size_t i = 0; i < count; i++)
+    out[i] = in[i * stride + channel];
+}
+
+static void
+ConvertS8(const int8_t *in, size_t stride, size_t channel, float *out,
+  size_t count)
+{
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128 scale = _mm_set1_ps(kScaleS8);
+
+  if (stride == 1) {
+    for (; i + 16 <= count; i += 16) {
+      __m128i b = _mm_loadu_si128((const __m128i *) &in[i]);
+      //
+      // Sign-extend by placing each byte in the top of a wider lane
+      // and shifting it back down arithmetically.
+      //
+      __m128i lo = _mm_srai_epi16(_mm_unpacklo_epi8(b, b), 8);
+      __m128i hi = _mm_srai_epi16(_mm_unpackhi_epi8(b, b), 8);
+      _mm_storeu_ps(&out[i + 0], _mm_mul_ps(scale, _mm_cvtepi32_ps(
+        _mm_srai_epi32(_mm_unpacklo_epi16(lo, lo), 16))));
+      _mm_storeu_ps(&out[i + 4], _mm_mul_ps(scale, _mm_cvtepi32_ps(
+        _mm_srai_epi32(_mm_unpackhi_epi16(lo, lo), 16))));
+      _mm_storeu_ps(&out[i + 8], _mm_mul_ps(scale, _mm_cvtepi32_ps(
+        _mm_srai_epi32(_mm_unpacklo_epi16(hi, hi), 16))));
+      _mm_storeu_ps(&out[i + 12], _mm_mul_ps(scale, _mm_cvtepi32_ps(
+        _mm_srai_epi32(_mm_unpackhi_epi16(hi, hi), 16))));
+    }
+  } else {
+    //
+    // Complex-interleaved. Each I/Q pair is a 16-bit lane; I is the low
+    // byte and Q the high byte.
+    //
+    for (; i + 8 <= count; i += 8) {
+      __m128i b = _mm_loadu_si128((const __m128i *) &in[i * 2]);
+      __m128i w = channel ? _mm_srai_epi16(b, 8)
+                          : _mm_srai_epi16(_mm_slli_epi16(b, 8), 8);
+      _mm_storeu_ps(&out[i + 0], _mm_mul_ps(scale, _mm_cvtepi32_ps(
+        _mm_srai_epi32(_mm_unpacklo_epi16(w, w), 16))));
+      _mm_storeu_ps(&out[i + 4], _mm_mul_ps(scale, _mm_cvtepi32_ps(
+        _mm_srai_epi32(_mm_unpackhi_epi16(w, w), 16))));
+    }
+  }
+#endif
+
+  for (; i < count; i++)
+    out[i] = in[i * stride + channel] * kScaleS8;
+}
+
+static void
+ConvertS16(const uint8_t *in, size_t stride, size_t channel, bool swap,
+  float *out, size_t count)
+{
+  size_t i = 0;
+
+#if defined(__SSE2__)
+  const __m128 scale = _mm_set1_ps(kScaleS16);
+
+  if (stride == 1) {
+    for (; i + 8 <= count; i += 8) {
+      __m128i w = _mm_loadu_si128((const __m128i *) &in[i * 2]);
+      if (swap)
+        w = _mm_or_si128(_mm_slli_epi16(w, 8), _mm_srli_epi16(w, 8));
+      _mm_storeu_ps(&out[i + 0], _mm_mul_ps(scale, _mm_cvtepi32_ps(
+        _mm_srai_epi32(_mm_unpacklo_epi16(w, w), 16))));
+      _mm_storeu_ps(&out[i + 4], _mm_mul_ps(scale, _mm_cvtepi32_ps(
+        _mm_srai_epi32(_mm_unpackhi_epi16(w, w), 16))));
+    }
+  } else {
+    //
+    // Complex-interleaved. Each I/Q pair is a 32-bit lane; I is the low
+    // half and Q the high half.
+    //
+    for (; i + 4 <= count; i += 4) {
+      __m128i w = _mm_loadu_si128((const __m128i *) &in[i * 4]);
+      if (swap)
+        w = _mm_or_si128(_mm_slli_epi16(w, 8), _mm_srli_epi16(w, 8));
+      w = channel ? _mm_srai_epi32(w, 16)
+                  : _mm_srai_epi32(_mm_slli_epi32(w, 16), 16);
+      _mm_storeu_ps(&out[i], _mm_mul_ps(scale, _mm_cvtepi32_ps(w)));
+    }
+  }
+#endif
+
+  for (; i < count; i++) {
+    const uint8_t *p = &in[(i * stride + channel) * 2];
+    int16_t v;
+    if (swap)
+      v = (int16_t) ((p[0] << 8) | p[1]);
+    else
+      v = (int16_t) (p[0] | (p[1] << 8));
+    out[i] = v * kScaleS16;
+  }
+}
+
+void
+SampleConverter::Convert(const void *in, float *out, size_t count) const
+{
+  size_t stride = mComplex ? 2 : 1;
+  size_t channel = mComplex ? mChannel : 0;
+
+  switch (mFormat) {
+  case FLOAT:
+    ConvertFloat((const float *) in, stride, channel, out, count);
+    break;
+  case S8:
+    ConvertS8((const int8_t *) in, stride, channel, out, count);
+    break;
+  case S16LE:
+    ConvertS16((const uint8_t *) in, stride, channel, false, out, count);
+    break;
+  case S16BE:
+    ConvertS16((const uint8_t *) in, stride, channel, true, out, count);
+    break;
+  }
+}
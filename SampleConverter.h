@@ -0,0 +1,85 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#ifndef RDAT_SAMPLE_CONVERTER_H
+#define RDAT_SAMPLE_CONVERTER_H
+
+#include <stddef.h>
+
+//
+// Converts raw capture samples, in whatever format the digitizer
+// produced them, into the normalized floats the decoders expect.
+//
+class SampleConverter
+{
+public:
+  enum Format {
+    FLOAT,      // Native-endian IEEE float
+    S8,         // Signed 8-bit
+    S16LE,      // Signed 16-bit, little-endian
+    S16BE,      // Signed 16-bit, big-endian
+  };
+
+  SampleConverter();
+
+  //
+  // Select the input format by name: "f32", "s8", "s16le" or "s16be".
+  // A "c" prefix (e.g. "cs16le") selects complex-interleaved I/Q
+  // samples, of which only one channel is decoded.
+  //
+  bool SetFormat(const char *name);
+
+  //
+  // Select which channel of a complex-interleaved stream to decode.
+  // 0 is I, 1 is Q.
+  //
+  bool SetChannel(unsigned int channel);
+
+  //
+  // The size, in bytes, of one input sample frame.
+  //
+  size_t FrameSize() const;
+
+  //
+  // Is the input already in the decoder's native format? If so it can
+  // be handed to the decoder without conversion.
+  //
+  bool IsNative() const;
+
+  //
+  // Convert 'count' frames from 'in' into 'out'.
+  //
+  void Convert(const void *in, float *out, size_t count) const;
+
+protected:
+  Format mFormat;
+  bool mComplex;
+  unsigned int mChannel;
+};
+
+#endif
@@ -30,6 +30,9 @@
 #ifndef SYMBOL_DECODER_H
 #define SYMBOL_DECODER_H
 
+#include <stdint.h>
+#include <stddef.h>
+
 class SymbolDecoder
 {
 protected:
@@ -52,6 +55,22 @@ public:
   // Called by a lower-level bit slicer when it decodes a bit.
   //
   virtual void ReceiveBit(bool bit) = 0;
+
+  //
+  // Called by a lower-level bit slicer to deliver a batch of decoded bits
+  // at once. The bits are packed into the low 'count' (1-64) bits of
+  // 'bits', earliest bit most significant. Clock and track events always
+  // fall between batches, so a slicer must deliver any bits it has
+  // pending before raising one.
+  //
+  // Decoders that can work on whole words should override this; the
+  // default simply hands the bits over one at a time.
+  //
+  virtual void ReceiveBits(uint64_t bits, size_t count)
+  {
+    for (size_t i = count; i > 0; i--)
+      ReceiveBit((bits >> (i - 1)) & 1);
+  };
   
   //
   // Is there sufficient reason to believe that a pre-amble sequence
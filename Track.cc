@@ -28,46 +28,65 @@
 //
 
 #include <stdio.h>
+#include <string.h>
 #include "Track.h"
 #include "ECC_C1.h"
 #include "ECC_C2.h"
 #include "ECCFill_C1.h"
 #include "ECCFill_C2.h"
+#include "ECC_Batch.h"
 
 static bool BlockHeaderIsValid(const DATBlock& block);
 
 Track::Track(Head head)
-  : mHead(head), mHaveLastBlock(false), mC1Errors(0), mC1UncorrectableErrors(0),
-    mC2UncorrectableErrors(0), mHaveControlID(false), mHaveDataID(false)
+  : mNextFree(NULL)
 {
-  int i, j;
-  
   //
-  // Invalidate all parsed sub-codes.
+  // Everything needs clearing the first time.
   //
-  for (i = 0; i < 16; i++)
-    mSubcodeIsValid[i] = false;
-  
+  mDirtyBlocks.Fill(true);
+  Reset(head);
+}
+
+Track::~Track()
+{
+}
+
+void
+Track::Reset(Head head)
+{
+  mHead = head;
+  mATF2Count = 0;
+  mATF3Count = 0;
+  mHaveLastBlock = false;
+  mC1Errors = 0;
+  mC1UncorrectableErrors = 0;
+  mC2UncorrectableErrors = 0;
+  mExtraPasses = 0;
+  mReliabilityRescues = 0;
+  mHaveControlID = false;
+  mHaveDataID = false;
+
   //
-  // Invalidate the sub-code signature.
+  // Invalidate all parsed sub-codes, the sub-code signature and all
+  // blocks.
   //
-  for (i = 0; i < 7; i++)
-    mSubcodeSignature[i] = 0;
-  
+  memset(mSubcodeIsValid, 0, sizeof(mSubcodeIsValid));
+  memset(mSubcodeSignature, 0, sizeof(mSubcodeSignature));
+  memset(mHeaderIsValid, 0, sizeof(mHeaderIsValid));
+  memset(mBlockIsGuessed, 0, sizeof(mBlockIsGuessed));
+  mDataIsValid.Fill(false);
+
   //
-  // Invalidate all blocks.
+  // Clear the data of just the blocks that have been written.
   //
-  for (i = 0; i < kBlocks; i++) {
-    for (j = 0; j < kBlockSize; j++) {
-      mDataIsValid[i][j] = false;
-      mData[i][j] = 0;
-    }
-    mHeaderIsValid[i] = false;
-  }
-}
+  for (size_t w = 0; w < mDirtyBlocks.kWords; w++) {
+    uint64_t dirty = mDirtyBlocks.Word(w);
 
-Track::~Track()
-{
+    for (; dirty != 0; dirty &= dirty - 1)
+      memset(mData[w * 64 + __builtin_ctzll(dirty)], 0, kBlockSize);
+  }
+  mDirtyBlocks.Fill(false);
 }
 
 Track::Head
@@ -82,6 +101,25 @@ Track::SetHead(Head head)
   mHead = head;
 }
 
+void
+Track::SetATFCounts(int atf2, int atf3)
+{
+  mATF2Count = atf2;
+  mATF3Count = atf3;
+}
+
+int
+Track::ATF2Count() const
+{
+  return mATF2Count;
+}
+
+int
+Track::ATF3Count() const
+{
+  return mATF3Count;
+}
+
 void
 Track::AddBlock(const DATBlock& block)
 {
@@ -157,9 +195,17 @@ Track::HeaderValid() const
   return mHeaderIsValid;
 }
 
+const Track::ReliabilityArray&
+Track::Reliability() const
+{
+  return mReliability;
+}
+
 Track::DataArray&
 Track::ModifiableData()
 {
+  mDirtyBlocks.Fill(true);
+
   return mData;
 }
 
@@ -176,22 +222,141 @@ Track::SubcodeSignature() const
 }
 
 //
-// Track is supposedly complete.
-// Correct errors and evaluate sub-codes.
+// The C1 and C2 codewords of a track, each corrected as a batch.
+//
+typedef ECC_Batch<ECC_C1, ECCFill_C1::kVectors, Track::ValidityArray>
+  C1Batch;
+typedef ECC_Batch<ECC_C2, ECCFill_C2::kVectors, Track::ValidityArray>
+  C2Batch;
+
+//
+// The gather maps for the C1 and C2 codewords of a track. The layout
+// is the same for every track, so the maps are built, from the fill
+// iterators, with whichever track comes first.
 //
+static const C1Batch::Map&
+C1Map(Track& track)
+{
+  static const C1Batch::Map map(ECCFill_C1(track),
+    &track.ModifiableData()[0][0]);
+
+  return map;
+}
+
+static const C2Batch::Map&
+C2Map(Track& track)
+{
+  static const C2Batch::Map map(ECCFill_C2(track),
+    &track.ModifiableData()[0][0]);
+
+  return map;
+}
+
+//
+// The most passes of error correction each track gets.
+//
+static unsigned int gCorrectionPasses = 1;
+
 void
-Track::Complete()
+Track::SetCorrectionPasses(unsigned int passes)
+{
+  if (passes < 1)
+    passes = 1;
+  if (passes > kMaxCorrectionPasses)
+    passes = kMaxCorrectionPasses;
+
+  gCorrectionPasses = passes;
+}
+
+unsigned int
+Track::CorrectionPasses()
+{
+  return gCorrectionPasses;
+}
+
+//
+// The most times C2 retries each codeword with reliability erasures.
+//
+static unsigned int gReliabilityTrials = 0;
+
+void
+Track::SetReliabilityTrials(unsigned int trials)
+{
+  gReliabilityTrials = trials;
+}
+
+unsigned int
+Track::ReliabilityTrials()
+{
+  return gReliabilityTrials;
+}
+
+//
+// How much trust a byte loses for each sign of trouble.
+//
+static const uint8_t kUndecodedDoubt = 3;
+static const uint8_t kGuessedBlockDoubt = 2;
+static const uint8_t kC1CorrectionDoubt = 2;
+
+static void
+Distrust(uint8_t& reliability, size_t doubt)
+{
+  reliability = reliability > doubt ? reliability - doubt : 0;
+}
+
+void
+Track::AssessReliability()
+{
+  uint8_t *reliability = &mReliability[0][0];
+
+  memset(mReliability, kReliable, sizeof(mReliability));
+
+  for (size_t b = 0; b < kBlocks; b++)
+    if (mBlockIsGuessed[b])
+      memset(mReliability[b], kReliable - kGuessedBlockDoubt, kBlockSize);
+
+  //
+  // The bytes marked invalid now are the ones whose ten-bit words didn't
+  // decode (or that never arrived). They are erasures to begin with, but
+  // C1 may yet fill some of them in.
+  //
+  for (size_t w = 0; w < ValidityArray::kWords; w++) {
+    uint64_t clear = ~mDataIsValid.Word(w);
+
+    for (; clear != 0; clear &= clear - 1) {
+      const size_t i = w * 64 + __builtin_ctzll(clear);
+      if (i < ValidityArray::kSize)
+        Distrust(reliability[i], kUndecodedDoubt);
+    }
+  }
+}
+
+void
+Track::CorrectC1()
 {
   ECC_C1 Vp;
+  const C1Batch::Map& map = C1Map(*this);
+  C1Batch c1_batch(map, &mData[0][0], mDataIsValid);
+
+  //
+  // Most vectors come in good. Gather all of them and compute their
+  // syndromes at once to find out which ones don't.
+  //
+  c1_batch.Screen();
     
   //
   // Iterate over each pair of blocks, correcting the C1 errors in each.
   //
-  for (ECCFill_C1 c1_fill(*this); !c1_fill.End(); c1_fill.Next()) {
+  for (size_t k = 0; k < c1_batch.Count(); k++) {
+    if (!c1_batch.NeedsCorrection(k))
+      continue;
+
+    C1Batch::Vector c1_fill(c1_batch, k);
+
     //
-    // Fill the error check vector.
+    // Fill the error check vector from what the screen gathered.
     //
-    Vp.Fill(c1_fill);
+    Vp.Fill(c1_batch, k);
     
     //
     // Detect errors in this vector and correct them.
@@ -213,20 +378,156 @@ Track::Complete()
       //
       mC1Errors++;
       Vp.Dump(c1_fill);
+
+      //
+      // The more bytes C1 had to change, the more likely it is to have
+      // picked the wrong codeword. (A correction can also land in a block
+      // that was never filled, so mark the blocks dirty.)
+      //
+      for (size_t i = 0; i < ECC_C1::kN; i++) {
+        Distrust((&mReliability[0][0])[map.Offset(i, k)],
+          Vp.Corrections() * kC1CorrectionDoubt);
+        mDirtyBlocks.Set(map.Offset(i, k) / kBlockSize, true);
+      }
       break;
     }
   }
+}
+
+//
+// How many of a codeword's bytes a correction changed that weren't
+// marked as erasures ('erased' has bit i set if byte i was). Each such
+// error cost the decoder two check bytes to find, where an erasure costs
+// one.
+//
+template <class Vector, size_t N>
+static size_t
+LocatedErrors(Vector& fill, const uint8_t (&before)[N], uint64_t erased)
+{
+  size_t errors = 0;
+
+  for (size_t i = 0; i < N; i++)
+    if (((erased >> i) & 1) == 0 && fill.Data(i) != before[i])
+      errors++;
+
+  return errors;
+}
+
+//
+// Put a codeword back as it was before a correction that isn't wanted.
+//
+template <class Vector, size_t N>
+static void
+Restore(Vector& fill, const uint8_t (&before)[N], uint64_t erased)
+{
+  for (size_t i = 0; i < N; i++) {
+    fill.Data(i) = before[i];
+    fill.SetValid(i, ((erased >> i) & 1) == 0);
+  }
+}
+
+//
+// Retry a C2 codeword that couldn't be corrected, with its least
+// reliable bytes treated as erasures too: the least reliable one, then
+// the two least reliable, and so on. Only bytes that have lost some
+// trust are candidates. A trial only counts if it leaves at least one
+// check byte spare -- the erasures, forced or not, and twice the errors
+// the decoder found besides, must come to less than the number of check
+// bytes -- so that a wrong guess is caught rather than "corrected".
+// Returns true, with the codeword corrected, if one of the trials worked.
+//
+static bool
+RetryC2(ECC_C2& Vq, C2Batch::Vector& c2_fill,
+  const uint8_t (&reliability)[ECC_C2::kN], size_t& budget)
+{
+  size_t order[ECC_C2::kN];
+  uint8_t before[ECC_C2::kN];
+  uint64_t erased = 0;
+  size_t candidates = 0, erasures = 0;
 
   //
-  // Now iterate over each block 4-group to perform C2 error correction.
+  // Sort the candidates, least reliable first.
   //
+  for (size_t i = 0; i < ECC_C2::kN; i++) {
+    before[i] = c2_fill.Data(i);
+    if (!c2_fill.Valid(i)) {
+      erased |= (uint64_t) 1 << i;
+      erasures++;
+      continue;
+    }
+    if (reliability[i] >= Track::kReliable)
+      continue;
+
+    size_t n = candidates++;
+    for (; n > 0 && reliability[order[n - 1]] > reliability[i]; n--)
+      order[n] = order[n - 1];
+    order[n] = i;
+  }
+
+  if (erasures + 1 >= ECC_C2::kTwoT)
+    return false;
+
+  size_t trials = ECC_C2::kTwoT - 1 - erasures;
+  if (trials > candidates)
+    trials = candidates;
+  if (trials > gReliabilityTrials)
+    trials = gReliabilityTrials;
+
+  for (size_t n = 1; n <= trials && budget > 0; n++) {
+    budget--;
+
+    uint64_t forced = erased;
+    for (size_t j = 0; j < n; j++) {
+      c2_fill.SetValid(order[j], false);
+      forced |= (uint64_t) 1 << order[j];
+    }
+
+    Vq.Fill(c2_fill);
+    if (Vq.Correct() == ECC_C2::CORRECTED) {
+      Vq.Dump(c2_fill);
+      if (erasures + n + 2 * LocatedErrors(c2_fill, before, forced) <
+          ECC_C2::kTwoT)
+        return true;
+      Restore(c2_fill, before, erased);
+      continue;
+    }
+
+    for (size_t j = 0; j < n; j++)
+      c2_fill.SetValid(order[j], true);
+  }
+
+  return false;
+}
+
+size_t
+Track::CorrectC2(size_t& budget)
+{
   ECC_C2 Vq;
+  const C2Batch::Map& map = C2Map(*this);
+  C2Batch c2_batch(map, &mData[0][0], mDataIsValid);
+  size_t uncorrectable = 0;
+
+  c2_batch.Screen();
+
+  for (size_t k = 0; k < c2_batch.Count(); k++) {
+    if (!c2_batch.NeedsCorrection(k))
+      continue;
+
+    if (budget == 0) {
+      //
+      // No time left to look at this one.
+      //
+      uncorrectable++;
+      continue;
+    }
+    budget--;
+
+    C2Batch::Vector c2_fill(c2_batch, k);
 
-  for (ECCFill_C2 c2_fill(*this); !c2_fill.End(); c2_fill.Next()) {
     //
-    // Fill the error check vector.
-    //      
-    Vq.Fill(c2_fill);
+    // Fill the error check vector from what the screen gathered.
+    //
+    Vq.Fill(c2_batch, k);
 
     //
     // Detect errors in this vector and correct them.
@@ -241,24 +542,286 @@ Track::Complete()
     case ECC_C2::CORRECTED:
       //
       // There were errors but they were corrected.
-      // Put the corrected data back into the track.
+      // Put the corrected data back into the track. (C2 codewords run
+      // through every block, so now any of them may hold data.)
       //
       Vq.Dump(c2_fill);
+      mDirtyBlocks.Fill(true);
       break;
     case ECC_C2::UNCORRECTABLE:
       //
-      // Slice was uncorrectable. Leave it as is. The next level of
-      // error handling (interpolation for Audio, C3 for DDS) will have
-      // to deal with it.
+      // Slice was uncorrectable. Maybe some of the bytes it was given as
+      // good are not; if allowed, try again without the least reliable
+      // of them.
+      //
+      if (gReliabilityTrials > 0) {
+        uint8_t reliability[ECC_C2::kN];
+
+        for (size_t i = 0; i < ECC_C2::kN; i++)
+          reliability[i] = (&mReliability[0][0])[map.Offset(i, k)];
+        if (RetryC2(Vq, c2_fill, reliability, budget)) {
+          mReliabilityRescues++;
+          mDirtyBlocks.Fill(true);
+          break;
+        }
+      }
+
+      //
+      // Leave it as is. The next level of error handling (interpolation
+      // for Audio, C3 for DDS) will have to deal with it.
       //
-      mC2UncorrectableErrors++;
+      uncorrectable++;
+      break;
+    }
+  }
+
+  return uncorrectable;
+}
+
+//
+// The C1 parity bytes sit at the end of each odd block, outside of every
+// C2 codeword.
+//
+static bool
+IsC1Parity(size_t offset)
+{
+  size_t block = offset / Track::kBlockSize;
+  size_t byte = offset % Track::kBlockSize;
+
+  return (block & 1) != 0 && byte >= ECCFill_C2::kBytesOddGroup;
+}
+
+bool
+Track::RecoverC1(size_t& budget)
+{
+  //
+  // By now every byte is either trusted or marked, just as C2 expects its
+  // input to be, so C1 can decode with the erasures too.
+  //
+  typedef ECC_Vector<ECC_C1::Code, ECC_USE_ERASURES> C1WithErasures;
+  C1WithErasures Vp;
+  const C1Batch::Map& map = C1Map(*this);
+  C1Batch c1_batch(map, &mData[0][0], mDataIsValid);
+
+  c1_batch.Screen();
+
+  for (size_t k = 0; k < c1_batch.Count(); k++) {
+    if (!c1_batch.Erased(k))
+      continue;
+
+    if (budget == 0)
+      return false;
+    budget--;
+
+    C1Batch::Vector c1_fill(c1_batch, k);
+    bool parityValid[C1WithErasures::kN];
+    uint8_t before[C1WithErasures::kN];
+    uint64_t erased = 0;
+    size_t erasures = 0;
+
+    //
+    // No C2 pass will ever vouch for the parity bytes; they are marked
+    // only because the first C1 pass gave up on this codeword. Offer them
+    // to the decoder as plain symbols, as that first pass did.
+    //
+    for (size_t i = 0; i < C1WithErasures::kN; i++) {
+      if (IsC1Parity(map.Offset(i, k))) {
+        parityValid[i] = c1_fill.Valid(i);
+        c1_fill.SetValid(i, true);
+      } else if (!c1_fill.Valid(i)) {
+        erased |= (uint64_t) 1 << i;
+        erasures++;
+      }
+      before[i] = c1_fill.Data(i);
+    }
+
+    //
+    // Leave at least one check byte spare, so that a codeword which is
+    // still wrong gets caught rather than "corrected" into garbage: the
+    // erasures, and twice the errors the decoder had to find besides,
+    // must come to less than the number of check bytes. Only take the
+    // result if it worked; a failure would mark the whole codeword bad,
+    // throwing away the bytes C2 has made good.
+    //
+    Vp.Fill(c1_fill);
+    if (erasures < C1WithErasures::kTwoT &&
+        Vp.Correct() == C1WithErasures::CORRECTED) {
+      Vp.Dump(c1_fill);
+      if (erasures + 2 * LocatedErrors(c1_fill, before, erased) <
+          C1WithErasures::kTwoT) {
+        for (size_t i = 0; i < C1WithErasures::kN; i++) {
+          Distrust((&mReliability[0][0])[map.Offset(i, k)],
+            Vp.Corrections() * kC1CorrectionDoubt);
+          mDirtyBlocks.Set(map.Offset(i, k) / kBlockSize, true);
+        }
+        continue;
+      }
+      Restore(c1_fill, before, erased);
+    }
+
+    for (size_t i = 0; i < C1WithErasures::kN; i++)
+      if (IsC1Parity(map.Offset(i, k)))
+        c1_fill.SetValid(i, parityValid[i]);
+  }
+
+  return true;
+}
+
+void
+Track::CorrectIteratively()
+{
+  size_t budget = kExtraDecodeBudget;
+  size_t erased = ErasedBytes();
+
+  while (mExtraPasses + 1 < gCorrectionPasses && mC2UncorrectableErrors > 0) {
+    bool finished = RecoverC1(budget);
+    mC2UncorrectableErrors = CorrectC2(budget);
+
+    size_t remaining = ErasedBytes();
+    mRescuedBytes[mExtraPasses++] = erased - remaining;
+
+    if (!finished || budget == 0 || remaining == erased)
       break;
+    erased = remaining;
+  }
+}
+
+size_t
+Track::ErasedBytes() const
+{
+  return ValidityArray::kSize - mDataIsValid.Count();
+}
+
+//
+// Track is supposedly complete.
+// Correct errors and evaluate sub-codes.
+//
+void
+Track::Complete()
+{
+  //
+  // First C1, then C2 over what it leaves.
+  //
+  AssessReliability();
+  CorrectC1();
+  CompleteC2();
+}
+
+void
+Track::CompleteC1()
+{
+  AssessReliability();
+  CorrectC1();
+  ParseSubcodes();
+}
+
+void
+Track::CompleteC2()
+{
+  size_t budget = (size_t) -1;
+
+  mC2UncorrectableErrors = CorrectC2(budget);
+
+  //
+  // Then, if asked, feed what C2 made good back through C1, and so on.
+  //
+  CorrectIteratively();
+
+  //
+  // Error correction is complete. Now gather data from the sub-code blocks.
+  //
+  ParseSubcodes();
+}
+
+void
+Track::Fuse(const Track *const *reads, size_t count)
+{
+  const size_t kBytes = ValidityArray::kSize;
+  uint8_t *data = &mData[0][0];
+  uint8_t *reliability = &mReliability[0][0];
+
+  //
+  // The error counts are taken to be those of the best read, and the head
+  // and ATF counts those of the first one that knows its head.
+  //
+  const Track *best = reads[0];
+  const Track *headed = reads[0];
+  for (size_t r = 1; r < count; r++) {
+    if (reads[r]->mC1UncorrectableErrors < best->mC1UncorrectableErrors)
+      best = reads[r];
+    if (headed->mHead == HEAD_UNKNOWN)
+      headed = reads[r];
+  }
+  mC1Errors = best->mC1Errors;
+  mC1UncorrectableErrors = best->mC1UncorrectableErrors;
+  mHead = headed->mHead;
+  mATF2Count = headed->mATF2Count;
+  mATF3Count = headed->mATF3Count;
+
+  //
+  // Take each block header from the first read that had it whole.
+  //
+  for (size_t b = 0; b < kBlocks; b++) {
+    mHeaderIsValid[b] = false;
+    mBlockIsGuessed[b] = false;
+    for (size_t r = 0; r < count && !mHeaderIsValid[b]; r++) {
+      mHeader[b] = reads[r]->mHeader[b];
+      mHeaderIsValid[b] = reads[r]->mHeaderIsValid[b];
+      mBlockIsGuessed[b] = reads[r]->mBlockIsGuessed[b];
     }
   }
 
   //
-  // Error correction is complete. Now dather data from the sub-code blocks.
+  // Vote on every byte. A byte that no read got is carried over from the
+  // first read, still erased.
   //
+  for (size_t i = 0; i < kBytes; i++) {
+    uint8_t value[kMaxFusedReads];
+    size_t weight[kMaxFusedReads];
+    size_t values = 0, total = 0, winner = 0;
+
+    for (size_t r = 0; r < count; r++) {
+      if (!reads[r]->mDataIsValid.Test(i))
+        continue;
+
+      const uint8_t byte = (&reads[r]->mData[0][0])[i];
+      const size_t w = (&reads[r]->mReliability[0][0])[i] + 1;
+      size_t v;
+
+      for (v = 0; v < values && value[v] != byte; v++)
+        ;
+      if (v == values) {
+        value[values] = byte;
+        weight[values++] = 0;
+      }
+      weight[v] += w;
+      total += w;
+      if (weight[v] > weight[winner])
+        winner = v;
+    }
+
+    if (values == 0) {
+      data[i] = (&reads[0]->mData[0][0])[i];
+      mDataIsValid.Set(i, false);
+      reliability[i] = 0;
+      continue;
+    }
+
+    const size_t rest = total - weight[winner];
+    const size_t margin = weight[winner] > rest ? weight[winner] - rest : 0;
+
+    data[i] = value[winner];
+    mDataIsValid.Set(i, margin > 0);
+    reliability[i] = margin == 0 ? 0 :
+                     margin - 1 > kReliable ? kReliable : margin - 1;
+  }
+
+  mDirtyBlocks.Fill(true);
+}
+
+void
+Track::ParseSubcodes()
+{
   //
   // Now all the sub-code blocks have had as much error correction applied
   // as they ever will. Build the sub-code signature.
@@ -300,12 +863,13 @@ Track::Complete()
       // Point straight at the 8-byte item.
       //
       const uint8_t *item = &(mData[block_number][8*j]);
-      const bool    *validity = &(mDataIsValid[block_number][8*j]);
+      const uint64_t validity =
+        mDataIsValid.Get(block_number * kBlockSize + 8*j, 8);
 
       //
       // What's the sub-code id?
       //
-      if (!validity[0])
+      if ((validity & 1) == 0)
         //
         // Sub-code id byte isn't even valid. Don't bother.
         //
@@ -327,14 +891,11 @@ Track::Complete()
       // are no erasure symbols here.
       //
       uint8_t parity;
-      bool valid;
       size_t k;
-      for (k = 0, parity = 0, valid = true; k < 8; k++) {
+      for (k = 0, parity = 0; k < 8; k++)
         parity ^= item[k] & 0xff;
-        valid = valid && validity[k];
-      }
 
-      if (!valid || parity != 0)
+      if (validity != 0xff || parity != 0)
         //
         // Item parity or validity is bad.
         //
@@ -387,6 +948,7 @@ Track::AddVerifiedBlock(const DATBlock& block)
   //
   mHeader[block_number] = bytes[1] & 0xff;
   mHeaderIsValid[block_number] = true;
+  mBlockIsGuessed[block_number] = false;
   mHaveLastBlock = true;
   mLastBlockNumber = block_number;
   
@@ -400,6 +962,7 @@ void
 Track::AddGuessedBlock(uint8_t block_number, const DATBlock& block)
 {
   mHeaderIsValid[block_number] = false;
+  mBlockIsGuessed[block_number] = true;
   DataFill(block_number, block);
 }
 
@@ -420,10 +983,13 @@ Track::DataFill(uint8_t block_number, const DATBlock& block)
     count = 32;
   
   const uint16_t *bytes = block.FlaggedBytes();
+  uint64_t valid = 0;
   for (size_t i = 0; i < count; i++) {
     mData[block_number][i] = bytes[i+4] & 0xff;
-    mDataIsValid[block_number][i] = (bytes[i+4] & 0x8000) == 0;
+    valid |= (uint64_t) ((bytes[i+4] & 0x8000) == 0) << i;
   }
+  mDataIsValid.Put(block_number * kBlockSize, count, valid);
+  mDirtyBlocks.Set(block_number, true);
 }
 
 static bool
@@ -502,3 +1068,21 @@ Track::C2UncorrectableErrors() const
 {
   return mC2UncorrectableErrors;
 }
+
+unsigned int
+Track::ExtraPasses() const
+{
+  return mExtraPasses;
+}
+
+size_t
+Track::RescuedBytes(unsigned int pass) const
+{
+  return pass < mExtraPasses ? mRescuedBytes[pass] : 0;
+}
+
+size_t
+Track::ReliabilityRescues() const
+{
+  return mReliabilityRescues;
+}
@@ -32,6 +32,7 @@
 
 #include <stdint.h>
 #include "DATBlock.h"
+#include "BitMask.h"
 
 //
 // A track is a collection of data that is read with one swipe of the
@@ -63,6 +64,14 @@ public:
   Track(Head head);
   ~Track();
 
+  //
+  // Forget everything, ready to collect a new track read with 'head'.
+  // Only the blocks that have been written to need clearing, so this is
+  // much cheaper than making a new track. (TrackPool recycles tracks
+  // this way.)
+  //
+  void Reset(Head head);
+
   //
   // A track contains 144 data blocks, each 32 bytes long.
   // Each of these blocks also comes with a header byte.
@@ -73,13 +82,17 @@ public:
   // Blocks 0-127 are data blocks.
   // Blocks 128-143 are sub-code blocks.
   //
+  // The data byte indicators are packed as bits; byte 'i' of block 'b'
+  // is bit b * kBlockSize + i.
+  //
   static const unsigned int kBlocks = 144;
   static const unsigned int kBlockSize = 32;
 
   typedef uint8_t DataArray[kBlocks][kBlockSize];
   typedef uint8_t HeaderArray[kBlocks];
-  typedef bool    ValidityArray[kBlocks][kBlockSize];
+  typedef BitMask<kBlocks * kBlockSize> ValidityArray;
   typedef bool    HeaderValidityArray[kBlocks];
+  typedef uint8_t ReliabilityArray[kBlocks][kBlockSize];
   typedef uint8_t SubcodeSignatureArray[7];
 
   //
@@ -92,7 +105,34 @@ public:
   //
   void Complete();
 
+  //
+  // Complete() in two halves, for a track read more than once: C1 and the
+  // sub-codes (enough to tell which frame the track belongs to) for each
+  // read, and C2 for the track Fuse()d from them.
+  //
+  void CompleteC1();
+  void CompleteC2();
+
+  //
+  // Make this track the byte by byte consensus of 'count' (no more than
+  // kMaxFusedReads) reads of the same track, each of which has been
+  // through CompleteC1(). Each byte takes the value with the most
+  // reliability behind it amongst the reads in which it is valid, and is
+  // only valid itself if that outweighs the other values put together.
+  //
+  void Fuse(const Track *const *reads, size_t count);
+
+  static const size_t kMaxFusedReads = 8;
+
   void SetHead(Head head);
+
+  //
+  // Record how many of each automatic track finding (ATF) tone were
+  // heard while the track was being read.
+  //
+  void SetATFCounts(int atf2, int atf3);
+  int ATF2Count() const;
+  int ATF3Count() const;
   
   //
   // Get the contents of the specific sub-code, if it was correctly
@@ -114,6 +154,15 @@ public:
   DataArray& ModifiableData();
   ValidityArray& ModifiableDataValid();
 
+  //
+  // How far each byte can be trusted, from kReliable down to zero, as
+  // worked out during error correction: a byte loses some trust if its
+  // ten-bit word didn't decode, if its block header had to be guessed
+  // and for each byte that C1 had to correct in its codeword.
+  //
+  static const uint8_t kReliable = 8;
+  const ReliabilityArray& Reliability() const;
+
   //
   // Get the head/channel that this track was read from (if known).
   //             
@@ -132,8 +181,83 @@ public:
   // errors, so there's no use repeating that metric under another name).
   //
   size_t C2UncorrectableErrors() const;
+
+  //
+  // Error correction normally makes one C1 pass and one C2 pass. With
+  // more passes allowed, Complete() goes on alternating them -- C1 now
+  // filling in the erasures that C2 couldn't, and C2 then retrying with
+  // fewer erasures -- until a pass makes no progress, the passes run out
+  // or the track's budget of extra codeword decodes is spent. (The
+  // setting applies to every track; set it before decoding begins.)
+  //
+  static const unsigned int kMaxCorrectionPasses = 8;
+  static const unsigned int kExtraDecodeBudget = 1024;
+  static void SetCorrectionPasses(unsigned int passes);
+  static unsigned int CorrectionPasses();
+
+  //
+  // The number of passes beyond the first that were made, and the number
+  // of bytes the n'th of them (counting from zero) made good.
+  //
+  unsigned int ExtraPasses() const;
+  size_t RescuedBytes(unsigned int pass) const;
+
+  //
+  // When C2 can't correct a codeword, it can try again with the least
+  // reliable of its bytes treated as erasures (generalized minimum
+  // distance decoding): first the least reliable one, then the two
+  // least reliable, and so on, for up to 'trials' attempts per
+  // codeword. Zero, the default, turns this off. (The setting applies to
+  // every track; set it before decoding begins.)
+  //
+  static void SetReliabilityTrials(unsigned int trials);
+  static unsigned int ReliabilityTrials();
+
+  //
+  // The number of C2 codewords corrected by such retries.
+  //
+  size_t ReliabilityRescues() const;
    
 protected:
+  //
+  // Run C1 over every codeword that needs it, keeping count of the
+  // errors.
+  //
+  void CorrectC1();
+
+  //
+  // Run C2 over every codeword that needs it, spending no more than
+  // 'budget' codeword decodes. Returns the number of codewords that were
+  // left uncorrectable.
+  //
+  size_t CorrectC2(size_t& budget);
+
+  //
+  // Run C1 again, using the erasures as such this time, over every
+  // codeword that has some. Returns false if the budget ran out.
+  //
+  bool RecoverC1(size_t& budget);
+
+  //
+  // Alternate C1 recovery and C2 passes, as allowed.
+  //
+  void CorrectIteratively();
+
+  //
+  // The number of bytes currently marked invalid.
+  //
+  size_t ErasedBytes() const;
+
+  //
+  // Work out the reliability of the bytes as they were received.
+  //
+  void AssessReliability();
+
+  //
+  // Gather the sub-codes, control ID and data ID from the sub-code blocks.
+  //
+  void ParseSubcodes();
+
   //
   // Add the data bytes found inside this block.
   //
@@ -156,6 +280,12 @@ protected:
   // Which head this track was read from.
   //
   Head mHead;
+
+  //
+  // The number of ATF2 and ATF3 tones heard during the track.
+  //
+  int mATF2Count;
+  int mATF3Count;
   
   //
   // All of the sub-code packs that were read with this track.
@@ -210,6 +340,23 @@ protected:
   //
   HeaderValidityArray mHeaderIsValid;
 
+  //
+  // The blocks that were placed by guessing their block numbers.
+  //
+  bool mBlockIsGuessed[kBlocks];
+
+  //
+  // The reliability of each data byte.
+  //
+  ReliabilityArray mReliability;
+
+  //
+  // The blocks whose data may not be all zero: those that were filled,
+  // and every block once C2 has corrected something, or once the data
+  // has been handed out to be modified.
+  //
+  BitMask<kBlocks> mDirtyBlocks;
+
   //
   // The sequence number (block number) of the last block
   // we received.
@@ -223,6 +370,23 @@ protected:
   size_t mC1Errors;
   size_t mC1UncorrectableErrors;
   size_t mC2UncorrectableErrors;
+
+  //
+  // The passes made beyond the first, and what each one rescued.
+  //
+  unsigned int mExtraPasses;
+  size_t mRescuedBytes[kMaxCorrectionPasses];
+
+  //
+  // The C2 codewords rescued by retrying with reliability erasures.
+  //
+  size_t mReliabilityRescues;
+
+  //
+  // The next track in the TrackPool's free list, while this one is in it.
+  //
+  friend class TrackPool;
+  Track *mNextFree;
 };
 
 #endif
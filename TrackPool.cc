@@ -0,0 +1,140 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include <stdlib.h>
+#include <new>
+#include "TrackPool.h"
+
+TrackPool::TrackPool()
+  : mFree(NULL), mAllocated(0), mAvailable(0)
+{
+  pthread_mutex_init(&mLock, NULL);
+}
+
+TrackPool::~TrackPool()
+{
+  while (mFree != NULL) {
+    Track *track = mFree;
+    mFree = track->mNextFree;
+    track->~Track();
+    free(track);
+  }
+  pthread_mutex_destroy(&mLock);
+}
+
+Track *
+TrackPool::Allocate(Track::Head head)
+{
+  void *memory;
+
+  if (posix_memalign(&memory, kAlignment, sizeof(Track)) != 0)
+    abort();
+
+  return new (memory) Track(head);
+}
+
+Track *
+TrackPool::Get(Track::Head head)
+{
+  pthread_mutex_lock(&mLock);
+  Track *track = mFree;
+  if (track != NULL) {
+    mFree = track->mNextFree;
+    mAvailable--;
+  } else {
+    mAllocated++;
+  }
+  pthread_mutex_unlock(&mLock);
+
+  //
+  // Do the clearing (or allocating) outside of the lock.
+  //
+  if (track == NULL)
+    return Allocate(head);
+
+  track->mNextFree = NULL;
+  track->Reset(head);
+
+  return track;
+}
+
+void
+TrackPool::Put(Track *track)
+{
+  if (track == NULL)
+    return;
+
+  pthread_mutex_lock(&mLock);
+  track->mNextFree = mFree;
+  mFree = track;
+  mAvailable++;
+  pthread_mutex_unlock(&mLock);
+}
+
+void
+TrackPool::Reserve(size_t count)
+{
+  pthread_mutex_lock(&mLock);
+  while (mAvailable < count) {
+    Track *track = Allocate(Track::HEAD_UNKNOWN);
+    track->mNextFree = mFree;
+    mFree = track;
+    mAvailable++;
+    mAllocated++;
+  }
+  pthread_mutex_unlock(&mLock);
+}
+
+size_t
+TrackPool::Allocated() const
+{
+  pthread_mutex_lock(&mLock);
+  size_t allocated = mAllocated;
+  pthread_mutex_unlock(&mLock);
+
+  return allocated;
+}
+
+size_t
+TrackPool::Available() const
+{
+  pthread_mutex_lock(&mLock);
+  size_t available = mAvailable;
+  pthread_mutex_unlock(&mLock);
+
+  return available;
+}
+
+TrackPool&
+TrackPool::Shared()
+{
+  static TrackPool sShared;
+
+  return sShared;
+}
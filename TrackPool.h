@@ -0,0 +1,95 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_TRACK_POOL_H
+#define RDAT_TRACK_POOL_H
+
+#include <stddef.h>
+#include <pthread.h>
+#include "Track.h"
+
+//
+// A pool of tracks, recycled rather than freed.
+//
+// A track is a large object (several kilobytes of data, validity and
+// reliability) and the decoder goes through one per head swipe. Instead
+// of allocating each one afresh and zeroing all of it, finished tracks
+// are put back here and handed out again after a Track::Reset(), which
+// only clears the blocks that were written. Once the pool has grown to
+// the number of tracks in flight, decoding allocates nothing.
+//
+// Tracks are allocated on cache line boundaries, so that tracks being
+// worked on by different threads never share a line. The pool may be
+// used from any number of threads at once.
+//
+class TrackPool
+{
+public:
+  TrackPool();
+  ~TrackPool();
+
+  //
+  // A clean track read with 'head', from the pool if it has one.
+  //
+  Track *Get(Track::Head head);
+
+  //
+  // Return a track obtained from Get() to the pool. NULL is ignored.
+  //
+  void Put(Track *track);
+
+  //
+  // Make sure that at least 'count' tracks are waiting in the pool.
+  //
+  void Reserve(size_t count);
+
+  //
+  // The number of tracks the pool has allocated, and the number of them
+  // that are waiting in it.
+  //
+  size_t Allocated() const;
+  size_t Available() const;
+
+  //
+  // The pool shared by all of the decoding paths.
+  //
+  static TrackPool& Shared();
+
+  static const size_t kAlignment = 64;
+
+protected:
+  static Track *Allocate(Track::Head head);
+
+  mutable pthread_mutex_t mLock;
+  Track *mFree;
+  size_t mAllocated;
+  size_t mAvailable;
+};
+
+#endif
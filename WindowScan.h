@@ -0,0 +1,152 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_WINDOW_SCAN_H
+#define RDAT_WINDOW_SCAN_H
+
+#include <stddef.h>
+#include <float.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+//
+// Peak and valley search over a clock detector's phase window.
+//
+// On entry, 'max' and 'min' hold the values to start the search from
+// and 'maxI' the index to report if nothing beats 'max'. On return they
+// hold the highest value, the index of its first occurrence (strictly
+// greater than the starting value) and the lowest value, exactly as a
+// front-to-back scan would find them. NaNs are never chosen.
+//
+// The window size is a template parameter so that the common sizes
+// compile to straight-line code; ScanWindow(window, size, ...) picks the
+// right one at run time.
+//
+template <int N>
+inline void
+ScanWindow(const float *window, float& max, int& maxI, float& min)
+{
+#if defined(__SSE2__)
+  if (N % 4 == 0) {
+    __m128 hi = _mm_set1_ps(max);
+    __m128 lo = _mm_set1_ps(min);
+    int i;
+
+    //
+    // The running value must be the second operand, so that NaNs in the
+    // window are passed over.
+    //
+    for (i = 0; i < N; i += 4) {
+      __m128 w = _mm_loadu_ps(&window[i]);
+      hi = _mm_max_ps(w, hi);
+      lo = _mm_min_ps(w, lo);
+    }
+    hi = _mm_max_ps(hi, _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(1, 0, 3, 2)));
+    hi = _mm_max_ps(hi, _mm_shuffle_ps(hi, hi, _MM_SHUFFLE(2, 3, 0, 1)));
+    lo = _mm_min_ps(lo, _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(1, 0, 3, 2)));
+    lo = _mm_min_ps(lo, _mm_shuffle_ps(lo, lo, _MM_SHUFFLE(2, 3, 0, 1)));
+    min = _mm_cvtss_f32(lo);
+
+    float peak = _mm_cvtss_f32(hi);
+    if (peak > max) {
+      //
+      // Find the first lane holding the peak.
+      //
+      for (i = 0; i < N; i += 4) {
+        int mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(&window[i]), hi));
+        if (mask != 0) {
+          maxI = i + __builtin_ctz(mask);
+          break;
+        }
+      }
+      max = peak;
+    }
+    return;
+  }
+#endif
+
+  for (int i = 0; i < N; i++) {
+    if (window[i] > max) {
+      max = window[i];
+      maxI = i;
+    }
+    if (window[i] < min)
+      min = window[i];
+  }
+}
+
+inline void
+ScanWindow(const float *window, int size, float& max, int& maxI, float& min)
+{
+  switch (size) {
+  case 8:
+    ScanWindow<8>(window, max, maxI, min);
+    return;
+  case 16:
+    ScanWindow<16>(window, max, maxI, min);
+    return;
+  default:
+    break;
+  }
+
+  for (int i = 0; i < size; i++) {
+    if (window[i] > max) {
+      max = window[i];
+      maxI = i;
+    }
+    if (window[i] < min)
+      min = window[i];
+  }
+}
+
+//
+// The valley-to-peak ratio by which the clock detectors judge whether a
+// clock is present: min / max, or zero when there's no positive peak.
+//
+// A phase that never sees any energy decays into the denormals, and
+// dividing one is very slow on x86. With a peak of at least 2^-23, such a
+// valley's true ratio is below 2^-103, so zero is returned without
+// dividing -- but only when 'threshold', the value the ratio is about to
+// be compared with, is above 2^-102 and so can't tell the two apart.
+//
+inline float
+WindowRatio(float min, float max, float threshold)
+{
+  if (max <= 0.0)
+    return 0.0;
+
+  if (min >= 0.0 && min < FLT_MIN && max >= 0x1p-23f && threshold > 0x1p-102f)
+    return 0.0;
+
+  return min / max;
+}
+
+#endif
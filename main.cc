@@ -33,39 +33,80 @@
 #include <stdlib.h>
 #include <signal.h>
 #include <unistd.h>
+#include <pthread.h>
 
 #include "RDATDecoder.h"
+#include "RDATGardnerDecoder.h"
 #include "NRZISyncDeframer.h"
 #include "DATWordReceiver.h"
+#include "DATTrackAssembler.h"
 #include "DATTrackFramer.h"
 #include "AudioFrameReceiver.h"
 #include "DDSFrameReceiver.h"
 #include "File.h"
+#include "SampleConverter.h"
+#include "RationalResampler.h"
+#include "ParallelDecoder.h"
+#include "DATPipeline.h"
+#include "CaptureFusion.h"
 
-enum { SAMPLES_PER_READ = 1000 };
+//
+// Samples handed to the decoder at a time. Mapped input has no copy to
+// amortize, so it is handed over in much larger spans.
+//
+enum { SAMPLES_PER_READ = 1000, SAMPLES_PER_MAP = 1024 * 1024 };
+
+//
+// Non-native or resampled input is processed in pieces small enough to
+// stay in cache between the conversion, the resampler and the decoder.
+//
+enum { SAMPLES_PER_CONVERT = 4096 };
+
+//
+// The sample rate the decoder runs at: eight times the symbol rate.
+//
+static const double kDecoderRate = 9408000.0 * 8;
 
 static void usage(const char *prog);
 static void sigint_handler(int);
 
+template <class Decoder>
+static void decode(File& in, const SampleConverter& converter,
+  RationalResampler *resampler, Decoder& decoder);
+template <class BlockReceiver>
+static void decode_composed(File& in, const SampleConverter& converter,
+  RationalResampler *resampler, BlockReceiver *blocks, bool dump);
+static void decode_fused(const char *const *filenames, size_t captures,
+  const SampleConverter& converter, unsigned int interpolation,
+  unsigned int decimation, DATFrameReceiver& streamer);
+
 static volatile bool running;
 
 int
 main(int argc, char *argv[])
 {
-  float buf[SAMPLES_PER_READ];
-  size_t nread;
+  SampleConverter converter;
+  RationalResampler *resampler = NULL;
+  double input_rate = kDecoderRate;
   bool do_raw = false;
   bool do_dat = false;
   bool do_dds = false;
   bool do_file = false;
   bool do_output = false;
   bool do_dds_session = false;
+  bool do_timing_recovery = false;
+  bool do_pipeline = false;
+  unsigned int threads = 1;
+  unsigned int passes;
+  unsigned int interpolation = 0, decimation = 0;
   enum { DECODE_RAW, DECODE_DAT, DECODE_DDS } decode_mode = DECODE_DAT;
   int c;
+  const char *filenames[CaptureFusion::kMaxCaptures];
+  size_t captures = 0;
   const char *filename, *outfile;
   unsigned int dds_session;
 
-  while ((c = getopt(argc, argv, "hdraf:o:s:")) != -1) {
+  while ((c = getopt(argc, argv, "hdraf:o:s:t:c:i:gj:pe:m:")) != -1) {
     switch (c) {
     default:
     case 'h':
@@ -81,8 +122,14 @@ main(int argc, char *argv[])
       do_dat = true;
       break;
     case 'f':
+      if (captures == CaptureFusion::kMaxCaptures) {
+        fprintf(stderr, "At most %zu captures can be fused.\n",
+          CaptureFusion::kMaxCaptures);
+        usage(argv[0]);
+      }
       do_file = true;
       filename = optarg;
+      filenames[captures++] = optarg;
       break;
     case 'o':
       do_output = true;
@@ -92,6 +139,46 @@ main(int argc, char *argv[])
       do_dds_session = true;
       dds_session = strtoul(optarg, NULL, 0);
       break;
+    case 't':
+      if (!converter.SetFormat(optarg)) {
+        fprintf(stderr, "Unknown sample format '%s'.\n", optarg);
+        usage(argv[0]);
+      }
+      break;
+    case 'c':
+      if (strcmp(optarg, "i") == 0 || strcmp(optarg, "I") == 0)
+        converter.SetChannel(0);
+      else if (strcmp(optarg, "q") == 0 || strcmp(optarg, "Q") == 0)
+        converter.SetChannel(1);
+      else
+        usage(argv[0]);
+      break;
+    case 'i':
+      input_rate = strtod(optarg, NULL);
+      break;
+    case 'g':
+      do_timing_recovery = true;
+      break;
+    case 'j':
+      threads = strtoul(optarg, NULL, 0);
+      if (threads == 0)
+        threads = sysconf(_SC_NPROCESSORS_ONLN);
+      break;
+    case 'p':
+      do_pipeline = true;
+      break;
+    case 'e':
+      passes = strtoul(optarg, NULL, 0);
+      if (passes < 1 || passes > Track::kMaxCorrectionPasses) {
+        fprintf(stderr, "Correction passes must be 1 to %u.\n",
+          Track::kMaxCorrectionPasses);
+        usage(argv[0]);
+      }
+      Track::SetCorrectionPasses(passes);
+      break;
+    case 'm':
+      Track::SetReliabilityTrials(strtoul(optarg, NULL, 0));
+      break;
     }
   }
 
@@ -118,6 +205,35 @@ main(int argc, char *argv[])
     usage(argv[0]);
   }
 
+  //
+  // Only whole tracks can be decoded in parallel, and only by the
+  // slicer.
+  //
+  if (threads != 1 && (do_raw || do_timing_recovery)) {
+    fprintf(stderr, "Parallel decoding is only for DAT or DDS, without -g.\n");
+    usage(argv[0]);
+  }
+
+  //
+  // The pipeline's stages start after the words are framed, so it
+  // needs DAT or DDS too, and it already has the back end to itself.
+  //
+  if (do_pipeline && (do_raw || threads != 1)) {
+    fprintf(stderr, "Pipelining is only for DAT or DDS, without -j.\n");
+    usage(argv[0]);
+  }
+
+  //
+  // Fusing captures needs frames to line up, and decodes each capture on
+  // its own thread.
+  //
+  if (captures > 1 && (!(do_dat || do_dds) || do_timing_recovery ||
+      threads != 1 || do_pipeline)) {
+    fprintf(stderr, "Fusing captures is only for DAT or DDS, without -g, "
+      "-j or -p.\n");
+    usage(argv[0]);
+  }
+
   //
   // Default to DAT if no choice specified.
   //
@@ -131,22 +247,43 @@ main(int argc, char *argv[])
   else if (do_dds)
     decode_mode = DECODE_DDS;
 
+  //
+  // Bring input at any other rate up (or down) to the decoder's rate,
+  // unless the timing recovery decoder, which runs at any rate, was
+  // asked for.
+  //
+  if (input_rate != kDecoderRate && !do_timing_recovery) {
+    if (!RationalResampler::Ratio(input_rate, kDecoderRate, interpolation,
+         decimation)) {
+      fprintf(stderr, "Can't resample from %.0f Hz.\n", input_rate);
+      exit(1);
+    }
+    resampler = new RationalResampler(interpolation, decimation);
+  }
+
   File in;
 
-  if (do_file) {
-    if (!in.Open(filename, sizeof(float)))  {
+  if (captures > 1) {
+    //
+    // Each capture is opened by its own decoder.
+    //
+  } else if (do_file) {
+    if (!in.Open(filename, converter.FrameSize()))  {
       fprintf(stderr, "Can't open file '%s'.\n", filename);
       exit(1);
     }
+    //
+    // Prefer to map the capture; it saves a copy of every sample.
+    //
+    in.Map();
   } else {
-    in.Open(STDIN_FILENO, sizeof(float));
+    in.Open(STDIN_FILENO, converter.FrameSize());
   }
 
-  RDATDecoder      *decoder;
-  NRZISyncDeframer *deframer;
-  DATWordReceiver  *blocker;
-  DATTrackFramer   *tracker = NULL;
-  DATFrameReceiver *streamer = NULL;
+  DATTrackAssembler *assembler = NULL;
+  DATPipeline       *pipeline = NULL;
+  DATTrackFramer    *tracker = NULL;
+  DATFrameReceiver  *streamer = NULL;
 
   switch (decode_mode) {
   case DECODE_DAT:
@@ -178,16 +315,30 @@ main(int argc, char *argv[])
     break;
   }
 
-  if (decode_mode == DECODE_RAW) {
-    blocker = new DATWordReceiver(NULL, true);
-  } else {
+  if (decode_mode != DECODE_RAW && captures < 2) {
     tracker = new DATTrackFramer(*streamer);
-    blocker = new DATWordReceiver(tracker, false);
+    assembler = new DATTrackAssembler(*tracker);
+  }
+
+  if (do_pipeline) {
+    pipeline = new DATPipeline(*tracker);
+    if (!pipeline->Start()) {
+      fprintf(stderr, "Can't start the decoding pipeline.\n");
+      exit(1);
+    }
+  }
+
+  //
+  // Parallel decoding needs the whole capture at hand.
+  //
+  const void *samples;
+  size_t frames = 0;
+
+  if (threads != 1) {
+    frames = in.Mapping(samples);
+    if (frames == 0)
+      fprintf(stderr, "Input can't be mapped; decoding on one thread.\n");
   }
-    
-  deframer = new NRZISyncDeframer(blocker);
-  decoder = new RDATDecoder(9408000.0 * 8);
-  decoder->SetSymbolDecoder(deframer);
 
   running = true;
 
@@ -195,42 +346,239 @@ main(int argc, char *argv[])
   // Install the sigint handler so that the user can stop the
   // processing safely.
   //
-  struct sigaction int_handler = { .sa_handler = sigint_handler };
+  struct sigaction int_handler;
+  memset(&int_handler, 0, sizeof(int_handler));
+  int_handler.sa_handler = sigint_handler;
   ::sigaction(SIGINT, &int_handler, NULL);
 
-  while (running) {
-    nread = in.Read(buf, SAMPLES_PER_READ);
-    if (nread == 0)
-      break;
-    decoder->Process(buf, nread);
+  if (captures > 1) {
+    decode_fused(filenames, captures, converter, interpolation, decimation,
+      *streamer);
+  } else if (frames > 0) {
+    ParallelDecoder parallel(converter, kDecoderRate, threads);
+    if (resampler != NULL)
+      parallel.SetResampling(interpolation, decimation);
+    parallel.Decode(samples, frames, *tracker, &running);
+  } else if (do_timing_recovery) {
+    DATBlockReceiver *blocks = assembler;
+    if (pipeline != NULL)
+      blocks = pipeline;
+    DATWordReceiver blocker(blocks, decode_mode == DECODE_RAW);
+    NRZISyncDeframer deframer(&blocker);
+    RDATGardnerDecoder decoder(input_rate);
+    decoder.SetSymbolDecoder(&deframer);
+    decode(in, converter, resampler, decoder);
+  } else if (decode_mode == DECODE_RAW) {
+    decode_composed<DATBlockReceiver>(in, converter, resampler, NULL, true);
+  } else if (pipeline != NULL) {
+    decode_composed(in, converter, resampler, pipeline, false);
+  } else {
+    decode_composed(in, converter, resampler, assembler, false);
   }
 
-  decoder->Stop();
+  if (pipeline != NULL)
+    pipeline->Report(stderr);
 
   in.Close();
   
-  delete decoder;
-  delete deframer;
-  delete blocker;
+  delete pipeline;
+  delete assembler;
+  delete tracker;
   delete streamer;
+  delete resampler;
 
   return 0;
 }
 
+//
+// Feed the whole input through the (optional) sample converter and
+// resampler and into the decoder.
+//
+template <class Decoder>
+static void
+decode(File& in, const SampleConverter& converter,
+  RationalResampler *resampler, Decoder& decoder)
+{
+  const void *span;
+  size_t nread, chunk;
+  float converted[SAMPLES_PER_CONVERT];
+  float *resampled = NULL;
+
+  if (resampler != NULL)
+    resampled = new float[resampler->MaxOutput(SAMPLES_PER_CONVERT)];
+
+  chunk = in.IsMapped() ? SAMPLES_PER_MAP : SAMPLES_PER_READ;
+
+  while (running) {
+    nread = in.Fetch(span, chunk);
+    if (nread == 0)
+      break;
+    if (converter.IsNative() && resampler == NULL) {
+      decoder.Process((const float *) span, nread);
+      continue;
+    }
+    const char *raw = (const char *) span;
+    while (nread > 0) {
+      size_t n = nread < SAMPLES_PER_CONVERT ? nread : SAMPLES_PER_CONVERT;
+      const float *samples = (const float *) raw;
+      if (!converter.IsNative()) {
+        converter.Convert(raw, converted, n);
+        samples = converted;
+      }
+      if (resampler != NULL)
+        decoder.Process(resampled,
+          resampler->Process(samples, n, resampled));
+      else
+        decoder.Process(samples, n);
+      raw += n * converter.FrameSize();
+      nread -= n;
+    }
+  }
+
+  decoder.Stop();
+
+  delete [] resampled;
+}
+
+//
+// Decode with the slicer, deframer and word receiver composed at compile
+// time for the given type of block receiver, so that the per-sample,
+// per-bit and per-word work is all one inlined loop.
+//
+template <class BlockReceiver>
+static void
+decode_composed(File& in, const SampleConverter& converter,
+  RationalResampler *resampler, BlockReceiver *blocks, bool dump)
+{
+  typedef DATWordReceiverT<BlockReceiver> Words;
+  typedef NRZISyncDeframerT<Words> Deframer;
+
+  Words words(blocks, dump);
+  Deframer deframer(&words);
+  RDATDecoderT<Deframer> decoder(kDecoderRate);
+
+  decoder.SetSymbolDecoder(&deframer);
+  decode(in, converter, resampler, decoder);
+}
+
+//
+// One capture being decoded for fusion, on its own thread.
+//
+struct FusedCapture {
+  File in;
+  const SampleConverter *converter;
+  RationalResampler *resampler;
+  DATTrackFramer *tracker;
+  DATTrackAssembler *assembler;
+  pthread_t thread;
+};
+
+static void *
+decode_capture(void *arg)
+{
+  FusedCapture *capture = (FusedCapture *) arg;
+
+  decode_composed(capture->in, *capture->converter, capture->resampler,
+    capture->assembler, false);
+
+  return NULL;
+}
+
+//
+// Decode each capture on its own thread, as far as frames that have had
+// C1, and fuse them into one stream of frames for the receiver.
+//
+static void
+decode_fused(const char *const *filenames, size_t captures,
+  const SampleConverter& converter, unsigned int interpolation,
+  unsigned int decimation, DATFrameReceiver& streamer)
+{
+  CaptureFusion fusion(streamer, captures);
+  FusedCapture *capture = new FusedCapture[captures];
+  size_t started;
+
+  for (size_t i = 0; i < captures; i++) {
+    if (!capture[i].in.Open(filenames[i], converter.FrameSize())) {
+      fprintf(stderr, "Can't open file '%s'.\n", filenames[i]);
+      exit(1);
+    }
+    capture[i].in.Map();
+    capture[i].converter = &converter;
+    capture[i].resampler = NULL;
+    if (interpolation != 0)
+      capture[i].resampler = new RationalResampler(interpolation,
+        decimation);
+    capture[i].tracker = new DATTrackFramer(fusion.Input(i));
+    capture[i].tracker->SetVerbose(false);
+    capture[i].assembler = new DATTrackAssembler(*capture[i].tracker);
+    capture[i].assembler->SetDeferC2(true);
+  }
+
+  for (started = 0; started < captures; started++) {
+    if (pthread_create(&capture[started].thread, NULL, decode_capture,
+         &capture[started]) != 0) {
+      fprintf(stderr, "Can't start decoding capture '%s'.\n",
+        filenames[started]);
+      running = false;
+      break;
+    }
+  }
+  for (size_t i = started; i < captures; i++)
+    fusion.Input(i).Stop();
+
+  for (size_t i = 0; i < started; i++)
+    pthread_join(capture[i].thread, NULL);
+
+  fusion.Stop();
+
+  fprintf(stderr, "Fused %zu frames from %zu captures: %zu with more than "
+    "one read, %zu dropped without a frame key.\n", fusion.Frames(),
+    captures, fusion.FusedFrames(), fusion.UnkeyedFrames());
+
+  for (size_t i = 0; i < captures; i++) {
+    capture[i].in.Close();
+    delete capture[i].assembler;
+    delete capture[i].tracker;
+    delete capture[i].resampler;
+  }
+  delete [] capture;
+}
+
 static void
 usage(const char *prog)
 {
   fprintf(stderr,
     "usage: %s [-r|-d|-a] [-s <number>] [-f <filename>] [-o <path>]\n"
-    "Decode DAT/DDS samples taken from an R-DAT RF head. Input must be in\n"
-    "IEEE-float format, in native-endian order, and sampled at 75.264MHz.\n"
+    "          [-t <format>] [-c i|q] [-i <rate>] [-g] [-j <threads>] [-p]\n"
+    "          [-e <passes>] [-m <trials>]\n"
+    "Decode DAT/DDS samples taken from an R-DAT RF head.\n"
     " -a - Use DAT decode (Default)\n"
     " -d - Use DDS decoder.\n"
     " -r - Dump raw packets; don't interpret as DAT nor DDS.\n"
     " -o - DAT mode: Write raw audio to file <path>.\n"
     "      DDS mode: Dump basic groups to directory <path>.\n"
-    " -f - Read data from filename. (Default is stdin).\n"
-    " -s - Dump DDS session <number> (DDS only)\n",
+    " -f - Read data from filename. (Default is stdin). Repeat to fuse\n"
+    "      several captures of the same tape, byte by byte, before C2\n"
+    "      (DAT or DDS only).\n"
+    " -s - Dump DDS session <number> (DDS only)\n"
+    " -t - Input sample format: f32 (native-endian IEEE float, default),\n"
+    "      s8, s16le or s16be. Prefix with 'c' (e.g. cs16le) for\n"
+    "      complex-interleaved I/Q input.\n"
+    " -c - Channel of complex input to decode: i (default) or q.\n"
+    " -i - Input sample rate in Hz (Default 75264000). Other rates are\n"
+    "      resampled to 75.264MHz internally.\n"
+    " -g - Recover the symbol clock with an interpolating timing loop,\n"
+    "      directly at the input sample rate (> ~20.7MHz), instead of\n"
+    "      resampling.\n"
+    " -j - Decode a file's tracks on <threads> threads (0 for one per\n"
+    "      processor). DAT or DDS only.\n"
+    " -p - Pipeline the decoding: slice, correct errors and write output\n"
+    "      on separate threads, and report how busy each one was.\n"
+    " -e - Alternate C1 and C2 error correction for up to <passes>\n"
+    "      passes (Default 1), feeding what each one fixes to the other.\n"
+    " -m - Retry each C2 codeword that can't be corrected up to <trials>\n"
+    "      times, treating more of its least reliable bytes as erasures\n"
+    "      each time (Default 0).\n",
     prog
   );
   exit(1);
@@ -0,0 +1,110 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#ifndef RDAT_TEST_FRAME_RECORDER_H
+#define RDAT_TEST_FRAME_RECORDER_H
+
+#include "Track.h"
+#include "DATFrameReceiver.h"
+
+#include <string.h>
+
+//
+// A frame receiver for the tests that remembers what it was given. Test
+// tracks are told apart by their ATF3 counts; their ATF2 counts stand in
+// for their frame keys, zero meaning none.
+//
+class FrameRecorder : public DATFrameReceiver {
+public:
+  FrameRecorder() : mFrames(0), mStopped(false) {
+    for (size_t i = 0; i < kKeys; i++)
+      memset(mKeys[i], (int) i, kFrameKeySize);
+  }
+
+  bool IsFrame(const Track& a, const Track& b) {
+    return a.ATF2Count() != 0 && a.ATF2Count() == b.ATF2Count() &&
+           a.GetHead() != Track::HEAD_B && b.GetHead() != Track::HEAD_A;
+  }
+
+  void ReceiveFrame(const Track& a, const Track& b) {
+    mKeyOf[mFrames] = a.ATF2Count();
+    mFirst[mFrames] = a.ATF3Count();
+    mSecond[mFrames] = b.ATF3Count();
+    mFrames++;
+  }
+
+  void Stop() {
+    mStopped = true;
+  }
+
+  bool FrameKey(const Track& track, const uint8_t **key) {
+    *key = mKeys[track.ATF2Count()];
+    return track.ATF2Count() != 0;
+  }
+
+  //
+  // Were exactly these frames received, in this order? (Given as pairs
+  // of track numbers, ending in zero.)
+  //
+  bool Received(const int *frames) const {
+    size_t i;
+    for (i = 0; frames[2 * i] != 0; i++)
+      if (i >= mFrames || mFirst[i] != frames[2 * i] ||
+          mSecond[i] != frames[2 * i + 1])
+        return false;
+    return i == mFrames;
+  }
+
+  //
+  // Were frames with exactly these keys received, in this order? (Ending
+  // in zero.)
+  //
+  bool ReceivedKeys(const int *keys) const {
+    size_t i;
+    for (i = 0; keys[i] != 0; i++)
+      if (i >= mFrames || mKeyOf[i] != keys[i])
+        return false;
+    return i == mFrames;
+  }
+
+  bool Stopped() const {
+    return mStopped;
+  }
+
+protected:
+  static const size_t kKeys = 16;
+  uint8_t mKeys[kKeys][kFrameKeySize];
+  int mKeyOf[16];
+  int mFirst[16];
+  int mSecond[16];
+  size_t mFrames;
+  bool mStopped;
+};
+
+#endif
@@ -0,0 +1,448 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+//
+// A throughput benchmark for the error correction layers.
+//
+// It makes random valid codewords for each of the C1, C2 and C3 codes,
+// and all-zero (and so valid) tracks and basic groups, damages them with
+// random errors and erasures at the requested densities, and times how
+// long each layer takes to correct them -- for every GF(2^8) arithmetic
+// and syndrome implementation the processor supports. Each layer gets an
+// untimed round first, to warm up, and then the timed rounds.
+//
+// Results go to standard output as tab-separated values, one line per
+// layer and implementation, after a header line naming the columns:
+//
+//   layer        - C1, C2 or C3 (single codewords), track (C1 and C2 over
+//                  a whole track, Track::Complete()) or group (C3 over a
+//                  whole basic group, BasicGroup::Correct())
+//   arith        - the GF(2^8) arithmetic
+//   syndrome     - the syndrome implementation
+//   errors       - the chance of each byte being in error (but valid)
+//   erasures     - the chance of each byte being erased
+//   unit         - what was counted: codeword, track or group
+//   units        - how many were corrected, over every round
+//   seconds      - the time the corrections took
+//   units_per_s  - units corrected per second
+//   symbols      - damaged bytes that came back correct and valid
+//   ns_per_symbol - nanoseconds per such byte (0 if there were none)
+//   uncorrectable - units left with some damage
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "ECC_C1.h"
+#include "ECC_C2.h"
+#include "ECC_C3.h"
+#include "ECC_GF28_Arith.h"
+#include "ECC_Syndrome.h"
+#include "Track.h"
+#include "BasicGroup.h"
+
+static void usage(const char *prog);
+
+static double gErrorRate = 0.01;
+static double gErasureRate = 0.0;
+static size_t gCodewords = 4096;
+static size_t gTracks = 16;
+static size_t gRounds = 10;
+
+struct Result {
+  size_t units;
+  double seconds;
+  size_t symbols;
+  size_t uncorrectable;
+};
+
+static double
+now()
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static bool
+chance(double p)
+{
+  return random() < p * ((double) RAND_MAX + 1);
+}
+
+//
+// Damage a byte: maybe give it an error, maybe erase it (with a random
+// value, as a failed ten-to-eight lookup would leave it). Returns true
+// if it was damaged.
+//
+static bool
+damage(uint8_t& byte, bool& valid)
+{
+  if (chance(gErasureRate)) {
+    byte = random() & 0xff;
+    valid = false;
+    return true;
+  }
+  if (chance(gErrorRate)) {
+    byte ^= 1 + random() % 255;
+    return true;
+  }
+
+  return false;
+}
+
+//
+// A codeword laid out in order, for the single codeword layers.
+//
+class FlatFill : public ECCFill {
+public:
+  FlatFill(uint8_t *data, bool *valid) : mData(data), mValid(valid) {}
+
+  uint8_t& Data(size_t position) { return mData[position]; }
+  bool Valid(size_t position) const { return mValid[position]; }
+  void SetValid(size_t position, bool valid) { mValid[position] = valid; }
+
+protected:
+  uint8_t *mData;
+  bool    *mValid;
+};
+
+//
+// Make a random codeword: fill it at random, then treat the parity
+// positions as erasures and let the decoder fill them in.
+//
+template <class Code>
+static void
+make_codeword(uint8_t *word)
+{
+  uint8_t syndrome[Code::kTwoT], erasures[Code::kTwoT];
+  size_t corrections;
+
+  for (size_t j = 0; j < Code::kN; j++)
+    word[j] = j < Code::kTwoT ? 0 : random() & 0xff;
+  for (size_t i = 0; i < Code::kTwoT; i++)
+    erasures[i] = Code::Power(i);
+
+  if (!Code::Syndromes().Compute(word, syndrome))
+    Code::Correct((uint8_t (&)[Code::kN]) *word, syndrome, erasures,
+      Code::kTwoT, corrections);
+}
+
+template <class Vector>
+static Result
+bench_vector()
+{
+  typedef typename Vector::Code Code;
+  const size_t kN = Code::kN;
+  const size_t bytes = gCodewords * kN;
+  uint8_t *clean = new uint8_t[bytes];
+  uint8_t *damaged = new uint8_t[bytes];
+  uint8_t *work = new uint8_t[bytes];
+  bool *damagedValid = new bool[bytes];
+  bool *workValid = new bool[bytes];
+  Result result = { 0, 0, 0, 0 };
+  Vector v;
+
+  for (size_t k = 0; k < gCodewords; k++)
+    make_codeword<Code>(&clean[k * kN]);
+  memcpy(damaged, clean, bytes);
+  for (size_t i = 0; i < bytes; i++) {
+    damagedValid[i] = true;
+    damage(damaged[i], damagedValid[i]);
+  }
+
+  for (size_t round = 0; round <= gRounds; round++) {
+    memcpy(work, damaged, bytes);
+    memcpy(workValid, damagedValid, bytes);
+
+    double start = now();
+    for (size_t k = 0; k < gCodewords; k++) {
+      FlatFill fill(&work[k * kN], &workValid[k * kN]);
+
+      v.Fill(fill);
+      if (v.Correct() != Vector::NO_ERRORS)
+        v.Dump(fill);
+    }
+    if (round > 0) {
+      result.seconds += now() - start;
+      result.units += gCodewords;
+      continue;
+    }
+
+    for (size_t k = 0; k < gCodewords; k++) {
+      bool whole = true;
+      for (size_t j = k * kN; j < (k + 1) * kN; j++) {
+        bool good = work[j] == clean[j] && workValid[j];
+        if (good && (damaged[j] != clean[j] || !damagedValid[j]))
+          result.symbols++;
+        whole = whole && good;
+      }
+      if (!whole)
+        result.uncorrectable++;
+    }
+  }
+  result.symbols *= gRounds;
+  result.uncorrectable *= gRounds;
+
+  delete [] clean;
+  delete [] damaged;
+  delete [] work;
+  delete [] damagedValid;
+  delete [] workValid;
+
+  return result;
+}
+
+static Result
+bench_track()
+{
+  const size_t kBytes = Track::kBlocks * Track::kBlockSize;
+  Track::DataArray *damaged = new Track::DataArray[gTracks];
+  Track::ValidityArray *damagedValid = new Track::ValidityArray[gTracks];
+  Track **tracks = new Track*[gTracks];
+  Result result = { 0, 0, 0, 0 };
+
+  for (size_t t = 0; t < gTracks; t++) {
+    uint8_t *data = &damaged[t][0][0];
+
+    tracks[t] = new Track(Track::HEAD_A);
+    for (size_t i = 0; i < kBytes; i++) {
+      bool valid = true;
+      data[i] = 0;
+      damage(data[i], valid);
+      damagedValid[t].Set(i, valid);
+    }
+  }
+
+  for (size_t round = 0; round <= gRounds; round++) {
+    for (size_t t = 0; t < gTracks; t++) {
+      memcpy(tracks[t]->ModifiableData(), damaged[t], sizeof(damaged[t]));
+      tracks[t]->ModifiableDataValid() = damagedValid[t];
+    }
+
+    double start = now();
+    for (size_t t = 0; t < gTracks; t++)
+      tracks[t]->Complete();
+    if (round > 0) {
+      result.seconds += now() - start;
+      result.units += gTracks;
+      continue;
+    }
+
+    for (size_t t = 0; t < gTracks; t++) {
+      const uint8_t *data = &tracks[t]->Data()[0][0];
+      const uint8_t *before = &damaged[t][0][0];
+      const Track::ValidityArray& valid = tracks[t]->DataValid();
+      bool whole = true;
+
+      for (size_t i = 0; i < kBytes; i++) {
+        bool good = data[i] == 0 && valid.Test(i);
+        if (good && (before[i] != 0 || !damagedValid[t].Test(i)))
+          result.symbols++;
+        whole = whole && good;
+      }
+      if (!whole)
+        result.uncorrectable++;
+    }
+  }
+  result.symbols *= gRounds;
+  result.uncorrectable *= gRounds;
+
+  for (size_t t = 0; t < gTracks; t++)
+    delete tracks[t];
+  delete [] tracks;
+  delete [] damaged;
+  delete [] damagedValid;
+
+  return result;
+}
+
+static Result
+bench_group()
+{
+  BasicGroup *group = new BasicGroup(0);
+  BasicGroup::DataArray *damaged = new BasicGroup::DataArray[1];
+  BasicGroup::ValidArray *damagedValid = new BasicGroup::ValidArray;
+  BasicGroup::ECCDataArray *damagedECC = new BasicGroup::ECCDataArray[1];
+  BasicGroup::ECCValidArray *damagedECCValid =
+    new BasicGroup::ECCValidArray;
+  Result result = { 0, 0, 0, 0 };
+
+  for (size_t i = 0; i < BasicGroup::kSize; i++) {
+    bool valid = true;
+    damaged[0][i] = 0;
+    damage(damaged[0][i], valid);
+    damagedValid->Set(i, valid);
+  }
+  for (size_t i = 0; i < DDSGroup1::kSize; i++) {
+    bool valid = true;
+    damagedECC[0][i] = 0;
+    damage(damagedECC[0][i], valid);
+    damagedECCValid->Set(i, valid);
+  }
+
+  for (size_t round = 0; round <= gRounds; round++) {
+    memcpy(group->ModifiableData(), damaged[0], sizeof(damaged[0]));
+    group->ModifiableValid() = *damagedValid;
+    memcpy(group->ModifiableECCData(), damagedECC[0], sizeof(damagedECC[0]));
+    group->ModifiableECCValid() = *damagedECCValid;
+
+    double start = now();
+    group->Correct();
+    if (round > 0) {
+      result.seconds += now() - start;
+      result.units++;
+      continue;
+    }
+
+    bool whole = true;
+    for (size_t i = 0; i < BasicGroup::kSize; i++) {
+      bool good = group->Data()[i] == 0 && group->Valid().Test(i);
+      if (good && (damaged[0][i] != 0 || !damagedValid->Test(i)))
+        result.symbols++;
+      whole = whole && good;
+    }
+    if (!whole)
+      result.uncorrectable++;
+  }
+  result.symbols *= gRounds;
+  result.uncorrectable *= gRounds;
+
+  delete group;
+  delete [] damaged;
+  delete damagedValid;
+  delete [] damagedECC;
+  delete damagedECCValid;
+
+  return result;
+}
+
+static void
+report(const char *layer, const char *unit, const Result& result)
+{
+  printf("%s\t%s\t%s\t%g\t%g\t%s\t%zu\t%.6f\t%.1f\t%zu\t%.1f\t%zu\n",
+    layer, ECC_GF28_Arith::Name(ECC_GF28_Arith::Selected()),
+    ECC_Syndrome::Name(ECC_Syndrome::Selected()), gErrorRate, gErasureRate,
+    unit, result.units, result.seconds,
+    result.seconds > 0 ? result.units / result.seconds : 0,
+    result.symbols,
+    result.symbols > 0 ? result.seconds * 1e9 / result.symbols : 0,
+    result.uncorrectable);
+  fflush(stdout);
+}
+
+int
+main(int argc, char *argv[])
+{
+  static const ECC_Syndrome::Implementation kSyndromes[] = {
+    ECC_Syndrome::SCALAR, ECC_Syndrome::SSSE3, ECC_Syndrome::AVX2
+  };
+  const ECC_GF28_Arith::Implementation arith = ECC_GF28_Arith::Selected();
+  const ECC_Syndrome::Implementation syndrome = ECC_Syndrome::Selected();
+  unsigned int seed = 1;
+  int c;
+
+  while ((c = getopt(argc, argv, "he:x:n:t:r:s:")) != -1) {
+    switch (c) {
+    default:
+    case 'h':
+      usage(argv[0]);
+      break;
+    case 'e':
+      gErrorRate = strtod(optarg, NULL);
+      break;
+    case 'x':
+      gErasureRate = strtod(optarg, NULL);
+      break;
+    case 'n':
+      gCodewords = strtoul(optarg, NULL, 0);
+      break;
+    case 't':
+      gTracks = strtoul(optarg, NULL, 0);
+      break;
+    case 'r':
+      gRounds = strtoul(optarg, NULL, 0);
+      break;
+    case 's':
+      seed = strtoul(optarg, NULL, 0);
+      break;
+    }
+  }
+
+  if (gCodewords == 0 || gTracks == 0 || gRounds == 0)
+    usage(argv[0]);
+
+  printf("layer\tarith\tsyndrome\terrors\terasures\tunit\tunits\tseconds\t"
+    "units_per_s\tsymbols\tns_per_symbol\tuncorrectable\n");
+
+  for (size_t a = 0; a < ECC_GF28_Arith::kImplementations; a++) {
+    if (!ECC_GF28_Arith::Select((ECC_GF28_Arith::Implementation) a))
+      continue;
+
+    for (size_t s = 0; s < sizeof(kSyndromes) / sizeof(kSyndromes[0]); s++) {
+      if (!ECC_Syndrome::Select(kSyndromes[s]))
+        continue;
+
+      //
+      // The same damage for every implementation.
+      //
+      srandom(seed);
+      report("C1", "codeword", bench_vector<ECC_C1>());
+      report("C2", "codeword", bench_vector<ECC_C2>());
+      report("C3", "codeword", bench_vector<ECC_C3>());
+      report("track", "track", bench_track());
+      report("group", "group", bench_group());
+    }
+  }
+
+  ECC_GF28_Arith::Select(arith);
+  ECC_Syndrome::Select(syndrome);
+
+  return 0;
+}
+
+static void
+usage(const char *prog)
+{
+  fprintf(stderr,
+    "usage: %s [-e <rate>] [-x <rate>] [-n <codewords>] [-t <tracks>]\n"
+    "          [-r <rounds>] [-s <seed>]\n"
+    "Benchmark the error correction layers on randomly damaged data.\n"
+    " -e - Chance of each byte being in error (Default 0.01).\n"
+    " -x - Chance of each byte being erased (Default 0).\n"
+    " -n - Codewords per single codeword layer (Default 4096).\n"
+    " -t - Tracks for the track layer (Default 16).\n"
+    " -r - Rounds to time each layer over (Default 10).\n"
+    " -s - Random seed (Default 1).\n",
+    prog
+  );
+  exit(1);
+}
@@ -0,0 +1,314 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+//
+// A throughput benchmark for the line decoding that follows the slicer:
+// NRZI decoding, sync search and word framing (NRZISyncDeframerT), and
+// ten-to-eight decoding and block assembly (DATWordReceiverT).
+//
+// It makes a line signal of whole tracks -- pre-amble, then blocks of a
+// sync word and random data words -- NRZI encodes it, flips bits at the
+// requested rate, and times the stages composed as main.cc composes them,
+// fed both a bit at a time and in batches of the requested size. Both
+// must deliver the same blocks; if not, the benchmark fails.
+//
+// Results go to standard output as tab-separated values, one line per
+// way of feeding the bits, after a header line naming the columns:
+//
+//   feed         - bit (ReceiveBit()) or batch (ReceiveBits())
+//   batch_bits   - bits per call
+//   bit_errors   - the chance of each line bit being flipped
+//   bits         - bits decoded, over every round
+//   seconds      - the time the decoding took
+//   ns_per_bit   - nanoseconds per bit
+//   mbit_per_s   - millions of bits per second
+//   blocks       - blocks delivered per round
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include "NRZISyncDeframer.h"
+#include "DATWordReceiver.h"
+#include "DATBlock.h"
+
+static void usage(const char *prog);
+
+static double gBitErrorRate = 0.0;
+static size_t gTracks = 64;
+static size_t gRounds = 10;
+static size_t gBatchBits = 64;
+
+//
+// Line words per track: the pre-amble, then each block's sync word and
+// 35 data words.
+//
+static const size_t kPreambleWords = 30;
+static const size_t kBlocks = 144;
+static const size_t kBlockWords = 36;
+static const size_t kTrackBits = (kPreambleWords + kBlocks * kBlockWords) * 10;
+
+//
+// Counts the blocks and folds their contents into a hash, so that two
+// runs can be compared.
+//
+class BlockCounter {
+public:
+  BlockCounter() : mHash(2166136261u), mBlocks(0) {}
+
+  void ReceiveBlock(const DATBlock& block) {
+    const uint16_t *bytes = block.FlaggedBytes();
+    for (size_t i = 0; i < block.Size(); i++)
+      mHash = (mHash ^ bytes[i]) * 16777619u;
+    mBlocks++;
+  }
+  void ReceiveATFTone(int tone) {}
+  void TrackDetected(bool up) {}
+  void Stop() {}
+
+  uint32_t mHash;
+  size_t mBlocks;
+};
+
+typedef DATWordReceiverT<BlockCounter> Words;
+typedef NRZISyncDeframerT<Words> Deframer;
+
+struct Result {
+  size_t bits;
+  double seconds;
+  size_t blocks;
+  uint32_t hash;
+};
+
+static double
+now()
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static bool
+chance(double p)
+{
+  return random() < p * ((double) RAND_MAX + 1);
+}
+
+//
+// Make the NRZI encoded line signal for gTracks tracks, one bit per
+// byte.
+//
+static bool *
+make_line()
+{
+  uint16_t dataWords[256];
+  uint16_t syncWord = 0;
+  bool *line = new bool[gTracks * kTrackBits];
+  bool level = false;
+  size_t n = 0;
+
+  //
+  // Find a line word for each byte, and for sync, by inverting the
+  // ten-to-eight table.
+  //
+  for (int w = 0x3ff; w >= 0; w--) {
+    uint16_t decode = TenToEightTable[w];
+    if (decode == WORD_SYNC)
+      syncWord = w;
+    else if ((decode & 0xff00) == 0)
+      dataWords[decode] = w;
+  }
+
+  for (size_t t = 0; t < gTracks; t++) {
+    for (size_t w = 0; w < kPreambleWords + kBlocks * kBlockWords; w++) {
+      uint16_t word;
+      if (w < kPreambleWords)
+        word = 0x3ff;
+      else if ((w - kPreambleWords) % kBlockWords == 0)
+        word = syncWord;
+      else
+        word = dataWords[random() & 0xff];
+
+      for (int k = 9; k >= 0; k--) {
+        if ((word >> k) & 1)
+          level = !level;
+        line[n++] = chance(gBitErrorRate) ? !level : level;
+      }
+    }
+  }
+
+  return line;
+}
+
+//
+// Decode the line, a bit at a time or in batches of gBatchBits (packed
+// before the clock starts), with track detection raised and dropped
+// around each track as the slicer would.
+//
+static Result
+bench_line(const bool *line, bool batched)
+{
+  const size_t batches = (kTrackBits + gBatchBits - 1) / gBatchBits;
+  uint64_t *packed = new uint64_t[gTracks * batches];
+  Result result = { 0, 0.0, 0, 0 };
+
+  for (size_t t = 0; t < gTracks; t++) {
+    for (size_t b = 0; b < batches; b++) {
+      uint64_t batch = 0;
+      for (size_t i = b * gBatchBits;
+           i < (b + 1) * gBatchBits && i < kTrackBits; i++)
+        batch = (batch << 1) | line[t * kTrackBits + i];
+      packed[t * batches + b] = batch;
+    }
+  }
+
+  for (size_t r = 0; r <= gRounds; r++) {
+    BlockCounter blocks;
+    Words words(&blocks, false);
+    Deframer deframer(&words);
+
+    double start = now();
+    for (size_t t = 0; t < gTracks; t++) {
+      deframer.TrackDetected(true);
+      if (batched) {
+        const uint64_t *batch = &packed[t * batches];
+        for (size_t b = 0; b + 1 < batches; b++)
+          deframer.ReceiveBits(batch[b], gBatchBits);
+        deframer.ReceiveBits(batch[batches - 1],
+          kTrackBits - (batches - 1) * gBatchBits);
+      } else {
+        const bool *bits = &line[t * kTrackBits];
+        for (size_t i = 0; i < kTrackBits; i++)
+          deframer.ReceiveBit(bits[i]);
+      }
+      deframer.TrackDetected(false);
+    }
+    deframer.Stop();
+    double elapsed = now() - start;
+
+    //
+    // The first round is a warm up.
+    //
+    if (r > 0) {
+      result.bits += gTracks * kTrackBits;
+      result.seconds += elapsed;
+    }
+    result.blocks = blocks.mBlocks;
+    result.hash = blocks.mHash;
+  }
+
+  delete [] packed;
+
+  return result;
+}
+
+static void
+report(const char *feed, size_t batchBits, const Result& result)
+{
+  printf("%s\t%zu\t%g\t%zu\t%.6f\t%.3f\t%.1f\t%zu\n",
+    feed, batchBits, gBitErrorRate, result.bits, result.seconds,
+    result.bits > 0 ? result.seconds * 1e9 / result.bits : 0,
+    result.seconds > 0 ? result.bits / result.seconds / 1e6 : 0,
+    result.blocks);
+  fflush(stdout);
+}
+
+int
+main(int argc, char *argv[])
+{
+  unsigned int seed = 1;
+  int c;
+
+  while ((c = getopt(argc, argv, "he:t:r:b:s:")) != -1) {
+    switch (c) {
+    default:
+    case 'h':
+      usage(argv[0]);
+      break;
+    case 'e':
+      gBitErrorRate = strtod(optarg, NULL);
+      break;
+    case 't':
+      gTracks = strtoul(optarg, NULL, 0);
+      break;
+    case 'r':
+      gRounds = strtoul(optarg, NULL, 0);
+      break;
+    case 'b':
+      gBatchBits = strtoul(optarg, NULL, 0);
+      break;
+    case 's':
+      seed = strtoul(optarg, NULL, 0);
+      break;
+    }
+  }
+
+  if (gTracks == 0 || gRounds == 0 || gBatchBits == 0 || gBatchBits > 64)
+    usage(argv[0]);
+
+  srandom(seed);
+  bool *line = make_line();
+
+  printf("feed\tbatch_bits\tbit_errors\tbits\tseconds\tns_per_bit\t"
+    "mbit_per_s\tblocks\n");
+
+  Result bit = bench_line(line, false);
+  report("bit", 1, bit);
+  Result batch = bench_line(line, true);
+  report("batch", gBatchBits, batch);
+
+  delete [] line;
+
+  if (bit.blocks != batch.blocks || bit.hash != batch.hash) {
+    fprintf(stderr, "Batched decoding gave different blocks.\n");
+    return 1;
+  }
+
+  return 0;
+}
+
+static void
+usage(const char *prog)
+{
+  fprintf(stderr,
+    "usage: %s [-e <rate>] [-t <tracks>] [-r <rounds>] [-b <bits>]\n"
+    "          [-s <seed>]\n"
+    "Benchmark the line decoding that follows the slicer.\n"
+    " -e - Chance of each line bit being flipped (Default 0).\n"
+    " -t - Tracks of line signal (Default 64).\n"
+    " -r - Rounds to time each way of feeding over (Default 10).\n"
+    " -b - Bits per batch, 1 to 64 (Default 64).\n"
+    " -s - Random seed (Default 1).\n",
+    prog
+  );
+  exit(1);
+}
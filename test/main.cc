@@ -41,6 +41,23 @@ main(int argc, char *argv[])
   test_timecode(testSession);
   test_diffclock(testSession); 
   test_samplewindow(testSession);
+  test_sampleconverter(testSession);
+  test_resampler(testSession);
+  test_gardner(testSession);
+  test_deframer(testSession);
+  test_slicer(testSession);
+  test_windowscan(testSession);
+  test_gapscanner(testSession);
+  test_spscring(testSession);
+  test_syndrome(testSession);
+  test_batch(testSession);
+  test_reedsolomon(testSession);
+  test_bitmask(testSession);
+  test_gf28(testSession);
+  test_trackpool(testSession);
+  test_frame(testSession);
+  test_framer(testSession);
+  test_fusion(testSession);
 
   printf("%d of %d tests passed.\n", testSession.Passed(), testSession.Total());
 
@@ -0,0 +1,367 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "Track.h"
+#include "ECC_C1.h"
+#include "ECC_C2.h"
+#include "ECCFill_C1.h"
+#include "ECCFill_C2.h"
+#include "ECC_Batch.h"
+#include "ReedSolomon.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Does the map put every byte of every codeword where the fill iterator
+// finds it, and back again?
+//
+template <class Code, size_t kWords, class Fill>
+static bool
+map_matches(Track& track, Fill fill)
+{
+  const uint8_t *base = &track.ModifiableData()[0][0];
+  ECC_GatherMap<Code, kWords, Track::ValidityArray::kSize> map(fill, base);
+  size_t k;
+
+  for (k = 0; !fill.End(); fill.Next(), k++) {
+    if (k >= map.Count())
+      return false;
+    for (size_t j = 0; j < Code::kN; j++)
+      if (&fill.Data(j) != base + map.Offset(j, k) ||
+          map.Place(map.Offset(j, k)) != k * 64 + j)
+        return false;
+  }
+
+  return k == map.Count() && k == kWords;
+}
+
+//
+// Where the j-th byte of C1 codeword k lives in the track.
+//
+static size_t
+c1_offset(Track& track, size_t k, size_t j)
+{
+  ECCFill_C1 fill(track);
+
+  for (size_t i = 0; i < k; i++)
+    fill.Next();
+
+  return &fill.Data(j) - &track.ModifiableData()[0][0];
+}
+
+static bool
+is_c1_parity(size_t offset)
+{
+  return (offset / Track::kBlockSize) % 2 == 1 &&
+         offset % Track::kBlockSize >= ECCFill_C2::kBytesOddGroup;
+}
+
+//
+// Damage a zero track so that one pass of C1 then C2 can't repair it but
+// a second one can. C1 codewords 0, 4, 8, ... all cross the same C2
+// codewords. Five of them get too many errors for C1, which leaves five
+// erasures in each of those C2 codewords: just fixable. Codeword 0 is
+// swapped for another valid codeword that differs in two parity bytes and
+// three data bytes. C1 can't see that, and in those three C2 codewords
+// the extra error is one too many. Each of the five erased C1 codewords
+// is then left with three erasures, which C1 can fill in, after which
+// C2 can fix the last three errors.
+//
+static void
+damage_for_iteration(Track& track)
+{
+  typedef ECC_C1::Code Code;
+  Track::DataArray& data = track.ModifiableData();
+  Track::ValidityArray& valid = track.ModifiableDataValid();
+  uint8_t *base = &data[0][0];
+  uint8_t word[Code::kN], syndrome[Code::kTwoT], erasures[Code::kTwoT];
+  size_t data_pos[Code::kN], parity_pos[Code::kN];
+  size_t num_data = 0, num_parity = 0, corrections;
+
+  memset(data, 0, sizeof(data));
+  valid.Fill(true);
+
+  for (size_t j = 0; j < Code::kN; j++) {
+    if (is_c1_parity(c1_offset(track, 0, j)))
+      parity_pos[num_parity++] = j;
+    else
+      data_pos[num_data++] = j;
+  }
+
+  memset(word, 0, sizeof(word));
+  word[data_pos[0]] = 0x37;
+  erasures[0] = Code::Power(data_pos[5]);
+  erasures[1] = Code::Power(data_pos[11]);
+  erasures[2] = Code::Power(parity_pos[0]);
+  erasures[3] = Code::Power(parity_pos[1]);
+  Code::Syndromes().Compute(word, syndrome);
+  Code::Correct(word, syndrome, erasures, Code::kTwoT, corrections);
+  for (size_t j = 0; j < Code::kN; j++)
+    base[c1_offset(track, 0, j)] = word[j];
+
+  for (size_t k = 4; k <= 20; k += 4)
+    for (size_t i = 0; i < 8; i++)
+      base[c1_offset(track, k, data_pos[i * 3 + 1])] ^= 0x11 * (i + 1);
+}
+
+//
+// Damage a zero track so that C2 fails unless it distrusts what C1 did.
+// C1 codewords 0 and 4 are each one byte away from another valid
+// codeword that differs in three data bytes, so C1 "corrects" them into
+// those, with one correction each. Three more C1 codewords crossing the
+// same C2 codewords get too many errors for C1. That leaves three C2
+// codewords with three erasures and two errors each: one error too many,
+// unless one of the bytes that C1 changed codewords for is erased too.
+//
+static void
+damage_for_reliability(Track& track)
+{
+  typedef ECC_C1::Code Code;
+  Track::DataArray& data = track.ModifiableData();
+  Track::ValidityArray& valid = track.ModifiableDataValid();
+  uint8_t *base = &data[0][0];
+  uint8_t word[Code::kN], syndrome[Code::kTwoT], erasures[Code::kTwoT];
+  size_t data_pos[Code::kN], parity_pos[Code::kN];
+  size_t num_data = 0, num_parity = 0, corrections;
+
+  memset(data, 0, sizeof(data));
+  valid.Fill(true);
+
+  for (size_t j = 0; j < Code::kN; j++) {
+    if (is_c1_parity(c1_offset(track, 0, j)))
+      parity_pos[num_parity++] = j;
+    else
+      data_pos[num_data++] = j;
+  }
+
+  memset(word, 0, sizeof(word));
+  word[data_pos[0]] = 0x37;
+  erasures[0] = Code::Power(data_pos[5]);
+  erasures[1] = Code::Power(data_pos[11]);
+  erasures[2] = Code::Power(parity_pos[0]);
+  erasures[3] = Code::Power(parity_pos[1]);
+  Code::Syndromes().Compute(word, syndrome);
+  Code::Correct(word, syndrome, erasures, Code::kTwoT, corrections);
+  word[parity_pos[1]] = 0;
+  for (size_t k = 0; k <= 4; k += 4)
+    for (size_t j = 0; j < Code::kN; j++)
+      base[c1_offset(track, k, j)] = word[j];
+
+  for (size_t k = 8; k <= 16; k += 4)
+    for (size_t i = 0; i < 8; i++)
+      base[c1_offset(track, k, data_pos[i * 3 + 1])] ^= 0x11 * (i + 1);
+}
+
+//
+// A track whose reliabilities can be set by hand.
+//
+class DistrustedTrack : public Track {
+public:
+  DistrustedTrack() : Track(Track::HEAD_A) {
+    memset(mReliability, kReliable, sizeof(mReliability));
+  }
+
+  void Distrust(size_t offset, uint8_t reliability) {
+    (&mReliability[0][0])[offset] = reliability;
+  }
+};
+
+//
+// Where the j-th byte of C2 codeword k lives in the track.
+//
+static size_t
+c2_offset(Track& track, size_t k, size_t j)
+{
+  ECCFill_C2 fill(track);
+
+  for (size_t i = 0; i < k; i++)
+    fill.Next();
+
+  return &fill.Data(j) - &track.ModifiableData()[0][0];
+}
+
+//
+// Damage C2 codeword 0 of a zero track with five errors, so that it is
+// four bytes away from another valid codeword, and distrust two of the
+// bytes that are still right. Treating those two as erasures lets the
+// decoder reach the other codeword with two more errors, using every
+// check byte -- a wrong guess that must not be taken.
+//
+static const size_t kSupport[7] = { 0, 3, 7, 11, 15, 20, 25 };
+static const size_t kStray = 29;
+
+static void
+damage_for_wrong_guess(DistrustedTrack& track)
+{
+  typedef ECC_C2::Code Code;
+  Track::DataArray& data = track.ModifiableData();
+  Track::ValidityArray& valid = track.ModifiableDataValid();
+  uint8_t *base = &data[0][0];
+  uint8_t word[Code::kN], syndrome[Code::kTwoT], erasures[Code::kTwoT];
+  size_t corrections;
+
+  memset(data, 0, sizeof(data));
+  valid.Fill(true);
+
+  //
+  // The other codeword: nonzero at exactly the seven support positions.
+  //
+  memset(word, 0, sizeof(word));
+  word[kSupport[0]] = 0x37;
+  for (size_t e = 0; e < Code::kTwoT; e++)
+    erasures[e] = Code::Power(kSupport[e + 1]);
+  Code::Syndromes().Compute(word, syndrome);
+  Code::Correct(word, syndrome, erasures, Code::kTwoT, corrections);
+
+  //
+  // Take four of its bytes, and one more error outside it.
+  //
+  for (size_t e = 0; e < 4; e++)
+    base[c2_offset(track, 0, kSupport[e])] = word[kSupport[e]];
+  base[c2_offset(track, 0, kStray)] = 0x5a;
+
+  track.Distrust(c2_offset(track, 0, kSupport[4]), Track::kReliable - 2);
+  track.Distrust(c2_offset(track, 0, kSupport[5]), Track::kReliable - 1);
+}
+
+//
+// Are the given bytes of C2 codeword k still zero?
+//
+static bool
+still_zero(Track& track, size_t k, const size_t *positions, size_t count)
+{
+  const uint8_t *base = &track.ModifiableData()[0][0];
+
+  for (size_t i = 0; i < count; i++)
+    if (base[c2_offset(track, k, positions[i])] != 0)
+      return false;
+
+  return true;
+}
+
+static bool
+only_data_is_zero(Track& track)
+{
+  const uint8_t *base = &track.ModifiableData()[0][0];
+  const Track::ValidityArray& valid = track.DataValid();
+
+  for (size_t i = 0; i < Track::kBlocks * Track::kBlockSize; i++)
+    if (!is_c1_parity(i) && (base[i] != 0 || !valid.Test(i)))
+      return false;
+
+  return true;
+}
+
+void
+test_batch(TestSession& ts)
+{
+  Track *track = new Track(Track::HEAD_A);
+
+  ts.BeginTest("C1 gather map matches the fill iterator");
+  ts.EndTest(map_matches<ECC_C1, ECCFill_C1::kVectors>(*track,
+    ECCFill_C1(*track)));
+
+  ts.BeginTest("C2 gather map matches the fill iterator");
+  ts.EndTest(map_matches<ECC_C2, ECCFill_C2::kVectors>(*track,
+    ECCFill_C2(*track)));
+
+  //
+  // An all-zero track is made of valid codewords. Damage one byte in each
+  // of a few blocks; each is one C1 codeword's single error.
+  //
+  ts.BeginTest("Batch correction repairs scattered errors");
+  Track::DataArray& data = track->ModifiableData();
+  Track::ValidityArray& valid = track->ModifiableDataValid();
+  memset(data, 0, sizeof(data));
+  valid.Fill(true);
+  const size_t kDamaged = 10;
+  for (size_t i = 0; i < kDamaged; i++)
+    data[i * 13][(i * 7) % Track::kBlockSize] = 0x5a + i;
+  track->Complete();
+  bool ok = track->C1Errors() == kDamaged &&
+            track->C1UncorrectableErrors() == 0;
+  for (size_t b = 0; b < Track::kBlocks; b++)
+    for (size_t i = 0; i < Track::kBlockSize; i++)
+      ok = ok && data[b][i] == 0 && valid.Test(b * Track::kBlockSize + i);
+  ts.EndTest(ok);
+
+  delete track;
+
+  ts.BeginTest("One correction pass leaves crossed damage");
+  track = new Track(Track::HEAD_A);
+  damage_for_iteration(*track);
+  track->Complete();
+  ts.EndTest(track->C1UncorrectableErrors() == 5 &&
+             track->C2UncorrectableErrors() == 3 &&
+             track->ExtraPasses() == 0);
+
+  ts.BeginTest("Extra correction passes repair crossed damage");
+  delete track;
+  track = new Track(Track::HEAD_A);
+  Track::SetCorrectionPasses(4);
+  damage_for_iteration(*track);
+  track->Complete();
+  Track::SetCorrectionPasses(1);
+  ts.EndTest(track->C2UncorrectableErrors() == 0 &&
+             track->ExtraPasses() == 1 && track->RescuedBytes(0) > 0 &&
+             only_data_is_zero(*track));
+
+  ts.BeginTest("C2 alone can't see through C1 miscorrections");
+  delete track;
+  track = new Track(Track::HEAD_A);
+  damage_for_reliability(*track);
+  track->Complete();
+  ts.EndTest(track->C1UncorrectableErrors() == 3 &&
+             track->C2UncorrectableErrors() == 3 &&
+             track->Reliability()[0][0] < Track::kReliable);
+
+  ts.BeginTest("Reliability retries see through C1 miscorrections");
+  delete track;
+  track = new Track(Track::HEAD_A);
+  Track::SetReliabilityTrials(2);
+  damage_for_reliability(*track);
+  track->Complete();
+  Track::SetReliabilityTrials(0);
+  ts.EndTest(track->C2UncorrectableErrors() == 0 &&
+             track->ReliabilityRescues() == 3 && only_data_is_zero(*track));
+
+  delete track;
+
+  ts.BeginTest("Reliability retries refuse a guess that uses every check");
+  DistrustedTrack *distrusted = new DistrustedTrack();
+  Track::SetReliabilityTrials(2);
+  damage_for_wrong_guess(*distrusted);
+  distrusted->CompleteC2();
+  Track::SetReliabilityTrials(0);
+  ts.EndTest(distrusted->C2UncorrectableErrors() == 1 &&
+             distrusted->ReliabilityRescues() == 0 &&
+             still_zero(*distrusted, 0, kSupport + 4, 3));
+  delete distrusted;
+}
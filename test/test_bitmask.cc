@@ -0,0 +1,157 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "BitMask.h"
+
+//
+// 200 bits: three full words and a partial one.
+//
+typedef BitMask<200> Mask;
+
+static bool
+expected(size_t i)
+{
+  return (i * 37) % 5 < 3;
+}
+
+static void
+fill_pattern(Mask& mask)
+{
+  for (size_t i = 0; i < Mask::kSize; i++)
+    mask.Set(i, expected(i));
+}
+
+static bool
+set_and_count()
+{
+  Mask mask;
+  size_t count = 0;
+
+  if (mask.Count() != 0)
+    return false;
+
+  fill_pattern(mask);
+  for (size_t i = 0; i < Mask::kSize; i++) {
+    if (mask.Test(i) != expected(i))
+      return false;
+    count += expected(i);
+  }
+  if (mask.Count() != count || mask.All())
+    return false;
+
+  mask.Fill(true);
+  return mask.All() && mask.Count() == Mask::kSize;
+}
+
+static bool
+get_and_put()
+{
+  Mask mask;
+
+  fill_pattern(mask);
+  for (size_t first = 0; first + 64 <= Mask::kSize; first += 7) {
+    for (size_t n = 1; n <= 64; n += 9) {
+      uint64_t bits = mask.Get(first, n);
+      for (size_t i = 0; i < n; i++)
+        if (((bits >> i) & 1) != expected(first + i))
+          return false;
+      if (n < 64 && (bits >> n) != 0)
+        return false;
+
+      //
+      // Write the bits back inverted, then restore them; nothing outside
+      // the range may change.
+      //
+      mask.Put(first, n, ~bits);
+      for (size_t i = 0; i < Mask::kSize; i++)
+        if (mask.Test(i) != (expected(i) ^ (i >= first && i < first + n)))
+          return false;
+      mask.Put(first, n, bits);
+    }
+  }
+
+  return true;
+}
+
+static bool
+copy_from()
+{
+  Mask mask;
+  BitMask<100> part;
+
+  fill_pattern(mask);
+  part.CopyFrom(mask, 67);
+  for (size_t i = 0; i < 100; i++)
+    if (part.Test(i) != expected(67 + i))
+      return false;
+
+  part.Fill(true);
+  part.CopyFrom(mask, 0);
+  return part.Get(64, 36) == mask.Get(64, 36) && part.Test(99) == expected(99);
+}
+
+static bool
+find_clear()
+{
+  Mask mask;
+  size_t positions[Mask::kSize];
+  size_t count, i, k;
+
+  fill_pattern(mask);
+  count = mask.FindClear(positions, Mask::kSize);
+  if (count != Mask::kSize - mask.Count())
+    return false;
+  for (i = 0, k = 0; i < Mask::kSize; i++)
+    if (!expected(i) && (k >= count || positions[k++] != i))
+      return false;
+
+  //
+  // A short list stops early; no bits past the end are ever reported.
+  //
+  if (mask.FindClear(positions, 3) != 3 || positions[2] != 7)
+    return false;
+  mask.Fill(true);
+  return mask.FindClear(positions, Mask::kSize) == 0;
+}
+
+void
+test_bitmask(TestSession& ts)
+{
+  ts.BeginTest("Bit mask set, test and count");
+  ts.EndTest(set_and_count());
+
+  ts.BeginTest("Bit mask ranges across word boundaries");
+  ts.EndTest(get_and_put());
+
+  ts.BeginTest("Bit mask copy from a shifted range");
+  ts.EndTest(copy_from());
+
+  ts.BeginTest("Bit mask clear bit positions");
+  ts.EndTest(find_clear());
+}
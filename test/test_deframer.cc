@@ -0,0 +1,156 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "NRZISyncDeframer.h"
+#include "DATWordReceiver.h"
+#include "DATBlockReceiver.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+//
+// Folds everything that arrives at the block level into a running hash.
+//
+class BlockRecorder : public DATBlockReceiver {
+public:
+  BlockRecorder() : mHash(2166136261u), mBlocks(0) {}
+
+  void Add(uint32_t v) { mHash = (mHash ^ v) * 16777619u; }
+
+  void TrackDetected(bool up) { Add(up ? 0x10000 : 0x20000); }
+  void ReceiveBlock(const DATBlock& b) {
+    const uint16_t *words = b.LineWords();
+    const uint16_t *bytes = b.FlaggedBytes();
+    for (size_t i = 0; i < b.Size(); i++) {
+      Add(words[i]);
+      Add(bytes[i]);
+    }
+    Add(0x30000);
+    mBlocks++;
+  }
+  void ReceiveATFTone(int tone) { Add(0x40000 | tone); }
+  void Stop() { Add(0x50000); }
+
+  uint32_t mHash;
+  size_t mBlocks;
+};
+
+//
+// A line signal of random bits, with runs of pre-amble and plenty of
+// sync patterns, NRZI encoded.
+//
+static void
+make_line(bool *line, size_t count)
+{
+  static const bool kSync[10] = { 0, 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+  bool level = false;
+  size_t i = 0, k;
+
+  while (i < count) {
+    long r = random() % 100;
+    if (r < 5) {
+      for (k = 0; k < 120 && i < count; k++) {
+        level = !level;
+        line[i++] = level;
+      }
+    } else if (r < 30) {
+      for (k = 0; k < 10 && i < count; k++) {
+        if (kSync[k])
+          level = !level;
+        line[i++] = level;
+      }
+    } else {
+      if (random() & 1)
+        level = !level;
+      line[i++] = level;
+    }
+  }
+}
+
+//
+// Feed the line to a deframer either a bit at a time or in random-sized
+// packed batches, with clock and track events interspersed at the same
+// places, and hash the result.
+//
+static uint32_t
+deframe(const bool *line, size_t count, bool batched, size_t *blocks)
+{
+  BlockRecorder rec;
+  DATWordReceiver words(&rec, false);
+  NRZISyncDeframer deframer(&words);
+  size_t i = 0, k, n;
+
+  srandom(2);
+  while (i < count) {
+    if (random() % 50 == 0) {
+      switch (random() % 3) {
+      case 0: deframer.TrackDetected(true); break;
+      case 1: deframer.TrackDetected(false); break;
+      default: deframer.ClockDetected(false); break;
+      }
+    }
+    rec.Add(deframer.PreambleDetected());
+
+    n = 1 + random() % 64;
+    if (n > count - i)
+      n = count - i;
+    if (batched) {
+      uint64_t bits = 0;
+      for (k = 0; k < n; k++)
+        bits = (bits << 1) | line[i + k];
+      deframer.ReceiveBits(bits, n);
+    } else {
+      for (k = 0; k < n; k++)
+        deframer.ReceiveBit(line[i + k]);
+    }
+    i += n;
+  }
+  deframer.Stop();
+
+  *blocks = rec.mBlocks;
+  return rec.mHash;
+}
+
+void
+test_deframer(TestSession& ts)
+{
+  const size_t kBits = 200000;
+  static bool line[kBits];
+  size_t bitBlocks, batchBlocks;
+
+  srandom(1);
+  make_line(line, kBits);
+
+  ts.BeginTest("Batched deframer matches bit-at-a-time deframer");
+  uint32_t bitHash = deframe(line, kBits, false, &bitBlocks);
+  uint32_t batchHash = deframe(line, kBits, true, &batchBlocks);
+  ts.EndTest(bitBlocks > 0 && bitHash == batchHash &&
+             bitBlocks == batchBlocks);
+}
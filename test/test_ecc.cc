@@ -196,21 +196,48 @@ public:
   // ECCFill methods.
   //
   uint8_t& Data(size_t position);
-  bool&    Valid(size_t position);
+  bool     Valid(size_t position) const;
+  void     SetValid(size_t position, bool valid);
   
   size_t  mCurrentOffset;
   uint8_t mData[kBlocks][kBlockSize];
   bool    mValid[kBlocks][kBlockSize];
 };
 
+//
+// Walks the two vectors of a block pair, as the track fill iterators do,
+// so that a screen can gather them.
+//
+class BlockPairIterator {
+public:
+  BlockPairIterator(BlockPair& pair) : mPair(pair), mOffset(0) {}
+
+  bool     End() const { return mOffset == 2; }
+  void     Next() { mOffset++; }
+  uint8_t& Data(size_t position) {
+    mPair.FillFrom(mOffset);
+    return mPair.Data(position);
+  }
+  bool     Valid(size_t position) const {
+    mPair.FillFrom(mOffset);
+    return mPair.Valid(position);
+  }
+
+protected:
+  BlockPair& mPair;
+  size_t     mOffset;
+};
+
 static bool
 c1_test(const ECC_Test *test_vector)
 {
   ECC_C1 vp;
-  ECC_C1::Status stati[2];
+  ECC_C1::Status stati[2], screened_stati[2];
   bool comparisons[2];
 
   BlockPair input(test_vector->input, test_vector->erasures);
+  BlockPair screened(test_vector->input, test_vector->erasures);
+  ECC_Screen<ECC_C1, 2> screen;
 
   BlockPair *output = NULL;
   if (test_vector->answer[0] != NULL) {
@@ -245,6 +272,18 @@ c1_test(const ECC_Test *test_vector)
     //
     vp.Dump(input);
   }
+
+  //
+  // Filling from a screen, with the syndromes already worked out, must
+  // come to the same thing.
+  //
+  screen.Screen(BlockPairIterator(screened));
+  for (size_t i = 0; i < 2; i++) {
+    vp.Fill(screen, i);
+    screened_stati[i] = vp.Correct();
+    screened.FillFrom(i);
+    vp.Dump(screened);
+  }
   
   //
   // Check results.
@@ -253,7 +292,10 @@ c1_test(const ECC_Test *test_vector)
 
   for (size_t i = 0; i < 2; i++) {
     ok = ok && stati[i] == test_vector->results[i];
+    ok = ok && screened_stati[i] == stati[i];
   }
+  ok = ok && memcmp(input.mData, screened.mData, sizeof(input.mData)) == 0 &&
+       memcmp(input.mValid, screened.mValid, sizeof(input.mValid)) == 0;
 
   if (output != NULL) {
     for (size_t i = 0; i < input.kBlocks; i++) {
@@ -311,12 +353,18 @@ BlockPair::Data(size_t position)
   return mData[position / 16][(position % 16) * 2 + mCurrentOffset];
 }
 
-bool&
-BlockPair::Valid(size_t position)
+bool
+BlockPair::Valid(size_t position) const
 {
   return mValid[position / 16][(position % 16) * 2 + mCurrentOffset];
 }
 
+void
+BlockPair::SetValid(size_t position, bool valid)
+{
+  mValid[position / 16][(position % 16) * 2 + mCurrentOffset] = valid;
+}
+
 static bool
 hex_decode(const char *s, uint8_t *r, size_t n)
 {
@@ -0,0 +1,123 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "Track.h"
+#include "DATFrame.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Where byte 'column' of frame row 'word' comes from, worked out the long
+// way, from the DDS spec (Section 9.3.4 G4 Sub-Group).
+//
+static void
+frame_source(size_t word, size_t column, bool& from_a, size_t& offset)
+{
+  size_t source_block =
+                             (word %  52) +
+                        75 * (word %   2) +
+                             (word / 832);
+  size_t u = (column + 1) % 2;
+  size_t source_byte =
+                        2  * (u + word /  52)     -
+                             (    word /  52) % 2 -
+                        32 * (    word / 832);
+
+  from_a = ((word % 2) == 0) == (column < 2);
+  offset = source_block * Track::kBlockSize + source_byte;
+}
+
+static void
+random_track(Track& track)
+{
+  uint8_t *data = &track.ModifiableData()[0][0];
+  Track::ValidityArray& valid = track.ModifiableDataValid();
+
+  for (size_t i = 0; i < Track::ValidityArray::kSize; i++) {
+    data[i] = random() & 0xff;
+    valid.Set(i, (random() % 8) != 0);
+  }
+}
+
+void
+test_frame(TestSession& ts)
+{
+  Track *a = new Track(Track::HEAD_A);
+  Track *b = new Track(Track::HEAD_B);
+  DATFrame *frame = new DATFrame();
+  const uint8_t *a_data = &a->Data()[0][0];
+  const uint8_t *b_data = &b->Data()[0][0];
+  bool ok;
+
+  srandom(22);
+  random_track(*a);
+  random_track(*b);
+  frame->FillFromTrackPair(*a, *b);
+
+  ts.BeginTest("Frame schedule demultiplexes every byte");
+  DATFrameView view(*a, *b);
+  ok = true;
+  for (size_t row = 0; row < DATFrameView::kRows; row++) {
+    for (size_t column = 0; column < DATFrame::kBytesPerRow; column++) {
+      bool from_a;
+      size_t offset;
+      frame_source(row, column, from_a, offset);
+      const uint8_t byte = from_a ? a_data[offset] : b_data[offset];
+      const bool valid = from_a ? a->DataValid().Test(offset) :
+                                  b->DataValid().Test(offset);
+      ok = ok && frame->Data()[row][column] == byte &&
+           view.Byte(row, column) == byte &&
+           frame->Valid().Test(row * DATFrame::kBytesPerRow + column) ==
+             valid;
+    }
+  }
+  ts.EndTest(ok);
+
+  ts.BeginTest("Frame view gathers part of a frame");
+  const size_t kFirst = 1, kCount = DATFrame::kUserDataRows - 1;
+  uint8_t rows[kCount][DATFrame::kBytesPerRow];
+  BitMask<kCount * DATFrame::kBytesPerRow> valid;
+  bool all = view.Gather(kFirst, kCount, &rows[0][0], valid);
+  ok = !all && memcmp(rows, frame->Data()[kFirst], sizeof(rows)) == 0;
+  for (size_t i = 0; i < valid.kSize; i++)
+    ok = ok && valid.Test(i) ==
+         frame->Valid().Test(kFirst * DATFrame::kBytesPerRow + i);
+  ts.EndTest(ok);
+
+  ts.BeginTest("Frame view sees when every byte is good");
+  a->ModifiableDataValid().Fill(true);
+  b->ModifiableDataValid().Fill(true);
+  ts.EndTest(view.Gather(kFirst, kCount, &rows[0][0], valid) &&
+             valid.All());
+
+  delete frame;
+  delete b;
+  delete a;
+}
@@ -0,0 +1,129 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "Track.h"
+#include "TrackPool.h"
+#include "DATTrackFramer.h"
+#include "FrameRecorder.h"
+
+//
+// Feed the framer the track numbered 'number', read by 'head', with frame
+// key 'key'.
+//
+static void
+send(DATTrackFramer& framer, int number, int key,
+  Track::Head head = Track::HEAD_UNKNOWN)
+{
+  Track *track = TrackPool::Shared().Get(head);
+
+  track->SetATFCounts(key, number);
+  framer.ReceiveTrack(track);
+}
+
+void
+test_framer(TestSession& ts)
+{
+  {
+    ts.BeginTest("Framer pairs tracks by frame key");
+    FrameRecorder frames;
+    DATTrackFramer framer(frames);
+    framer.SetVerbose(false);
+    send(framer, 1, 1, Track::HEAD_A);
+    send(framer, 2, 1);
+    send(framer, 3, 2);
+    send(framer, 4, 2);
+    framer.Stop();
+    const int expect[] = { 1, 2, 3, 4, 0 };
+    ts.EndTest(frames.Received(expect) && framer.DiscardedTracks() == 0);
+  }
+
+  {
+    ts.BeginTest("Framer pairs tracks past a stray");
+    FrameRecorder frames;
+    DATTrackFramer framer(frames);
+    framer.SetVerbose(false);
+    send(framer, 1, 1);
+    send(framer, 2, 7);
+    send(framer, 3, 1);
+    framer.Stop();
+    const int expect[] = { 1, 3, 0 };
+    ts.EndTest(frames.Received(expect) && framer.RecoveredFrames() == 1 &&
+               framer.DiscardedTracks() == 1);
+  }
+
+  {
+    ts.BeginTest("Framer infers a pair missing a frame key, in order");
+    FrameRecorder frames;
+    DATTrackFramer framer(frames);
+    framer.SetVerbose(false);
+    send(framer, 1, 1);
+    send(framer, 2, 1);
+    send(framer, 3, 2);
+    send(framer, 4, 0);
+    send(framer, 5, 3);
+    send(framer, 6, 3);
+    framer.Stop();
+    const int expect[] = { 1, 2, 3, 4, 5, 6, 0 };
+    ts.EndTest(frames.Received(expect) && framer.InferredFrames() == 1 &&
+               framer.DiscardedTracks() == 0);
+  }
+
+  {
+    ts.BeginTest("Framer infers a pair from order and azimuth alone");
+    FrameRecorder frames;
+    DATTrackFramer framer(frames);
+    framer.SetVerbose(false);
+    send(framer, 1, 1);
+    send(framer, 2, 1);
+    send(framer, 3, 0, Track::HEAD_A);
+    send(framer, 4, 0);
+    send(framer, 5, 0);
+    send(framer, 6, 0);
+    framer.Stop();
+    const int expect[] = { 1, 2, 3, 4, 0 };
+    ts.EndTest(frames.Received(expect) && framer.InferredFrames() == 1 &&
+               framer.DiscardedTracks() == 2);
+  }
+
+  {
+    ts.BeginTest("Framer keeps apart tracks of different frames");
+    FrameRecorder frames;
+    DATTrackFramer framer(frames);
+    framer.SetVerbose(false);
+    send(framer, 1, 5);
+    send(framer, 2, 6, Track::HEAD_A);
+    send(framer, 3, 6);
+    send(framer, 4, 8, Track::HEAD_A);
+    send(framer, 5, 0, Track::HEAD_A);
+    framer.Stop();
+    const int expect[] = { 2, 3, 0 };
+    ts.EndTest(frames.Received(expect) && framer.InferredFrames() == 0 &&
+               framer.DiscardedTracks() == 3);
+  }
+}
@@ -0,0 +1,165 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+
+#include "tests.h"
+#include "Track.h"
+#include "TrackPool.h"
+#include "CaptureFusion.h"
+#include "FrameRecorder.h"
+
+//
+// A read of an all-zero track with frame key 'key', every byte valid and
+// fully trusted.
+//
+static Track *
+read_track(int key)
+{
+  Track *track = TrackPool::Shared().Get(Track::HEAD_UNKNOWN);
+
+  track->ModifiableDataValid().Fill(true);
+  track->CompleteC1();
+  track->SetATFCounts(key, 0);
+
+  return track;
+}
+
+//
+// Hand capture 'capture' of 'fusion' a frame with frame key 'key'.
+//
+static void
+send(CaptureFusion& fusion, size_t capture, int key)
+{
+  Track *a = read_track(key);
+  Track *b = read_track(key);
+
+  fusion.Input(capture).ReceiveFrame(*a, *b);
+  TrackPool::Shared().Put(a);
+  TrackPool::Shared().Put(b);
+}
+
+void
+test_fusion(TestSession& ts)
+{
+  {
+    ts.BeginTest("Fusion votes each byte across reads");
+    Track *reads[3];
+    for (size_t r = 0; r < 3; r++)
+      reads[r] = read_track(1);
+
+    // Outvoted.
+    reads[0]->ModifiableData()[5][3] = 0x11;
+    // Only one read has it.
+    reads[0]->ModifiableDataValid().Set(7 * Track::kBlockSize, false);
+    reads[1]->ModifiableDataValid().Set(7 * Track::kBlockSize, false);
+    reads[2]->ModifiableData()[7][0] = 0x42;
+    // A tie.
+    reads[0]->ModifiableData()[9][1] = 0x01;
+    reads[1]->ModifiableData()[9][1] = 0x02;
+    reads[2]->ModifiableDataValid().Set(9 * Track::kBlockSize + 1, false);
+
+    Track *fused = TrackPool::Shared().Get(Track::HEAD_UNKNOWN);
+    fused->Fuse(reads, 3);
+    const Track::ValidityArray& valid = fused->DataValid();
+    ts.EndTest(fused->Data()[5][3] == 0x00 &&
+               valid.Test(5 * Track::kBlockSize + 3) &&
+               fused->Data()[7][0] == 0x42 &&
+               valid.Test(7 * Track::kBlockSize) &&
+               !valid.Test(9 * Track::kBlockSize + 1) &&
+               fused->Reliability()[9][1] == 0 &&
+               fused->ATF2Count() == 1);
+
+    TrackPool::Shared().Put(fused);
+    for (size_t r = 0; r < 3; r++)
+      TrackPool::Shared().Put(reads[r]);
+  }
+
+  {
+    ts.BeginTest("Fusion lines up captures by frame key");
+    FrameRecorder frames;
+    CaptureFusion fusion(frames, 2);
+    send(fusion, 0, 1);
+    send(fusion, 0, 2);
+    send(fusion, 0, 3);
+    fusion.Input(0).Stop();
+    send(fusion, 1, 2);
+    send(fusion, 1, 3);
+    send(fusion, 1, 4);
+    fusion.Input(1).Stop();
+    fusion.Stop();
+    const int expect[] = { 1, 2, 3, 4, 0 };
+    ts.EndTest(frames.ReceivedKeys(expect) && frames.Stopped() &&
+               fusion.Frames() == 4 && fusion.FusedFrames() == 2);
+  }
+
+  {
+    ts.BeginTest("Fusion lines up a frame the leading capture missed");
+    FrameRecorder frames;
+    CaptureFusion fusion(frames, 2);
+    send(fusion, 0, 1);
+    send(fusion, 0, 3);
+    send(fusion, 0, 4);
+    fusion.Input(0).Stop();
+    send(fusion, 1, 1);
+    send(fusion, 1, 2);
+    send(fusion, 1, 3);
+    send(fusion, 1, 4);
+    fusion.Input(1).Stop();
+    fusion.Stop();
+    const int expect[] = { 1, 2, 3, 4, 0 };
+    ts.EndTest(frames.ReceivedKeys(expect) && frames.Stopped() &&
+               fusion.Frames() == 4 && fusion.FusedFrames() == 3);
+  }
+
+  {
+    ts.BeginTest("Fusion lines up captures handing in frames in turn");
+    FrameRecorder frames;
+    CaptureFusion fusion(frames, 2);
+    const int keys[2][4] = { { 1, 3, 4, 5 }, { 1, 2, 3, 5 } };
+    for (size_t i = 0; i < 4; i++)
+      for (size_t c = 0; c < 2; c++)
+        send(fusion, c, keys[c][i]);
+    fusion.Stop();
+    const int expect[] = { 1, 2, 3, 4, 5, 0 };
+    ts.EndTest(frames.ReceivedKeys(expect) && frames.Stopped() &&
+               fusion.Frames() == 5 && fusion.FusedFrames() == 3);
+  }
+
+  {
+    ts.BeginTest("Fusion drops frames without a frame key");
+    FrameRecorder frames;
+    CaptureFusion fusion(frames, 2);
+    send(fusion, 0, 1);
+    send(fusion, 1, 0);
+    send(fusion, 1, 1);
+    fusion.Stop();
+    const int expect[] = { 1, 0 };
+    ts.EndTest(frames.ReceivedKeys(expect) && frames.Stopped() &&
+               fusion.FusedFrames() == 1 && fusion.UnkeyedFrames() == 1);
+  }
+}
@@ -0,0 +1,96 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "GapScanner.h"
+#include "SampleConverter.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+//
+// Fill a stretch of signal with low-level noise, or with a random
+// full-scale NRZ signal if 'track' is set.
+//
+static void
+fill(float *signal, size_t start, size_t end, bool track)
+{
+  float level = 0.5;
+
+  for (size_t i = start; i < end; i++) {
+    if (track && i % 8 == 0 && (random() & 1))
+      level = -level;
+    float noise = (random() % 2001 - 1000) / 50000.0;
+    signal[i] = (track ? level : 0) + noise;
+  }
+}
+
+void
+test_gapscanner(TestSession& ts)
+{
+  const size_t kSamples = 2000000;
+  const size_t B = GapScanner::kBlockSize;
+  static float signal[kSamples];
+  SampleConverter converter;
+  GapScanner scanner(converter);
+  size_t split;
+  bool ok;
+
+  srandom(1);
+
+  //
+  // Tracks with a long gap between, and a short dropout that isn't a gap.
+  //
+  fill(signal, 0, 300000, true);
+  fill(signal, 300000, 500000, false);
+  fill(signal, 500000, 900000, true);
+  fill(signal, 900000, 900000 + 8 * B, false);
+  fill(signal, 900000 + 8 * B, 1400000, true);
+  fill(signal, 1400000, 1700000, false);
+  fill(signal, 1700000, kSamples, true);
+
+  ts.BeginTest("GapScanner splits shortly before the end of a gap");
+  ok = true;
+  for (size_t from = 0; from < 250000; from += 12345) {
+    split = scanner.FindSplit(signal, kSamples, from);
+    ok = ok && split > 300000 && split + 2 * B <= 500000 &&
+         split + (GapScanner::kSettleBlocks + 1) * B >= 500000;
+  }
+  ts.EndTest(ok);
+
+  ts.BeginTest("GapScanner skips short dropouts");
+  split = scanner.FindSplit(signal, kSamples, 600000);
+  ts.EndTest(split > 1400000 && split + 2 * B <= 1700000);
+
+  ts.BeginTest("GapScanner reports no gap");
+  ok = scanner.FindSplit(signal, kSamples, 1500000) == kSamples;
+  ok = ok && scanner.FindSplit(signal, 1400000, 600000) == 1400000;
+  ok = ok && scanner.FindSplit(signal, kSamples, kSamples + 5) == kSamples;
+  ts.EndTest(ok);
+}
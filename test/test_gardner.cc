@@ -0,0 +1,118 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "RDATGardnerDecoder.h"
+#include "SymbolDecoder.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+//
+// Collects the bits the decoder slices.
+//
+class BitRecorder : public SymbolDecoder {
+public:
+  BitRecorder() : mCount(0), mLocked(false) {}
+
+  void Reset() {}
+  void ClockDetected(bool detected) { mLocked = detected; }
+  void ReceiveBit(bool bit) {
+    if (mCount < kMaxBits)
+      mBits[mCount++] = bit;
+  }
+  bool PreambleDetected() const { return false; }
+  void TrackDetected(bool started) {}
+  void Stop() {}
+
+  static const size_t kMaxBits = 8192;
+  bool mBits[kMaxBits];
+  size_t mCount;
+  bool mLocked;
+};
+
+void
+test_gardner(TestSession& ts)
+{
+  const float kSymbolRate = 9408000;
+  const float kSampleRate = 25000000;
+  const size_t kSymbols = 4000;
+  static bool symbols[kSymbols];
+  BitRecorder rec;
+  RDATGardnerDecoder dec(kSampleRate);
+  size_t i;
+
+  srandom(1);
+  for (i = 0; i < kSymbols; i++)
+    symbols[i] = random() & 1;
+
+  //
+  // Render the symbols as a crude band-limited NRZ waveform, with the
+  // edges linearly ramped over a third of a symbol.
+  //
+  dec.SetSymbolDecoder(&rec);
+  size_t samples = (size_t) (kSymbols * kSampleRate / kSymbolRate);
+  for (i = 0; i < samples; i++) {
+    float t = (i + 0.3) * kSymbolRate / kSampleRate;
+    size_t k = (size_t) t;
+    float frac = t - k;
+    float cur = symbols[k] ? 1.0 : -1.0;
+    float v = cur;
+    if (frac < 1.0 / 6.0 && k > 0) {
+      float prev = symbols[k - 1] ? 1.0 : -1.0;
+      v = prev + (cur - prev) * (frac + 1.0 / 6.0) * 3.0;
+    } else if (frac > 5.0 / 6.0 && k + 1 < kSymbols) {
+      float next = symbols[k + 1] ? 1.0 : -1.0;
+      v = cur + (next - cur) * (frac - 5.0 / 6.0) * 3.0;
+    }
+    dec.Process(&v, 1);
+  }
+
+  ts.BeginTest("Gardner decoder locks at 25 MHz");
+  ts.EndTest(rec.mLocked && rec.mCount > kSymbols / 2);
+
+  //
+  // Once locked, the tail of the recovered bits should match the tail of
+  // the transmitted symbols exactly.
+  //
+  ts.BeginTest("Gardner decoder recovers symbols");
+  const size_t kCompare = 1000;
+  bool found = false;
+  for (size_t shift = 0; !found && shift < 8; shift++) {
+    bool match = true;
+    for (i = 0; match && i < kCompare; i++) {
+      size_t s = kSymbols - 1 - shift - i;
+      size_t b = rec.mCount - 1 - i;
+      match = symbols[s] == rec.mBits[b];
+    }
+    found = match;
+  }
+  ts.EndTest(found);
+}
@@ -0,0 +1,201 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "ECC_GF28.h"
+#include "ECC_GF28_Arith.h"
+#include "ReedSolomon.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Every product, and scaling at every length up to a few vectors' worth,
+// against the field's own multiplication.
+//
+template <class GF>
+static bool
+arithmetic_matches()
+{
+  uint8_t in[40], out[40];
+
+  for (unsigned int a = 0; a < 256; a++) {
+    for (unsigned int b = 0; b < 256; b++)
+      if (GF::Multiply(a, b) != ECC_GF28_multiply(a, b))
+        return false;
+    if (GF::Invert(a) != ECC_GF28_invert(a))
+      return false;
+    if (a < 255 && GF::PowAlpha(a) != ECC_GF28_pow_alpha(a))
+      return false;
+    if (a > 0 && GF::LogAlpha(a) != ECC_GF28_log_alpha(a))
+      return false;
+  }
+
+  for (size_t n = 0; n <= sizeof(in); n++) {
+    for (size_t i = 0; i < sizeof(in); i++)
+      in[i] = random() & 0xff;
+    memset(out, 0xaa, sizeof(out));
+
+    uint8_t s = random() & 0xff;
+    GF::Scale(in, s, out, n);
+    for (size_t i = 0; i < sizeof(out); i++)
+      if (out[i] != (i < n ? ECC_GF28_multiply(in[i], s) : 0xaa))
+        return false;
+
+    GF::Scale(in, s, in, n);
+    if (memcmp(in, out, n) != 0)
+      return false;
+  }
+
+  return true;
+}
+
+//
+// Zero times zero, the largest sum of logarithms there is, and scaling
+// by zero, over zeros and otherwise.
+//
+template <class GF>
+static bool
+zeros_multiply()
+{
+  uint8_t in[40], out[40];
+
+  if (GF::Multiply(0, 0) != 0)
+    return false;
+
+  for (size_t i = 0; i < sizeof(in); i++)
+    in[i] = i % 2 == 0 ? 0 : 1 + random() % 255;
+  memset(out, 0xaa, sizeof(out));
+
+  GF::Scale(in, 0, out, sizeof(in));
+  for (size_t i = 0; i < sizeof(out); i++)
+    if (out[i] != 0)
+      return false;
+
+  return true;
+}
+
+//
+// Decode damaged C2-sized codewords, with errors and erasures, using the
+// given arithmetic.
+//
+template <class GF>
+static bool
+decodes()
+{
+  typedef ReedSolomon<32, 6> Code;
+
+  for (int trial = 0; trial < 200; trial++) {
+    uint8_t word[Code::kN], syndrome[Code::kTwoT], erasures[Code::kTwoT];
+    size_t corrections;
+
+    //
+    // Zero is a codeword. Give it one to three errors, or as many as six
+    // erasures.
+    //
+    memset(word, 0, sizeof(word));
+    size_t count = 1 + trial % Code::kTwoT;
+    bool erased = count > Code::kT;
+    for (size_t e = 0; e < count; e++) {
+      size_t j = (trial * 7 + e * 5) % Code::kN;
+      word[j] = 1 + (random() % 255);
+      erasures[e] = Code::Power(j);
+    }
+
+    if (Code::Syndromes().Compute(word, syndrome))
+      return false;
+    if (!Code::Decode<GF>(word, syndrome, erasures, erased ? count : 0,
+          corrections) || corrections != count)
+      return false;
+    for (size_t j = 0; j < Code::kN; j++)
+      if (word[j] != 0)
+        return false;
+  }
+
+  return true;
+}
+
+void
+test_gf28(TestSession& ts)
+{
+  for (size_t i = 0; i < ECC_GF28_Arith::kImplementations; i++) {
+    const ECC_GF28_Arith::Implementation implementation =
+      (ECC_GF28_Arith::Implementation) i;
+    const char *name = ECC_GF28_Arith::Name(implementation);
+
+    if (!ECC_GF28_Arith::Available(implementation))
+      continue;
+
+    ts.BeginTest("GF(2^8) arithmetic matches the field (%s)", name);
+    switch (implementation) {
+    case ECC_GF28_Arith::LOG_EXP:
+      ts.EndTest(arithmetic_matches<ECC_GF28_LogExp>());
+      break;
+    case ECC_GF28_Arith::PRODUCT_TABLE:
+      ts.EndTest(arithmetic_matches<ECC_GF28_ProductTable>());
+      break;
+    case ECC_GF28_Arith::AFFINE:
+      ts.EndTest(arithmetic_matches<ECC_GF28_Affine>());
+      break;
+    }
+
+    ts.BeginTest("GF(2^8) products of zero are zero (%s)", name);
+    switch (implementation) {
+    case ECC_GF28_Arith::LOG_EXP:
+      ts.EndTest(zeros_multiply<ECC_GF28_LogExp>());
+      break;
+    case ECC_GF28_Arith::PRODUCT_TABLE:
+      ts.EndTest(zeros_multiply<ECC_GF28_ProductTable>());
+      break;
+    case ECC_GF28_Arith::AFFINE:
+      ts.EndTest(zeros_multiply<ECC_GF28_Affine>());
+      break;
+    }
+
+    ts.BeginTest("Reed-Solomon decodes with %s arithmetic", name);
+    switch (implementation) {
+    case ECC_GF28_Arith::LOG_EXP:
+      ts.EndTest(decodes<ECC_GF28_LogExp>());
+      break;
+    case ECC_GF28_Arith::PRODUCT_TABLE:
+      ts.EndTest(decodes<ECC_GF28_ProductTable>());
+      break;
+    case ECC_GF28_Arith::AFFINE:
+      ts.EndTest(decodes<ECC_GF28_Affine>());
+      break;
+    }
+  }
+
+  const ECC_GF28_Arith::Implementation fastest = ECC_GF28_Arith::Fastest();
+
+  ts.BeginTest("GF(2^8) fastest arithmetic: %s (%.1f ns)",
+    ECC_GF28_Arith::Name(fastest), ECC_GF28_Arith::Benchmark(fastest));
+  ts.EndTest(ECC_GF28_Arith::Available(fastest) &&
+             ECC_GF28_Arith::Select(fastest) &&
+             ECC_GF28_Arith::Selected() == fastest);
+}
@@ -0,0 +1,131 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "ReedSolomon.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+//
+// Make a random codeword: fill it at random, then treat the first 2t
+// bytes as erasures and let the decoder fill them in.
+//
+template <class Code>
+static bool
+make_codeword(uint8_t (&word)[Code::kN])
+{
+  uint8_t syndrome[Code::kTwoT], erasures[Code::kTwoT];
+  size_t corrections;
+
+  for (size_t j = 0; j < Code::kN; j++)
+    word[j] = j < Code::kTwoT ? 0 : random() & 0xff;
+  for (size_t i = 0; i < Code::kTwoT; i++)
+    erasures[i] = Code::Power(i);
+
+  if (Code::Syndromes().Compute(word, syndrome))
+    return true;
+
+  return Code::Correct(word, syndrome, erasures, Code::kTwoT, corrections) &&
+         Code::Syndromes().Compute(word, syndrome);
+}
+
+//
+// Damage codewords with up to t errors and check that they come back.
+//
+template <class Code>
+static bool
+round_trip()
+{
+  uint8_t word[Code::kN], damaged[Code::kN], syndrome[Code::kTwoT];
+  size_t corrections;
+
+  for (int trial = 0; trial < 200; trial++) {
+    if (!make_codeword<Code>(word))
+      return false;
+
+    memcpy(damaged, word, sizeof(word));
+    size_t errors = trial % (Code::kT + 1);
+    for (size_t e = 0; e < errors; e++) {
+      size_t j = (trial * 7 + e * 5) % Code::kN;
+      damaged[j] ^= 1 + (random() % 255);
+    }
+
+    if (Code::Syndromes().Compute(damaged, syndrome))
+      continue;
+    if (!Code::Correct(damaged, syndrome, NULL, 0, corrections))
+      return false;
+    if (memcmp(damaged, word, sizeof(word)) != 0 || corrections != errors)
+      return false;
+  }
+
+  return true;
+}
+
+//
+// y^2 + y = c has two solutions for exactly half of the field, and none
+// for the rest.
+//
+static bool
+quadratics_solve()
+{
+  size_t solvable = 0;
+
+  for (unsigned int c = 0; c < 256; c++) {
+    uint8_t y;
+    if (!ECC_GF28_solve_quadratic(c, y))
+      continue;
+    solvable++;
+    if ((ECC_GF28_multiply(y, y) ^ y) != c)
+      return false;
+  }
+
+  return solvable == 128;
+}
+
+void
+test_reedsolomon(TestSession& ts)
+{
+  ts.BeginTest("GF(2^8) quadratic solutions");
+  ts.EndTest(quadratics_solve());
+
+  ts.BeginTest("Reed-Solomon (32,28) round trip");
+  ts.EndTest(round_trip<ReedSolomon<32, 4> >());
+
+  ts.BeginTest("Reed-Solomon (32,26) round trip");
+  ts.EndTest(round_trip<ReedSolomon<32, 6> >());
+
+  ts.BeginTest("Reed-Solomon (46,44) round trip");
+  ts.EndTest(round_trip<ReedSolomon<46, 2> >());
+
+  ts.BeginTest("Reed-Solomon (64,56) round trip, roots from alpha^1");
+  ts.EndTest(round_trip<ReedSolomon<64, 8, 1> >());
+
+  ts.BeginTest("Reed-Solomon (255,239) round trip, low order first");
+  ts.EndTest(round_trip<ReedSolomon<255, 16, 0, RS_LOW_FIRST> >());
+}
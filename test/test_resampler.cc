@@ -0,0 +1,83 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "RationalResampler.h"
+
+#include <stdio.h>
+#include <stddef.h>
+#include <math.h>
+
+void
+test_resampler(TestSession& ts)
+{
+  unsigned int L, M;
+  bool ok;
+
+  ts.BeginTest("RationalResampler ratio 25 MHz to 75.264 MHz");
+  ok = RationalResampler::Ratio(25000000.0, 75264000.0, L, M);
+  ts.EndTest(ok && L == 9408 && M == 3125);
+
+  ts.BeginTest("RationalResampler rejects fractional rates");
+  ts.EndTest(!RationalResampler::Ratio(25000000.5, 75264000.0, L, M));
+
+  //
+  // Upsample a slow sine wave by 3/1 and check the output against the
+  // ideal waveform, allowing for the filter's group delay.
+  //
+  ts.BeginTest("RationalResampler 3x sine");
+  {
+    const size_t kIn = 3000;
+    const double kFreq = 0.01;
+    static float in[kIn];
+    RationalResampler rs(3, 1);
+    float *out = new float[rs.MaxOutput(kIn)];
+    size_t i, n;
+
+    for (i = 0; i < kIn; i++)
+      in[i] = sin(2 * M_PI * kFreq * i);
+
+    //
+    // Feed in uneven pieces to exercise the block handling.
+    //
+    n = rs.Process(in, 1000, out);
+    n += rs.Process(&in[1000], 1, &out[n]);
+    n += rs.Process(&in[1001], kIn - 1001, &out[n]);
+
+    double delay = (RationalResampler::kDefaultTapsPerPhase * 3 - 1) / 2.0;
+    double worst = 0.0;
+    for (i = 200; i < n - 200; i++) {
+      double t = (i - delay) / 3.0;
+      double err = fabs(out[i] - sin(2 * M_PI * kFreq * t));
+      if (err > worst)
+        worst = err;
+    }
+    ts.EndTest(n >= kIn * 3 - 1 && n <= kIn * 3 && worst < 1e-3);
+    delete [] out;
+  }
+}
@@ -0,0 +1,120 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "SampleConverter.h"
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// Long enough to exercise both the vector loops and their scalar tails.
+//
+static const size_t kSamples = 37;
+
+void
+test_sampleconverter(TestSession& ts)
+{
+  SampleConverter conv;
+  uint8_t raw[kSamples * 4];
+  float out[kSamples];
+  size_t i;
+  bool ok;
+
+  ts.BeginTest("SampleConverter s8");
+  conv.SetFormat("s8");
+  for (i = 0; i < kSamples; i++)
+    raw[i] = (uint8_t) (i * 7 - 128);
+  conv.Convert(raw, out, kSamples);
+  for (i = 0, ok = true; i < kSamples; i++)
+    ok = ok && out[i] == (int8_t) raw[i] / 128.0f;
+  ts.EndTest(ok && conv.FrameSize() == 1);
+
+  ts.BeginTest("SampleConverter s16le");
+  conv.SetFormat("s16le");
+  for (i = 0; i < kSamples; i++) {
+    int16_t v = (int16_t) (i * 1771 - 32768);
+    raw[i * 2 + 0] = v & 0xff;
+    raw[i * 2 + 1] = (v >> 8) & 0xff;
+  }
+  conv.Convert(raw, out, kSamples);
+  for (i = 0, ok = true; i < kSamples; i++)
+    ok = ok && out[i] == (int16_t) (i * 1771 - 32768) / 32768.0f;
+  ts.EndTest(ok && conv.FrameSize() == 2);
+
+  ts.BeginTest("SampleConverter s16be");
+  conv.SetFormat("s16be");
+  for (i = 0; i < kSamples; i++) {
+    int16_t v = (int16_t) (i * 1771 - 32768);
+    raw[i * 2 + 0] = (v >> 8) & 0xff;
+    raw[i * 2 + 1] = v & 0xff;
+  }
+  conv.Convert(raw, out, kSamples);
+  for (i = 0, ok = true; i < kSamples; i++)
+    ok = ok && out[i] == (int16_t) (i * 1771 - 32768) / 32768.0f;
+  ts.EndTest(ok);
+
+  ts.BeginTest("SampleConverter cs8 channel select");
+  conv.SetFormat("cs8");
+  for (i = 0; i < kSamples; i++) {
+    raw[i * 2 + 0] = (uint8_t) i;
+    raw[i * 2 + 1] = (uint8_t) -i;
+  }
+  conv.SetChannel(1);
+  conv.Convert(raw, out, kSamples);
+  for (i = 0, ok = true; i < kSamples; i++)
+    ok = ok && out[i] == -(int) i / 128.0f;
+  conv.SetChannel(0);
+  conv.Convert(raw, out, kSamples);
+  for (i = 0; i < kSamples; i++)
+    ok = ok && out[i] == i / 128.0f;
+  ts.EndTest(ok && conv.FrameSize() == 2);
+
+  ts.BeginTest("SampleConverter cs16le channel select");
+  conv.SetFormat("cs16le");
+  for (i = 0; i < kSamples; i++) {
+    int16_t v = (int16_t) (i * 301);
+    raw[i * 4 + 0] = v & 0xff;
+    raw[i * 4 + 1] = (v >> 8) & 0xff;
+    raw[i * 4 + 2] = -v & 0xff;
+    raw[i * 4 + 3] = (-v >> 8) & 0xff;
+  }
+  conv.SetChannel(1);
+  conv.Convert(raw, out, kSamples);
+  for (i = 0, ok = true; i < kSamples; i++)
+    ok = ok && out[i] == -(int) (i * 301) / 32768.0f;
+  conv.SetChannel(0);
+  conv.Convert(raw, out, kSamples);
+  for (i = 0; i < kSamples; i++)
+    ok = ok && out[i] == (i * 301) / 32768.0f;
+  ts.EndTest(ok && conv.FrameSize() == 4);
+
+  ts.BeginTest("SampleConverter rejects unknown format");
+  ts.EndTest(!conv.SetFormat("u12") && !conv.SetChannel(2));
+}
@@ -0,0 +1,137 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "RDATDecoder.h"
+#include "SymbolDecoder.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+//
+// Folds every bit and event the slicer produces, in order, into a
+// running hash. Reports a pre-amble after a long enough stretch of bits,
+// so that the track timer gets exercised too.
+//
+class SlicerRecorder : public SymbolDecoder {
+public:
+  SlicerRecorder() : mHash(2166136261u), mBits(0), mRun(0) {}
+
+  void Add(uint32_t v) { mHash = (mHash ^ v) * 16777619u; }
+
+  void Reset() {}
+  void ClockDetected(bool detected) { Add(detected ? 2 : 3); mRun = 0; }
+  void ReceiveBit(bool bit) { Add(bit); mBits++; mRun++; }
+  bool PreambleDetected() const { return mRun > 2000; }
+  void TrackDetected(bool started) { Add(started ? 4 : 5); mRun = 0; }
+  void Stop() { Add(6); }
+
+  uint32_t mHash;
+  size_t mBits;
+  size_t mRun;
+};
+
+//
+// Run the signal through a slicer, in chunks of random size, using
+// either the block or the reference sample-at-a-time implementation.
+//
+static uint32_t
+slice(float sampleRate, const float *signal, size_t count, bool block,
+  size_t *bits)
+{
+  SlicerRecorder rec;
+  RDATDecoder dec(sampleRate);
+  size_t i, n;
+
+  dec.SetSymbolDecoder(&rec);
+  srandom(3);
+  for (i = 0; i < count; i += n) {
+    n = random() % 5000;
+    if (n > count - i)
+      n = count - i;
+    if (block)
+      dec.Process(&signal[i], n);
+    else
+      dec.ProcessScalar(&signal[i], n);
+  }
+  dec.Stop();
+
+  *bits = rec.mBits;
+  return rec.mHash;
+}
+
+//
+// A noisy, random NRZ signal, with stretches of a tone at half the
+// sample rate that crosses zero on every sample and makes the clock
+// detector lose lock.
+//
+static void
+make_signal(float *signal, size_t count, int oversample)
+{
+  size_t i;
+  float level = 1.0;
+
+  for (i = 0; i < count; i++) {
+    if (i % oversample == 0 && (random() & 1))
+      level = -level;
+    float noise = (random() % 2001 - 1000) / 4000.0;
+    if ((i / 100000) % 3 == 2)
+      signal[i] = (i & 1 ? 0.5 : -0.5) + noise;
+    else
+      signal[i] = level + noise;
+  }
+}
+
+void
+test_slicer(TestSession& ts)
+{
+  const float kSymbolRate = 9408000;
+  const size_t kSamples = 2000000;
+  static float signal[kSamples];
+  size_t blockBits, scalarBits;
+  uint32_t blockHash, scalarHash;
+
+  srandom(1);
+  make_signal(signal, kSamples, 8);
+
+  ts.BeginTest("Block slicer matches scalar slicer");
+  blockHash = slice(kSymbolRate * 8, signal, kSamples, true, &blockBits);
+  scalarHash = slice(kSymbolRate * 8, signal, kSamples, false, &scalarBits);
+  ts.EndTest(scalarBits > 100000 && blockHash == scalarHash &&
+             blockBits == scalarBits);
+
+  srandom(2);
+  make_signal(signal, kSamples, 6);
+
+  ts.BeginTest("Block slicer matches scalar slicer, odd window");
+  blockHash = slice(kSymbolRate * 6, signal, kSamples, true, &blockBits);
+  scalarHash = slice(kSymbolRate * 6, signal, kSamples, false, &scalarBits);
+  ts.EndTest(scalarBits > 100000 && blockHash == scalarHash &&
+             blockBits == scalarBits);
+}
@@ -0,0 +1,99 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "SPSCRing.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+
+static const uint32_t kItems = 1000000;
+
+//
+// Pushes a counting sequence through the ring, in place, as fast as it
+// will take it.
+//
+static void *
+produce(void *arg)
+{
+  SPSCRing<uint32_t> *ring = (SPSCRing<uint32_t> *) arg;
+  unsigned int tries;
+  uint32_t *slot;
+
+  for (uint32_t i = 0; i < kItems; i++) {
+    tries = 0;
+    while ((slot = ring->Reserve()) == NULL)
+      SPSCRing<uint32_t>::Backoff(tries);
+    *slot = i;
+    ring->Publish();
+  }
+
+  return NULL;
+}
+
+void
+test_spscring(TestSession& ts)
+{
+  SPSCRing<uint32_t> ring(64);
+  pthread_t producer;
+  unsigned int tries;
+  uint32_t *slot;
+  bool ok;
+
+  ts.BeginTest("SPSCRing fills and drains in order");
+  ok = ring.Peek() == NULL;
+  for (uint32_t i = 0; i < 64; i++) {
+    slot = ring.Reserve();
+    ok = ok && slot != NULL;
+    if (slot != NULL) {
+      *slot = i;
+      ring.Publish();
+    }
+  }
+  ok = ok && ring.Reserve() == NULL && ring.Depth() == 64;
+  for (uint32_t i = 0; i < 64; i++) {
+    slot = ring.Peek();
+    ok = ok && slot != NULL && *slot == i;
+    ring.Consume();
+  }
+  ts.EndTest(ok && ring.Peek() == NULL && ring.Depth() == 0);
+
+  ts.BeginTest("SPSCRing passes everything between threads in order");
+  ok = pthread_create(&producer, NULL, produce, &ring) == 0;
+  for (uint32_t i = 0; ok && i < kItems; i++) {
+    tries = 0;
+    while ((slot = ring.Peek()) == NULL)
+      SPSCRing<uint32_t>::Backoff(tries);
+    ok = *slot == i;
+    ring.Consume();
+  }
+  if (ok)
+    pthread_join(producer, NULL);
+  ts.EndTest(ok && ring.Peek() == NULL);
+}
@@ -0,0 +1,131 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "ECC_Syndrome.h"
+#include "ECC_GF28.h"
+#include "ECC_C1.h"
+#include "ECC_C2.h"
+#include "ECC_C3.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+//
+// The most codewords (and the stride) used in these tests.
+//
+static const size_t kMaxWords = 200;
+
+//
+// The syndromes of transposed codewords straight from the definition of
+// the DAT check matrices: H[i][j] = alpha^(i * (n - 1 - j)).
+//
+static void
+reference_syndromes(const uint8_t *words, uint8_t *syndromes, size_t twoT,
+  size_t n, size_t count)
+{
+  for (size_t k = 0; k < count; k++) {
+    for (size_t i = 0; i < twoT; i++) {
+      uint8_t s = 0;
+      for (size_t j = 0; j < n; j++) {
+        uint8_t h = ECC_GF28_pow_alpha((i * (n - 1 - j)) % 255);
+        s ^= ECC_GF28_multiply(words[j * kMaxWords + k], h);
+      }
+      syndromes[i * kMaxWords + k] = s;
+    }
+  }
+}
+
+//
+// Run the selected implementation over random codewords in batches of
+// awkward sizes and compare it with the reference.
+//
+static bool
+check(const ECC_Syndrome& syndromes, size_t twoT, size_t n)
+{
+  static const size_t kCounts[] = { 1, 15, 16, 17, 31, 33, 64, 100, 200 };
+  static uint8_t words[48 * kMaxWords];
+  static uint8_t expect[6 * kMaxWords], got[6 * kMaxWords];
+  bool ok = true;
+
+  for (size_t c = 0; c < sizeof(kCounts) / sizeof(kCounts[0]); c++) {
+    size_t count = kCounts[c];
+    for (size_t i = 0; i < n * kMaxWords; i++)
+      words[i] = random() & 0xff;
+    for (size_t i = 0; i < twoT * kMaxWords; i++)
+      got[i] = expect[i] = 0x55;
+    reference_syndromes(words, expect, twoT, n, count);
+    syndromes.Compute(words, got, count, kMaxWords);
+    for (size_t i = 0; i < twoT * kMaxWords; i++)
+      ok = ok && got[i] == expect[i];
+  }
+
+  return ok;
+}
+
+void
+test_syndrome(TestSession& ts)
+{
+  static const ECC_Syndrome::Implementation kImplementations[] = {
+    ECC_Syndrome::SCALAR, ECC_Syndrome::SSSE3, ECC_Syndrome::AVX2
+  };
+  ECC_Syndrome::Implementation best = ECC_Syndrome::Selected();
+
+  srandom(1);
+
+  for (size_t m = 0; m < 3; m++) {
+    if (!ECC_Syndrome::Select(kImplementations[m]))
+      continue;
+    ts.BeginTest("Batch syndromes match the check matrices (%s)",
+      ECC_Syndrome::Name(kImplementations[m]));
+    ts.EndTest(check(ECC_C1::Syndromes(), ECC_C1::kTwoT, ECC_C1::kN) &&
+               check(ECC_C2::Syndromes(), ECC_C2::kTwoT, ECC_C2::kN) &&
+               check(ECC_C3::Syndromes(), ECC_C3::kTwoT, ECC_C3::kN));
+  }
+
+  ECC_Syndrome::Select(best);
+
+  ts.BeginTest("Single codeword syndrome matches the check matrix");
+  uint8_t word[ECC_C2::kN], s[ECC_C2::kTwoT];
+  uint8_t words[ECC_C2::kN * kMaxWords], expect[ECC_C2::kTwoT * kMaxWords];
+  bool ok = true;
+  for (int trial = 0; trial < 100; trial++) {
+    for (size_t j = 0; j < ECC_C2::kN; j++)
+      word[j] = words[j * kMaxWords] = trial < 50 ? random() & 0xff : 0;
+    reference_syndromes(words, expect, ECC_C2::kTwoT, ECC_C2::kN, 1);
+    bool zero = ECC_C2::Syndromes().Compute(word, s);
+    bool expectZero = true;
+    for (size_t i = 0; i < ECC_C2::kTwoT; i++) {
+      ok = ok && s[i] == expect[i * kMaxWords];
+      expectZero = expectZero && expect[i * kMaxWords] == 0;
+    }
+    ok = ok && zero == expectZero;
+  }
+  ts.EndTest(ok);
+}
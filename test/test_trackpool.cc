@@ -0,0 +1,113 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "Track.h"
+#include "TrackPool.h"
+#include "DATBlock.h"
+
+#include <stdint.h>
+#include <string.h>
+
+//
+// Add a block with a good header to the track, its data all 'fill'.
+//
+static void
+add_block(Track& track, uint8_t block_number, uint8_t fill)
+{
+  DATBlock block;
+
+  block.AddByte(0, 0);
+  block.AddByte(0, 0x40);
+  block.AddByte(0, block_number);
+  block.AddByte(0, 0x40 ^ block_number);
+  for (size_t i = 0; i < Track::kBlockSize; i++)
+    block.AddByte(0, fill);
+  track.AddBlock(block);
+}
+
+//
+// Does a recycled track look just like a new one?
+//
+static bool
+same_as_fresh(const Track& track, Track::Head head)
+{
+  Track fresh(head);
+  uint8_t id;
+
+  for (size_t w = 0; w < Track::ValidityArray::kWords; w++)
+    if (track.DataValid().Word(w) != fresh.DataValid().Word(w))
+      return false;
+
+  return memcmp(track.Data(), fresh.Data(), sizeof(Track::DataArray)) == 0 &&
+         memcmp(track.HeaderValid(), fresh.HeaderValid(),
+           sizeof(Track::HeaderValidityArray)) == 0 &&
+         memcmp(track.SubcodeSignature(), fresh.SubcodeSignature(),
+           sizeof(Track::SubcodeSignatureArray)) == 0 &&
+         track.GetHead() == head && track.ATF2Count() == 0 &&
+         track.ATF3Count() == 0 && track.C1Errors() == 0 &&
+         track.C1UncorrectableErrors() == 0 &&
+         track.C2UncorrectableErrors() == 0 && track.ExtraPasses() == 0 &&
+         track.ReliabilityRescues() == 0 && !track.GetControlID(id) &&
+         !track.GetDataID(id);
+}
+
+void
+test_trackpool(TestSession& ts)
+{
+  TrackPool pool;
+
+  ts.BeginTest("Track pool recycles its tracks");
+  Track *track = pool.Get(Track::HEAD_A);
+  pool.Put(track);
+  Track *again = pool.Get(Track::HEAD_B);
+  ts.EndTest(again == track && pool.Allocated() == 1 &&
+             pool.Available() == 0 &&
+             ((uintptr_t) track % TrackPool::kAlignment) == 0);
+
+  ts.BeginTest("Recycled track forgets the blocks it was given");
+  add_block(*track, 3, 0xab);
+  add_block(*track, 70, 0x5c);
+  track->SetATFCounts(2, 20);
+  pool.Put(track);
+  track = pool.Get(Track::HEAD_UNKNOWN);
+  ts.EndTest(same_as_fresh(*track, Track::HEAD_UNKNOWN));
+
+  ts.BeginTest("Recycled track forgets what correction wrote");
+  for (uint8_t b = 0; b < Track::kBlocks; b += 5)
+    add_block(*track, b, b);
+  track->Complete();
+  pool.Put(track);
+  track = pool.Get(Track::HEAD_A);
+  ts.EndTest(same_as_fresh(*track, Track::HEAD_A));
+
+  ts.BeginTest("Track pool reserves tracks ahead");
+  pool.Put(track);
+  pool.Reserve(4);
+  ts.EndTest(pool.Allocated() == 4 && pool.Available() == 4);
+}
@@ -0,0 +1,123 @@
+//
+// Copyright 2018, Jeremy Cooper
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions
+// are met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+// "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+// LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+// FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+// COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+// INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+// BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+// LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+// CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+// LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+// ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+//
+#include "tests.h"
+#include "WindowScan.h"
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <math.h>
+
+//
+// The front-to-back scan that ScanWindow() must agree with.
+//
+static void
+reference_scan(const float *window, int size, float& max, int& maxI,
+  float& min)
+{
+  for (int i = 0; i < size; i++) {
+    if (window[i] > max) {
+      max = window[i];
+      maxI = i;
+    }
+    if (window[i] < min)
+      min = window[i];
+  }
+}
+
+//
+// A window of small, frequently tied and sometimes denormal or zero
+// values, like a decaying clock window.
+//
+static void
+make_window(float *window, int size)
+{
+  for (int i = 0; i < size; i++) {
+    switch (random() % 6) {
+    case 0: window[i] = 0.0; break;
+    case 1: window[i] = 1e-40; break;
+    case 2: window[i] = 0.5; break;
+    default: window[i] = (random() % 1000) / 1000.0; break;
+    }
+  }
+}
+
+void
+test_windowscan(TestSession& ts)
+{
+  static const int kSizes[] = { 8, 16, 12, 6 };
+  float window[16];
+  bool ok = true;
+
+  srandom(1);
+
+  ts.BeginTest("ScanWindow matches front-to-back scan");
+  for (int trial = 0; trial < 20000; trial++) {
+    int size = kSizes[trial % 4];
+    make_window(window, size);
+
+    //
+    // Both the RDATDecoder starting values and the
+    // DifferentialClockDetector ones.
+    //
+    float max = 0.0, min = 100.0, refMax = 0.0, refMin = 100.0;
+    if (trial & 4) {
+      max = min = refMax = refMin = window[0];
+    }
+    int maxI = 0, refMaxI = 0;
+
+    ScanWindow(window, size, max, maxI, min);
+    reference_scan(window, size, refMax, refMaxI, refMin);
+    ok = ok && max == refMax && maxI == refMaxI && min == refMin;
+  }
+  ts.EndTest(ok);
+
+  ts.BeginTest("ScanWindow passes over NaN");
+  for (int i = 0; i < 8; i++)
+    window[i] = i == 3 ? 2.0 : 1.0;
+  window[1] = NAN;
+  float max = 0.0, min = 100.0;
+  int maxI = 0;
+  ScanWindow<8>(window, max, maxI, min);
+  ts.EndTest(max == 2.0 && maxI == 3 && min == 1.0);
+
+  ts.BeginTest("WindowRatio judges like a division");
+  static const float kThresholds[] = { 0.97, 0.5, 1e-20, 0.0 };
+  ok = true;
+  for (int trial = 0; trial < 20000; trial++) {
+    make_window(window, 2);
+    float lo = window[0] < window[1] ? window[0] : window[1];
+    float hi = window[0] < window[1] ? window[1] : window[0];
+    float t = kThresholds[trial % 4];
+    float ratio = WindowRatio(lo, hi, t);
+    float exact = hi > 0.0 ? lo / hi : 0.0;
+    ok = ok && (ratio < t) == (exact < t) && (ratio <= t) == (exact <= t);
+  }
+  ts.EndTest(ok);
+}
@@ -36,5 +36,22 @@ void test_ecc(TestSession&);
 void test_timecode(TestSession&);
 void test_diffclock(TestSession&);
 void test_samplewindow(TestSession&);
+void test_sampleconverter(TestSession&);
+void test_resampler(TestSession&);
+void test_gardner(TestSession&);
+void test_deframer(TestSession&);
+void test_slicer(TestSession&);
+void test_windowscan(TestSession&);
+void test_gapscanner(TestSession&);
+void test_spscring(TestSession&);
+void test_syndrome(TestSession&);
+void test_batch(TestSession&);
+void test_reedsolomon(TestSession&);
+void test_bitmask(TestSession&);
+void test_gf28(TestSession&);
+void test_trackpool(TestSession&);
+void test_frame(TestSession&);
+void test_framer(TestSession&);
+void test_fusion(TestSession&);
 
 #endif